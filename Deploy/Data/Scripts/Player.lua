@@ -12,9 +12,6 @@ end
 setmetatable(Player, { __call = Player.New })
 
 function Player:Finalize(entitySelf)
-    -- Get required components.
-    self.transform = ComponentSystem:GetTransform(entitySelf)
-
     return true
 end
 
@@ -43,10 +40,14 @@ function Player:Update(entitySelf, timeDelta)
         -- Normalize direction vector.
         direction = direction:Normalize()
 
+        -- Get the transform component.
+        -- Component references are not stable across frames.
+        local transform = ComponentSystem:GetTransform(entitySelf)
+
         -- Calculate new position.
-        local position = self.transform:GetPosition()
+        local position = transform:GetPosition()
         position = position + direction * self.speed * timeDelta
-        self.transform:SetPosition(position)
+        transform:SetPosition(position)
     end
 end
 
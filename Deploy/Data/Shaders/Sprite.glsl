@@ -3,7 +3,10 @@
 #if defined(VERTEX_SHADER)
     layout(location = 0) in vec2 vertexPosition;
     layout(location = 1) in vec2 vertexTexture;
-    layout(location = 2) in mat4 instanceTransform;
+    layout(location = 2) in vec3 instancePosition;
+    layout(location = 3) in float instanceRotation;
+    layout(location = 4) in vec2 instanceScale;
+    layout(location = 5) in vec2 instanceOffset;
     layout(location = 6) in vec4 instanceRectangle;
     layout(location = 7) in vec4 instanceColor;
 
@@ -15,16 +18,28 @@
 
     void main()
     {
-        vec4 position = vec4(vertexPosition, 0.0f, 1.0f);
+        vec2 position = vertexPosition;
         vec2 texture = vertexTexture;
 
         // Scale vertex position by sprite size.
         // Size can be negative for mirrored sprites.
-        position.xy *= abs(instanceRectangle.zw);
+        position *= abs(instanceRectangle.zw);
 
-        // Apply transformation.
-        position = instanceTransform * position;
-        position = viewTransform * position;
+        // Apply offset and scale.
+        position += instanceOffset;
+        position *= instanceScale;
+
+        // Apply clockwise rotation.
+        float rotationSin = sin(instanceRotation);
+        float rotationCos = cos(instanceRotation);
+
+        position = vec2(
+            position.x * rotationCos + position.y * rotationSin,
+            position.y * rotationCos - position.x * rotationSin
+        );
+
+        // Apply translation.
+        vec4 world = vec4(position + instancePosition.xy, instancePosition.z, 1.0f);
 
         // Normalize texture coordinate.
         texture *= instanceRectangle.zw * textureSizeInv;
@@ -34,7 +49,7 @@
         texture.y -= instanceRectangle.w * textureSizeInv.y;
 
         // Output vertex.
-        gl_Position     = position;
+        gl_Position     = viewTransform * world;
         fragmentTexture = texture;
         fragmentColor   = instanceColor;
     }
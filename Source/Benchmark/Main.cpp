@@ -0,0 +1,431 @@
+#include "Precompiled.hpp"
+#include "Context.hpp"
+
+#include "Game/EntitySystem.hpp"
+#include "Game/ComponentSystem.hpp"
+#include "Game/IdentitySystem.hpp"
+#include "Game/ParticleSystem.hpp"
+#include "Game/Components/Transform.hpp"
+#include "Game/Components/ParticleEmitter.hpp"
+#include "Graphics/BasicRenderer.hpp"
+#include "Graphics/RecordingBackend.hpp"
+#include "Graphics/RenderQueue.hpp"
+#include "Tests/Test.hpp"
+
+//
+// Benchmark
+//
+//  Measures entity, component and identity systems without a window
+//  or a rendering context. Prints the average time and the number of
+//  heap allocations per operation for different numbers of entities.
+//
+//  Component benchmarks are repeated for each type of component storage.
+//  Particle benchmarks simulate as many particles as there are entities
+//  and draw them through the render queue with the recording backend.
+//
+
+namespace
+{
+    // Numbers of entities to benchmark with.
+    const std::size_t EntityCounts[] = { 1000, 100000, 1000000 };
+
+    // Maximum number of particles of each emitter.
+    const int ParticleEmitterCapacity = 1000;
+
+    // Number of heap allocations.
+    std::atomic<std::size_t> allocationCount(0);
+
+    // Value that keeps benchmarked loops from being optimized away.
+    volatile float benchmarkSink = 0.0f;
+
+    // Velocity component used for views over multiple component types.
+    class Velocity : public Game::Component
+    {
+    public:
+        Velocity() :
+            value(1.0f, 1.0f)
+        {
+        }
+
+        Velocity(Velocity&&) = default;
+        Velocity& operator=(Velocity&&) = default;
+
+        glm::vec2 value;
+    };
+
+    // Gets the name of a component storage type.
+    const char* GetStorageName(Game::ComponentSystem::ComponentStorage::Type storage)
+    {
+        switch(storage)
+        {
+        case Game::ComponentSystem::ComponentStorage::Pools:
+            return "Pools";
+
+        case Game::ComponentSystem::ComponentStorage::Archetypes:
+            return "Archetypes";
+        }
+
+        return "Unknown";
+    }
+
+    // Measures a function and prints results per operation.
+    template<typename Function>
+    void Measure(const char* name, std::size_t count, Function function)
+    {
+        // Run the function.
+        std::size_t allocations = allocationCount.load();
+        auto start = std::chrono::high_resolution_clock::now();
+
+        function();
+
+        auto end = std::chrono::high_resolution_clock::now();
+        allocations = allocationCount.load() - allocations;
+
+        // Print the results.
+        double nanoseconds = std::chrono::duration<double, std::nano>(end - start).count();
+
+        std::cout << "  " << std::left << std::setw(44) << name;
+        std::cout << std::right << std::fixed;
+        std::cout << std::setw(12) << std::setprecision(2) << nanoseconds / count << " ns/op";
+        std::cout << std::setw(12) << std::setprecision(4) << (double)allocations / count << " allocs/op";
+        std::cout << std::endl;
+    }
+
+    // Benchmarks the entity system.
+    void BenchmarkEntities(std::size_t count)
+    {
+        Test::World world(Game::ComponentSystem::ComponentStorage::Pools);
+
+        std::vector<Game::EntityHandle> entities;
+        entities.reserve(count);
+
+        Measure("EntitySystem::CreateEntities", count, [&]()
+        {
+            world.entitySystem.CreateEntities(count, entities);
+            world.entitySystem.ProcessCommands();
+        });
+
+        Measure("EntitySystem::DestroyEntities", count, [&]()
+        {
+            world.entitySystem.DestroyEntities(entities);
+            world.entitySystem.ProcessCommands();
+        });
+
+        entities.clear();
+
+        Measure("EntitySystem::CreateEntity", count, [&]()
+        {
+            for(std::size_t i = 0; i < count; ++i)
+            {
+                entities.push_back(world.entitySystem.CreateEntity());
+            }
+
+            world.entitySystem.ProcessCommands();
+        });
+
+        Measure("EntitySystem::DestroyEntity", count, [&]()
+        {
+            for(const Game::EntityHandle& entity : entities)
+            {
+                world.entitySystem.DestroyEntity(entity);
+            }
+
+            world.entitySystem.ProcessCommands();
+        });
+    }
+
+    // Benchmarks the component system.
+    void BenchmarkComponents(std::size_t count, Game::ComponentSystem::ComponentStorage::Type storage)
+    {
+        Test::World world(storage);
+
+        // Create entities.
+        std::vector<Game::EntityHandle> entities;
+        world.entitySystem.CreateEntities(count, entities);
+        world.entitySystem.ProcessCommands();
+
+        // Create components.
+        Measure("ComponentSystem::Create<Transform>", count, [&]()
+        {
+            for(const Game::EntityHandle& entity : entities)
+            {
+                world.componentSystem.Create<Game::Components::Transform>(entity);
+            }
+        });
+
+        Measure("ComponentSystem::Create<Velocity> (half)", count / 2, [&]()
+        {
+            for(std::size_t i = 0; i < count; i += 2)
+            {
+                world.componentSystem.Create<Velocity>(entities[i]);
+            }
+        });
+
+        // Lookup components in random order.
+        std::vector<Game::EntityHandle> shuffled(entities);
+        std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(1234));
+
+        Measure("ComponentSystem::Lookup<Transform>", count, [&]()
+        {
+            float sum = 0.0f;
+
+            for(const Game::EntityHandle& entity : shuffled)
+            {
+                sum += world.componentSystem.Lookup<Game::Components::Transform>(entity)->GetRotation();
+            }
+
+            benchmarkSink = sum;
+        });
+
+        // Iterate over components.
+        Measure("ComponentSystem::View<Transform>", count, [&]()
+        {
+            float sum = 0.0f;
+
+            auto view = world.componentSystem.View<Game::Components::Transform>();
+
+            for(auto it = view.Begin(); it != view.End(); ++it)
+            {
+                sum += it.Get<Game::Components::Transform>().GetPosition().x;
+            }
+
+            benchmarkSink = sum;
+        });
+
+        Measure("ComponentSystem::View<Transform, Velocity>", count / 2, [&]()
+        {
+            auto view = world.componentSystem.View<Game::Components::Transform, Velocity>();
+
+            for(auto it = view.Begin(); it != view.End(); ++it)
+            {
+                Game::Components::Transform& transform = it.Get<Game::Components::Transform>();
+                transform.SetPosition(transform.GetPosition() + it.Get<Velocity>().value);
+            }
+        });
+
+        // Remove components.
+        Measure("ComponentSystem::Remove<Velocity> (half)", count / 2, [&]()
+        {
+            for(std::size_t i = 0; i < count; i += 2)
+            {
+                world.componentSystem.Remove<Velocity>(entities[i]);
+            }
+        });
+    }
+
+    // Benchmarks the identity system.
+    void BenchmarkIdentities(std::size_t count)
+    {
+        Test::World world(Game::ComponentSystem::ComponentStorage::Pools);
+
+        // Create entities and their names.
+        std::vector<Game::EntityHandle> entities;
+        world.entitySystem.CreateEntities(count, entities);
+        world.entitySystem.ProcessCommands();
+
+        std::vector<std::string> names;
+        names.reserve(count);
+
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            names.push_back("Entity" + std::to_string(i));
+        }
+
+        // Set and lookup names.
+        Measure("IdentitySystem::SetEntityName", count, [&]()
+        {
+            for(std::size_t i = 0; i < count; ++i)
+            {
+                world.identitySystem.SetEntityName(entities[i], names[i]);
+            }
+        });
+
+        Measure("IdentitySystem::Lookup", count, [&]()
+        {
+            int sum = 0;
+
+            for(const std::string& name : names)
+            {
+                sum += world.identitySystem.Lookup(name).identifier;
+            }
+
+            benchmarkSink = (float)sum;
+        });
+    }
+
+    // Benchmarks the particle system.
+    void BenchmarkParticles(std::size_t count)
+    {
+        Test::World world(Game::ComponentSystem::ComponentStorage::Pools);
+
+        // Draw without a rendering context.
+        Graphics::BasicRenderer basicRenderer;
+        basicRenderer.Initialize(world.context, Graphics::BasicRenderer::Backend::Recording);
+
+        auto recording = static_cast<Graphics::RecordingBackend*>(basicRenderer.GetBackend());
+        recording->SetInstanceRecording(false);
+
+        Graphics::RenderQueue renderQueue;
+        renderQueue.Initialize(world.context);
+
+        Game::ParticleSystem particleSystem;
+        particleSystem.Initialize(world.context);
+
+        // Create emitters that spawn all of their particles in the first update.
+        std::size_t emitterCount = std::max<std::size_t>(count / ParticleEmitterCapacity, 1);
+        std::size_t particleCount = emitterCount * ParticleEmitterCapacity;
+
+        std::vector<Game::EntityHandle> entities;
+        world.entitySystem.CreateEntities(emitterCount, entities);
+        world.entitySystem.ProcessCommands();
+
+        auto texture = std::make_shared<Graphics::Texture>();
+
+        for(std::size_t i = 0; i < emitterCount; ++i)
+        {
+            auto transform = world.componentSystem.Create<Game::Components::Transform>(entities[i]);
+            transform->SetPosition(glm::vec2((float)(i % 100), (float)(i / 100)));
+
+            auto emitter = world.componentSystem.Create<Game::Components::ParticleEmitter>(entities[i]);
+            emitter->SetTexture(texture, glm::vec4(0.0f, 1.0f, 1.0f, 1.0f));
+            emitter->SetSpawnRate((float)ParticleEmitterCapacity);
+            emitter->SetMaximumCount(ParticleEmitterCapacity);
+            emitter->SetLifetime(100.0f, 200.0f);
+            emitter->SetVelocity(glm::vec2(-1.0f, -1.0f), glm::vec2(1.0f, 1.0f));
+        }
+
+        // Spawn and simulate particles.
+        Measure("ParticleSystem::Update (spawn)", particleCount, [&]()
+        {
+            particleSystem.Update(1.0f);
+        });
+
+        Measure("ParticleSystem::Update", particleCount, [&]()
+        {
+            particleSystem.Update(1.0f / 60.0f);
+        });
+
+        // Draw particles.
+        Measure("ParticleSystem::Draw + RenderQueue::Submit", particleCount, [&]()
+        {
+            particleSystem.Draw();
+            renderQueue.Submit();
+        });
+
+        benchmarkSink = (float)particleSystem.GetParticleCount();
+    }
+}
+
+//
+// Allocation Tracking
+//
+
+namespace
+{
+    // Allocates and counts heap memory.
+    void* AllocateMemory(std::size_t size) noexcept
+    {
+        allocationCount.fetch_add(1, std::memory_order_relaxed);
+
+        // Allocations of zero bytes still return unique pointers.
+        return std::malloc(size != 0 ? size : 1);
+    }
+}
+
+void* operator new(std::size_t size)
+{
+    void* memory = AllocateMemory(size);
+
+    if(memory == nullptr)
+        throw std::bad_alloc();
+
+    return memory;
+}
+
+void* operator new[](std::size_t size)
+{
+    void* memory = AllocateMemory(size);
+
+    if(memory == nullptr)
+        throw std::bad_alloc();
+
+    return memory;
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return AllocateMemory(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return AllocateMemory(size);
+}
+
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept
+{
+    std::free(memory);
+}
+
+//
+// Main
+//
+
+int main()
+{
+    Debug::Initialize();
+    Build::Initialize();
+    Logger::Initialize();
+
+    const Game::ComponentSystem::ComponentStorage::Type Storages[] =
+    {
+        Game::ComponentSystem::ComponentStorage::Pools,
+        Game::ComponentSystem::ComponentStorage::Archetypes,
+    };
+
+    // Run benchmarks for each number of entities.
+    for(std::size_t count : EntityCounts)
+    {
+        std::cout << "Entities: " << count << std::endl;
+
+        BenchmarkEntities(count);
+
+        for(auto storage : Storages)
+        {
+            std::cout << " Storage: " << GetStorageName(storage) << std::endl;
+            BenchmarkComponents(count, storage);
+        }
+
+        BenchmarkIdentities(count);
+        BenchmarkParticles(count);
+
+        std::cout << std::endl;
+    }
+
+    return 0;
+}
@@ -4,6 +4,7 @@
 // NonCopyable
 //
 //  Prevents a class instance from being copied.
+//  Instances can still be moved if the derived class allows it.
 //
 //  Example usage:
 //      class Object : private NonCopyable
@@ -22,4 +23,8 @@ protected:
     // Delete copy constructor and operator.
     NonCopyable(const NonCopyable&) = delete;
     NonCopyable& operator=(const NonCopyable&) = delete;
+
+    // Default move constructor and operator.
+    NonCopyable(NonCopyable&&) = default;
+    NonCopyable& operator=(NonCopyable&&) = default;
 };
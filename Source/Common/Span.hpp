@@ -0,0 +1,102 @@
+#pragma once
+
+//
+// Span
+//
+//  References a contiguous range of elements owned by something else.
+//  Cheap to copy and pass by value, but does not extend the lifetime
+//  of referenced elements.
+//
+//  Example usage:
+//      std::vector<int> values = { 1, 2, 3 };
+//
+//      Span<const int> span(values);
+//
+//      for(int value : span)
+//      {
+//          /* ... */
+//      }
+//
+
+template<typename Type>
+class Span
+{
+public:
+    // Type declarations.
+    typedef Type* Iterator;
+
+public:
+    Span() :
+        m_data(nullptr),
+        m_size(0)
+    {
+    }
+
+    Span(Type* data, std::size_t size) :
+        m_data(data),
+        m_size(size)
+    {
+    }
+
+    template<typename Container, typename = decltype(std::declval<Container&>().data())>
+    Span(Container& container) :
+        m_data(container.data()),
+        m_size(container.size())
+    {
+    }
+
+    template<typename Other>
+    Span(const Span<Other>& other) :
+        m_data(other.GetData()),
+        m_size(other.GetSize())
+    {
+    }
+
+    // Gets a subrange of elements.
+    Span GetSubspan(std::size_t offset, std::size_t count) const
+    {
+        Assert(offset + count <= m_size);
+        return Span(m_data + offset, count);
+    }
+
+    // Gets the pointer to elements.
+    Type* GetData() const
+    {
+        return m_data;
+    }
+
+    // Gets the number of elements.
+    std::size_t GetSize() const
+    {
+        return m_size;
+    }
+
+    // Checks if the span is empty.
+    bool IsEmpty() const
+    {
+        return m_size == 0;
+    }
+
+    // Subscript operator.
+    Type& operator[](std::size_t index) const
+    {
+        Assert(index < m_size);
+        return m_data[index];
+    }
+
+    // Range iterators.
+    Iterator begin() const
+    {
+        return m_data;
+    }
+
+    Iterator end() const
+    {
+        return m_data + m_size;
+    }
+
+private:
+    // Referenced elements.
+    Type* m_data;
+    std::size_t m_size;
+};
@@ -35,25 +35,89 @@ namespace Utility
     {
         Assert(values.size() == order.size());
 
-        // Create an array of indices.
-        std::vector<std::size_t> indices(order.size());
-        std::iota(indices.begin(), indices.end(), 0);
+        // Gather values in the new order.
+        std::vector<Type> reordered;
+        reordered.reserve(values.size());
 
-        // Rearange the values.
-        for(std::size_t i = 0; i < values.size() - 1; ++i)
+        for(std::size_t index : order)
         {
-            std::size_t desired = order[i];
+            reordered.push_back(std::move(values[index]));
+        }
+
+        values.swap(reordered);
+    }
+
+    // Sorts a range of values by their 64-bit keys using a stable radix sort.
+    // Buffer has to hold the same number of values and its content is overwritten.
+    template<typename Type, typename Function>
+    void RadixSort(Type* values, Type* buffer, std::size_t count, Function key)
+    {
+        const int DigitBits = 8;
+        const int DigitCount = 64 / DigitBits;
+        const int BucketCount = 1 << DigitBits;
+
+        if(count == 0)
+            return;
 
-            for(std::size_t j = i; j < values.size(); ++j)
+        // Count digits of all passes at once.
+        std::size_t counts[DigitCount][BucketCount] = {};
+
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            uint64_t bits = key(values[i]);
+
+            for(int digit = 0; digit < DigitCount; ++digit)
             {
-                if(desired == indices[j])
-                {
-                    std::swap(values[i], values[j]);
-                    std::swap(indices[i], indices[j]);
-                    break;
-                }
+                ++counts[digit][(bits >> (digit * DigitBits)) & (BucketCount - 1)];
             }
         }
+
+        // Sort by each digit starting from the least significant one.
+        Type* source = values;
+        Type* target = buffer;
+
+        for(int digit = 0; digit < DigitCount; ++digit)
+        {
+            std::size_t* digitCounts = counts[digit];
+
+            // Skip digits that are the same for all values.
+            if(digitCounts[(key(source[0]) >> (digit * DigitBits)) & (BucketCount - 1)] == count)
+                continue;
+
+            // Calculate bucket offsets.
+            std::size_t offset = 0;
+
+            for(int bucket = 0; bucket < BucketCount; ++bucket)
+            {
+                std::size_t bucketCount = digitCounts[bucket];
+                digitCounts[bucket] = offset;
+                offset += bucketCount;
+            }
+
+            // Scatter values to their buckets.
+            for(std::size_t i = 0; i < count; ++i)
+            {
+                target[digitCounts[(key(source[i]) >> (digit * DigitBits)) & (BucketCount - 1)]++] = std::move(source[i]);
+            }
+
+            std::swap(source, target);
+        }
+
+        // Move values back if they ended up in the buffer.
+        if(source != values)
+        {
+            std::move(source, source + count, values);
+        }
+    }
+
+    // Sorts values by their 64-bit keys using a stable radix sort.
+    // Buffer is used as a temporary storage and its content is overwritten.
+    template<typename Type, typename Function>
+    void RadixSort(std::vector<Type>& values, std::vector<Type>& buffer, Function key)
+    {
+        buffer.resize(values.size());
+
+        RadixSort(values.data(), buffer.data(), values.size(), key);
     }
 
     // Splits a string into tokens.
@@ -0,0 +1,178 @@
+#pragma once
+
+//
+// Work Stealing Queue
+//
+//  Lock-free double ended queue of pointers with a single owner thread
+//  (Chase-Lev deque). The owner pushes and takes elements at the bottom,
+//  while any other thread can steal elements from the top.
+//
+//  Example usage:
+//      WorkStealingQueue<Job*> queue;
+//
+//      // Owner thread.
+//      queue.Push(job);
+//      Job* own = queue.Take();
+//
+//      // Any other thread.
+//      Job* stolen = queue.Steal();
+//
+//  Take() and Steal() return nullptr when the queue is empty or when
+//  another thread won the race for the last element.
+//
+//  The storage grows when full. Previous storage arrays are kept until
+//  the queue is destroyed, as thieves may still be reading from them.
+//
+
+template<typename Type>
+class WorkStealingQueue : private NonCopyable
+{
+public:
+    static_assert(std::is_pointer<Type>::value, "Work stealing queue can only hold pointers!");
+
+    // Constant variables.
+    static const std::int64_t InitialCapacity = 256;
+
+private:
+    // Circular storage array.
+    struct Storage
+    {
+        Storage(std::int64_t capacity) :
+            mask(capacity - 1),
+            elements(new std::atomic<Type>[(std::size_t)capacity])
+        {
+        }
+
+        Type Get(std::int64_t index) const
+        {
+            return elements[index & mask].load(std::memory_order_relaxed);
+        }
+
+        void Put(std::int64_t index, Type element)
+        {
+            elements[index & mask].store(element, std::memory_order_relaxed);
+        }
+
+        std::int64_t mask;
+        std::unique_ptr<std::atomic<Type>[]> elements;
+    };
+
+public:
+    WorkStealingQueue() :
+        m_top(0),
+        m_bottom(0),
+        m_storage(nullptr)
+    {
+        m_storages.push_back(std::make_unique<Storage>(InitialCapacity));
+        m_storage.store(m_storages.back().get(), std::memory_order_relaxed);
+    }
+
+    // Pushes an element at the bottom.
+    // Can only be called by the owner thread.
+    void Push(Type element)
+    {
+        std::int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+        std::int64_t top = m_top.load(std::memory_order_acquire);
+        Storage* storage = m_storage.load(std::memory_order_relaxed);
+
+        // Grow the storage if it is full.
+        if(bottom - top > storage->mask)
+        {
+            storage = this->Grow(storage, top, bottom);
+        }
+
+        storage->Put(bottom, element);
+
+        // Publish the element to thieves.
+        m_bottom.store(bottom + 1, std::memory_order_release);
+    }
+
+    // Takes the most recent element from the bottom.
+    // Can only be called by the owner thread.
+    Type Take()
+    {
+        std::int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+        Storage* storage = m_storage.load(std::memory_order_relaxed);
+
+        // Reserve the bottom element before checking for thieves.
+        m_bottom.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        std::int64_t top = m_top.load(std::memory_order_relaxed);
+
+        if(top > bottom)
+        {
+            // Queue was empty.
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        Type element = storage->Get(bottom);
+
+        if(top == bottom)
+        {
+            // Race thieves for the last element.
+            if(!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            {
+                element = nullptr;
+            }
+
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+        }
+
+        return element;
+    }
+
+    // Steals the oldest element from the top.
+    // Can be called by any thread.
+    Type Steal()
+    {
+        std::int64_t top = m_top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t bottom = m_bottom.load(std::memory_order_acquire);
+
+        if(top >= bottom)
+            return nullptr;
+
+        Storage* storage = m_storage.load(std::memory_order_acquire);
+        Type element = storage->Get(top);
+
+        // Race other thieves and the owner for the element.
+        if(!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            return nullptr;
+
+        return element;
+    }
+
+private:
+    // Creates a larger storage with current elements.
+    Storage* Grow(Storage* storage, std::int64_t top, std::int64_t bottom)
+    {
+        auto grown = std::make_unique<Storage>((storage->mask + 1) * 2);
+
+        for(std::int64_t i = top; i < bottom; ++i)
+        {
+            grown->Put(i, storage->Get(i));
+        }
+
+        // Keep the previous storage for thieves that still read it.
+        m_storages.push_back(std::move(grown));
+        m_storage.store(m_storages.back().get(), std::memory_order_release);
+
+        return m_storages.back().get();
+    }
+
+private:
+    // Queue indices.
+    std::atomic<std::int64_t> m_top;
+    std::atomic<std::int64_t> m_bottom;
+
+    // Current storage array.
+    std::atomic<Storage*> m_storage;
+
+    // All storage arrays owned by the queue.
+    std::vector<std::unique_ptr<Storage>> m_storages;
+};
+
+template<typename Type>
+const std::int64_t WorkStealingQueue<Type>::InitialCapacity;
@@ -5,6 +5,7 @@ namespace System
 {
     class Config;
     class Timer;
+    class JobSystem;
     class Window;
     class InputState;
     class ResourceManager;
@@ -12,16 +13,20 @@ namespace System
 
 namespace Graphics
 {
+    class TextureLoader;
     class BasicRenderer;
+    class RenderQueue;
 }
 
 namespace Game
 {
+    class SystemScheduler;
     class EntitySystem;
     class ComponentSystem;
     class IdentitySystem;
     class ScriptSystem;
     class RenderSystem;
+    class ParticleSystem;
 }
 
 //
@@ -39,13 +44,18 @@ struct Context
     // Context instances.
     System::Config*          config;
     System::Timer*           timer;
+    System::JobSystem*       jobSystem;
     System::Window*          window;
     System::InputState*      inputState;
     System::ResourceManager* resourceManager;
+    Graphics::TextureLoader* textureLoader;
     Graphics::BasicRenderer* basicRenderer;
+    Graphics::RenderQueue*   renderQueue;
+    Game::SystemScheduler*   systemScheduler;
     Game::EntitySystem*      entitySystem;
     Game::ComponentSystem*   componentSystem;
     Game::IdentitySystem*    identitySystem;
     Game::ScriptSystem*      scriptSystem;
     Game::RenderSystem*      renderSystem;
+    Game::ParticleSystem*    particleSystem;
 };
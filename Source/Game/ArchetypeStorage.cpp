@@ -0,0 +1,405 @@
+#include "Precompiled.hpp"
+#include "ArchetypeStorage.hpp"
+using namespace Game;
+
+namespace
+{
+    // Aligns an offset up to a power of two.
+    std::size_t AlignOffset(std::size_t offset, std::size_t alignment)
+    {
+        return (offset + alignment - 1) & ~(alignment - 1);
+    }
+}
+
+const std::size_t ArchetypeStorage::ChunkSize;
+const int ArchetypeStorage::InvalidArchetype;
+
+ArchetypeStorage::ArchetypeStorage()
+{
+}
+
+ArchetypeStorage::~ArchetypeStorage()
+{
+    this->Cleanup();
+}
+
+void ArchetypeStorage::Cleanup()
+{
+    // Destroy all stored components.
+    for(auto& archetype : m_archetypes)
+    {
+        for(std::size_t chunk = 0; chunk < archetype->chunks.size(); ++chunk)
+        {
+            for(std::size_t row = 0; row < archetype->chunks[chunk].count; ++row)
+            {
+                for(ComponentTypeId type : archetype->types)
+                {
+                    m_types[type].destroy(this->GetComponent(*archetype, chunk, row, type));
+                }
+            }
+        }
+    }
+
+    // Clear containers.
+    Utility::ClearContainer(m_archetypes);
+    Utility::ClearContainer(m_archetypeLookup);
+    Utility::ClearContainer(m_locations);
+    Utility::ClearContainer(m_types);
+}
+
+void* ArchetypeStorage::Create(EntityHandle handle, ComponentTypeId type)
+{
+    Assert(type < m_types.size() && m_types[type].size != 0, "Component type has not been registered.");
+
+    // Validate the entity handle.
+    if(handle.identifier <= 0)
+        return nullptr;
+
+    // Make sure the location list can hold the identifier.
+    std::size_t locationIndex = handle.identifier - 1;
+
+    if(locationIndex >= m_locations.size())
+    {
+        EntityLocation location;
+        location.archetype = InvalidArchetype;
+        location.chunk = 0;
+        location.row = 0;
+
+        m_locations.resize(locationIndex + 1, location);
+    }
+
+    EntityLocation& location = m_locations[locationIndex];
+
+    // Get the current set of entity components.
+    ComponentMask mask = 0;
+
+    if(location.archetype != InvalidArchetype)
+    {
+        Assert(location.handle == handle, "Components of a destroyed entity have not been removed.");
+
+        mask = m_archetypes[location.archetype]->mask;
+    }
+
+    // Check if the entity already has this component.
+    ComponentMask typeMask = ComponentMask(1) << type;
+
+    if(mask & typeMask)
+        return nullptr;
+
+    // Move the entity to an archetype with the added component.
+    location.handle = handle;
+
+    this->MoveEntity(location, this->FindArchetype(mask | typeMask));
+
+    // Construct the new component.
+    void* component = this->GetComponent(*m_archetypes[location.archetype], location.chunk, location.row, type);
+    m_types[type].construct(component);
+
+    return component;
+}
+
+void* ArchetypeStorage::Lookup(EntityHandle handle, ComponentTypeId type)
+{
+    // Find the entity.
+    EntityLocation* location = this->GetLocation(handle);
+
+    if(location == nullptr)
+        return nullptr;
+
+    // Check if the entity has this component.
+    const Archetype& archetype = *m_archetypes[location->archetype];
+
+    if(!(archetype.mask & (ComponentMask(1) << type)))
+        return nullptr;
+
+    // Return a pointer to the component.
+    return this->GetComponent(archetype, location->chunk, location->row, type);
+}
+
+bool ArchetypeStorage::Remove(EntityHandle handle, ComponentTypeId type)
+{
+    // Find the entity.
+    EntityLocation* location = this->GetLocation(handle);
+
+    if(location == nullptr)
+        return false;
+
+    // Check if the entity has this component.
+    ComponentMask mask = m_archetypes[location->archetype]->mask;
+    ComponentMask typeMask = ComponentMask(1) << type;
+
+    if(!(mask & typeMask))
+        return false;
+
+    // Remove the entity from storage if this was its last component.
+    if(mask == typeMask)
+    {
+        this->RemoveEntity(handle);
+        return true;
+    }
+
+    // Move the entity to an archetype without the removed component.
+    this->MoveEntity(*location, this->FindArchetype(mask & ~typeMask));
+
+    return true;
+}
+
+void ArchetypeStorage::RemoveEntity(EntityHandle handle)
+{
+    // Find the entity.
+    EntityLocation* location = this->GetLocation(handle);
+
+    if(location == nullptr)
+        return;
+
+    // Remove the entity row.
+    this->RemoveRow(*m_archetypes[location->archetype], location->chunk, location->row);
+
+    location->archetype = InvalidArchetype;
+}
+
+bool ArchetypeStorage::Finalize(EntityHandle handle, const Context& context)
+{
+    // Find the entity.
+    EntityLocation* location = this->GetLocation(handle);
+
+    if(location == nullptr)
+        return true;
+
+    // Copy the list of types, as finalizing may add or remove components.
+    std::vector<ComponentTypeId> types = m_archetypes[location->archetype]->types;
+
+    // Finalize each component.
+    for(ComponentTypeId type : types)
+    {
+        void* component = this->Lookup(handle, type);
+
+        if(component == nullptr)
+            continue;
+
+        if(!m_types[type].cast(component)->Finalize(handle, context))
+            return false;
+    }
+
+    return true;
+}
+
+std::size_t ArchetypeStorage::GetArchetypeCount() const
+{
+    return m_archetypes.size();
+}
+
+const ArchetypeStorage::Archetype& ArchetypeStorage::GetArchetype(std::size_t index) const
+{
+    Assert(index < m_archetypes.size());
+    return *m_archetypes[index];
+}
+
+const EntityHandle* ArchetypeStorage::GetHandles(const Archetype& archetype, std::size_t chunk) const
+{
+    Assert(chunk < archetype.chunks.size());
+    return reinterpret_cast<const EntityHandle*>(archetype.chunks[chunk].memory->bytes);
+}
+
+void* ArchetypeStorage::GetComponents(const Archetype& archetype, std::size_t chunk, ComponentTypeId type) const
+{
+    Assert(chunk < archetype.chunks.size());
+    Assert(archetype.mask & (ComponentMask(1) << type));
+    return archetype.chunks[chunk].memory->bytes + archetype.offsets[type];
+}
+
+ArchetypeStorage::EntityLocation* ArchetypeStorage::GetLocation(EntityHandle handle)
+{
+    // Check if the identifier is in range.
+    if(handle.identifier <= 0 || handle.identifier > (int)m_locations.size())
+        return nullptr;
+
+    // Check if the entity is stored.
+    EntityLocation& location = m_locations[handle.identifier - 1];
+
+    if(location.archetype == InvalidArchetype)
+        return nullptr;
+
+    // Check if handle versions match.
+    if(location.handle != handle)
+        return nullptr;
+
+    return &location;
+}
+
+int ArchetypeStorage::FindArchetype(ComponentMask mask)
+{
+    Assert(mask != 0);
+
+    // Find an existing archetype.
+    auto it = m_archetypeLookup.find(mask);
+
+    if(it != m_archetypeLookup.end())
+        return it->second;
+
+    // Create a new archetype.
+    auto archetype = std::make_unique<Archetype>();
+    archetype->mask = mask;
+    archetype->capacity = 0;
+    archetype->entityCount = 0;
+
+    std::size_t rowSize = sizeof(EntityHandle);
+
+    for(ComponentTypeId type = 0; type < m_types.size(); ++type)
+    {
+        if(mask & (ComponentMask(1) << type))
+        {
+            archetype->types.push_back(type);
+            rowSize += m_types[type].size;
+        }
+
+        archetype->offsets[type] = 0;
+    }
+
+    // Fit as many rows as possible, leaving room for padding between arrays.
+    std::size_t capacity = ChunkSize / rowSize;
+
+    while(capacity > 0)
+    {
+        std::size_t offset = capacity * sizeof(EntityHandle);
+
+        for(ComponentTypeId type : archetype->types)
+        {
+            offset = AlignOffset(offset, m_types[type].alignment);
+            archetype->offsets[type] = offset;
+            offset += capacity * m_types[type].size;
+        }
+
+        if(offset <= ChunkSize)
+            break;
+
+        --capacity;
+    }
+
+    Assert(capacity > 0, "Components do not fit in a chunk!");
+
+    archetype->capacity = capacity;
+
+    // Add the archetype to the list.
+    int index = (int)m_archetypes.size();
+
+    m_archetypes.push_back(std::move(archetype));
+    m_archetypeLookup.emplace(mask, index);
+
+    return index;
+}
+
+void ArchetypeStorage::MoveEntity(EntityLocation& location, int target)
+{
+    Assert(target != InvalidArchetype);
+    Assert(target != location.archetype);
+
+    // Add a row to the target archetype.
+    Archetype& destination = *m_archetypes[target];
+
+    std::size_t chunk = 0;
+    std::size_t row = 0;
+
+    this->AddRow(destination, location.handle, chunk, row);
+
+    // Move components present in both archetypes and remove the old row.
+    if(location.archetype != InvalidArchetype)
+    {
+        Archetype& source = *m_archetypes[location.archetype];
+
+        for(ComponentTypeId type : source.types)
+        {
+            if(destination.mask & (ComponentMask(1) << type))
+            {
+                void* component = this->GetComponent(destination, chunk, row, type);
+                void* previous = this->GetComponent(source, location.chunk, location.row, type);
+
+                m_types[type].moveConstruct(component, previous);
+            }
+        }
+
+        this->RemoveRow(source, location.chunk, location.row);
+    }
+
+    // Update the entity location.
+    location.archetype = target;
+    location.chunk = chunk;
+    location.row = row;
+}
+
+void ArchetypeStorage::AddRow(Archetype& archetype, EntityHandle handle, std::size_t& chunk, std::size_t& row)
+{
+    // Allocate a new chunk if the last one is full.
+    if(archetype.chunks.empty() || archetype.chunks.back().count == archetype.capacity)
+    {
+        Chunk newChunk;
+        newChunk.memory = std::make_unique<ChunkMemory>();
+        newChunk.count = 0;
+
+        archetype.chunks.push_back(std::move(newChunk));
+    }
+
+    // Append a row to the last chunk.
+    Chunk& lastChunk = archetype.chunks.back();
+
+    chunk = archetype.chunks.size() - 1;
+    row = lastChunk.count++;
+
+    EntityHandle* handles = reinterpret_cast<EntityHandle*>(lastChunk.memory->bytes);
+    new (&handles[row]) EntityHandle(handle);
+
+    ++archetype.entityCount;
+}
+
+void ArchetypeStorage::RemoveRow(Archetype& archetype, std::size_t chunk, std::size_t row)
+{
+    Assert(chunk < archetype.chunks.size());
+    Assert(row < archetype.chunks[chunk].count);
+
+    // Find the last row of the archetype.
+    std::size_t lastChunk = archetype.chunks.size() - 1;
+    std::size_t lastRow = archetype.chunks[lastChunk].count - 1;
+
+    bool isLast = chunk == lastChunk && row == lastRow;
+
+    // Destroy components and move the last row in their place.
+    for(ComponentTypeId type : archetype.types)
+    {
+        void* component = this->GetComponent(archetype, chunk, row, type);
+        m_types[type].destroy(component);
+
+        if(!isLast)
+        {
+            void* last = this->GetComponent(archetype, lastChunk, lastRow, type);
+
+            m_types[type].moveConstruct(component, last);
+            m_types[type].destroy(last);
+        }
+    }
+
+    // Move the last entity handle and update its location.
+    if(!isLast)
+    {
+        EntityHandle* handles = reinterpret_cast<EntityHandle*>(archetype.chunks[chunk].memory->bytes);
+        EntityHandle* lastHandles = reinterpret_cast<EntityHandle*>(archetype.chunks[lastChunk].memory->bytes);
+
+        handles[row] = lastHandles[lastRow];
+
+        EntityLocation& location = m_locations[handles[row].identifier - 1];
+        location.chunk = chunk;
+        location.row = row;
+    }
+
+    // Release the last chunk once it becomes empty.
+    if(--archetype.chunks[lastChunk].count == 0)
+    {
+        archetype.chunks.pop_back();
+    }
+
+    --archetype.entityCount;
+}
+
+void* ArchetypeStorage::GetComponent(const Archetype& archetype, std::size_t chunk, std::size_t row, ComponentTypeId type) const
+{
+    return archetype.chunks[chunk].memory->bytes + archetype.offsets[type] + row * m_types[type].size;
+}
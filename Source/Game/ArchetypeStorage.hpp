@@ -0,0 +1,227 @@
+#pragma once
+
+#include "Precompiled.hpp"
+#include "Component.hpp"
+
+//
+// Archetype Storage
+//
+//  Stores components of entities grouped by their sets of component types,
+//  called archetypes. Each archetype keeps its entities in fixed size chunks
+//  of memory, which hold a separate array for each component type. Adding or
+//  removing a component moves the entity and its components to a different
+//  archetype, while queries visit only chunks of matching archetypes.
+//  Alternative to component pools, see ComponentSystem for more context.
+//
+//  Layout of a chunk:
+//      [Handles...][Padding][Components A...][Padding][Components B...]
+//
+//  Pointers to components are not stable. They become invalid when any
+//  entity of the same archetype is moved or removed.
+//
+
+namespace Game
+{
+    // Component type info structure.
+    struct ComponentTypeInfo
+    {
+        ComponentTypeInfo() :
+            size(0),
+            alignment(0),
+            construct(nullptr),
+            moveConstruct(nullptr),
+            destroy(nullptr),
+            cast(nullptr)
+        {
+        }
+
+        // Creates type info of a component type.
+        template<typename Type>
+        static ComponentTypeInfo Create();
+
+        // Type layout.
+        std::size_t size;
+        std::size_t alignment;
+
+        // Type erased operations.
+        void (*construct)(void* memory);
+        void (*moveConstruct)(void* memory, void* source);
+        void (*destroy)(void* memory);
+        Component* (*cast)(void* memory);
+    };
+
+    // Archetype storage class.
+    class ArchetypeStorage : private NonCopyable
+    {
+    public:
+        // Constant variables.
+        static const std::size_t ChunkSize = 16 * 1024;
+        static const int InvalidArchetype = -1;
+
+        // Chunk memory structure.
+        struct ChunkMemory
+        {
+            alignas(16) uint8_t bytes[ChunkSize];
+        };
+
+        // Chunk structure.
+        struct Chunk
+        {
+            std::unique_ptr<ChunkMemory> memory;
+            std::size_t count;
+        };
+
+        // Archetype structure.
+        struct Archetype
+        {
+            // Set of component types.
+            ComponentMask mask;
+            std::vector<ComponentTypeId> types;
+
+            // Offsets of component arrays in a chunk.
+            std::size_t offsets[MaximumComponentTypes];
+
+            // Number of entities that fit in a chunk.
+            std::size_t capacity;
+
+            // List of chunks.
+            std::vector<Chunk> chunks;
+            std::size_t entityCount;
+        };
+
+        // Entity location structure.
+        struct EntityLocation
+        {
+            EntityHandle handle;
+            int archetype;
+            std::size_t chunk;
+            std::size_t row;
+        };
+
+        // Type declarations.
+        typedef std::vector<ComponentTypeInfo>               TypeList;
+        typedef std::vector<std::unique_ptr<Archetype>>      ArchetypeList;
+        typedef std::unordered_map<ComponentMask, int>       ArchetypeLookupList;
+        typedef std::vector<EntityLocation>                  LocationList;
+
+    public:
+        ArchetypeStorage();
+        ~ArchetypeStorage();
+
+        // Restores instance to it's original state.
+        void Cleanup();
+
+        // Registers a component type.
+        template<typename Type>
+        void RegisterType();
+
+        // Creates a component.
+        void* Create(EntityHandle handle, ComponentTypeId type);
+
+        // Lookups a component.
+        void* Lookup(EntityHandle handle, ComponentTypeId type);
+
+        // Removes a component.
+        bool Remove(EntityHandle handle, ComponentTypeId type);
+
+        // Removes all components of an entity.
+        void RemoveEntity(EntityHandle handle);
+
+        // Finalizes all components of an entity.
+        bool Finalize(EntityHandle handle, const Context& context);
+
+        // Gets the number of archetypes.
+        std::size_t GetArchetypeCount() const;
+
+        // Gets an archetype.
+        const Archetype& GetArchetype(std::size_t index) const;
+
+        // Gets the array of entity handles in a chunk.
+        const EntityHandle* GetHandles(const Archetype& archetype, std::size_t chunk) const;
+
+        // Gets the array of components in a chunk.
+        void* GetComponents(const Archetype& archetype, std::size_t chunk, ComponentTypeId type) const;
+
+    private:
+        // Gets the location of a stored entity.
+        EntityLocation* GetLocation(EntityHandle handle);
+
+        // Finds or creates an archetype.
+        int FindArchetype(ComponentMask mask);
+
+        // Moves an entity to a different archetype.
+        void MoveEntity(EntityLocation& location, int target);
+
+        // Adds a row for an entity at the end of an archetype.
+        void AddRow(Archetype& archetype, EntityHandle handle, std::size_t& chunk, std::size_t& row);
+
+        // Removes a row by moving the last row of an archetype in its place.
+        void RemoveRow(Archetype& archetype, std::size_t chunk, std::size_t row);
+
+        // Gets a pointer to a component in a row.
+        void* GetComponent(const Archetype& archetype, std::size_t chunk, std::size_t row, ComponentTypeId type) const;
+
+    private:
+        // Registered component types.
+        TypeList m_types;
+
+        // List of archetypes.
+        ArchetypeList m_archetypes;
+        ArchetypeLookupList m_archetypeLookup;
+
+        // Locations of entities.
+        LocationList m_locations;
+    };
+
+    // Template definitions.
+    template<typename Type>
+    ComponentTypeInfo ComponentTypeInfo::Create()
+    {
+        static_assert(std::is_base_of<Component, Type>::value, "Not a component type.");
+
+        ComponentTypeInfo info;
+        info.size = sizeof(Type);
+        info.alignment = std::alignment_of<Type>::value;
+
+        info.construct = [](void* memory)
+        {
+            new (memory) Type();
+        };
+
+        info.moveConstruct = [](void* memory, void* source)
+        {
+            new (memory) Type(std::move(*static_cast<Type*>(source)));
+        };
+
+        info.destroy = [](void* memory)
+        {
+            static_cast<Type*>(memory)->~Type();
+        };
+
+        info.cast = [](void* memory) -> Component*
+        {
+            return static_cast<Type*>(memory);
+        };
+
+        return info;
+    }
+
+    template<typename Type>
+    void ArchetypeStorage::RegisterType()
+    {
+        ComponentTypeId type = GetComponentTypeId<Type>();
+        Assert(type < MaximumComponentTypes);
+
+        // Make sure the type list can hold the type.
+        if(type >= m_types.size())
+        {
+            m_types.resize(type + 1);
+        }
+
+        // Create the type info once.
+        if(m_types[type].size == 0)
+        {
+            m_types[type] = ComponentTypeInfo::Create<Type>();
+        }
+    }
+}
@@ -10,18 +10,75 @@ struct Context;
 // Component
 //
 //  Base class for component types.
+//  Component types must be movable, as they are
+//  stored in contiguous arrays by component pools
+//  or moved between chunks of archetype storage.
+//
+//  Each component type is given a sequential identifier the first time
+//  it is used, which indexes component pools and bits of entity masks.
+//
+//  Components remember the version at which they were last changed.
+//  Component types should call MarkChanged() from their mutators, so
+//  systems can skip components that did not change since they last ran.
+//
+//  Checking for changes since the last run of a system:
+//      ComponentVersion since = m_lastVersion;
+//      m_lastVersion = Game::AdvanceComponentVersion();
+//
+//      if(transform.IsChangedSince(since))
+//      {
+//          /* ... */
+//      }
+//
+//  Components created by the component system also remember their type,
+//  so the last version at which any component of a type was created,
+//  changed or removed is known. Systems can skip whole views when none
+//  of their component types changed (see ComponentSystem::IsChangedSince).
 //
 
 namespace Game
 {
+    // Forward declarations.
+    class ComponentSystem;
+
+    // Type declarations.
+    typedef uint32_t    ComponentVersion;
+    typedef std::size_t ComponentTypeId;
+    typedef uint64_t    ComponentMask;
+
+    // Maximum number of component types.
+    const std::size_t MaximumComponentTypes = 64;
+
+    // Identifier of components without a known type.
+    const uint32_t InvalidComponentTypeId = std::numeric_limits<uint32_t>::max();
+
+    // Gets the current component version.
+    ComponentVersion GetComponentVersion();
+
+    // Advances the component version and returns the previous one.
+    // Changes made after this call will be newer than the returned version.
+    ComponentVersion AdvanceComponentVersion();
+
+    // Gets the version of the last change of any component of a type.
+    ComponentVersion GetComponentTypeVersion(ComponentTypeId type);
+
+    // Marks components of a type as changed at the current version.
+    void MarkComponentTypeChanged(ComponentTypeId type);
+
     // Component base class.
     class Component : private NonCopyable
     {
     protected:
-        Component()
+        Component() :
+            m_version(GetComponentVersion()),
+            m_type(InvalidComponentTypeId)
         {
         }
 
+        // Move constructor and operator.
+        Component(Component&&) = default;
+        Component& operator=(Component&&) = default;
+
     public:
         virtual ~Component()
         {
@@ -32,5 +89,59 @@ namespace Game
         {
             return true;
         }
+
+        // Gets the version of the last change.
+        ComponentVersion GetVersion() const
+        {
+            return m_version;
+        }
+
+        // Checks if the component changed after a version.
+        bool IsChangedSince(ComponentVersion version) const
+        {
+            return m_version > version;
+        }
+
+    protected:
+        // Marks the component as changed.
+        void MarkChanged()
+        {
+            m_version = GetComponentVersion();
+
+            if(m_type != InvalidComponentTypeId)
+            {
+                MarkComponentTypeChanged(m_type);
+            }
+        }
+
+    private:
+        // Component system sets the type of created components.
+        friend class ComponentSystem;
+
+        // Version of the last change.
+        ComponentVersion m_version;
+
+        // Component type identifier.
+        uint32_t m_type;
     };
+
+    // Allocates a new component type identifier.
+    ComponentTypeId AllocateComponentTypeId();
+
+    // Gets the identifier of a component type.
+    template<typename Type>
+    ComponentTypeId GetComponentTypeId()
+    {
+        static_assert(std::is_base_of<Component, Type>::value, "Not a component type.");
+
+        static const ComponentTypeId identifier = AllocateComponentTypeId();
+        return identifier;
+    }
+
+    // Gets the mask bit of a component type.
+    template<typename Type>
+    ComponentMask GetComponentTypeMask()
+    {
+        return ComponentMask(1) << GetComponentTypeId<Type>();
+    }
 }
@@ -8,12 +8,26 @@
 //  Manages a single type of component.
 //  See ComponentSystem for more context.
 //
+//  Components are kept in a dense array along with their entity handles,
+//  while a sparse array indexed by entity identifiers points into it.
+//  Removed components are replaced by the last one in the dense array,
+//  which means that pointers to components of the same type become
+//  invalid every time a component is created or removed.
+//
 
 namespace Game
 {
+    // Forward declarations.
+    template<typename Type>
+    class ComponentPool;
+
     // Component pool interface class.
     class ComponentPoolInterface
     {
+    public:
+        // Type declarations.
+        typedef std::vector<EntityHandle> HandleList;
+
     protected:
         ComponentPoolInterface()
         {
@@ -24,8 +38,88 @@ namespace Game
         {
         }
 
-        virtual bool Finalize(EntityHandle handle, const Context& context) = 0;
+        virtual void Finalize(Span<const EntityHandle> handles, Span<uint8_t> results, const Context& context) = 0;
         virtual bool Remove(EntityHandle handle) = 0;
+        virtual void Remove(Span<const EntityHandle> handles) = 0;
+        virtual const HandleList& GetHandles() const = 0;
+    };
+
+    // Component pool iterator class.
+    template<typename Type>
+    class ComponentPoolIterator
+    {
+    public:
+        // Type declarations.
+        typedef std::pair<const EntityHandle&, Type&> ValueType;
+
+        // Pointer proxy structure.
+        struct PointerProxy
+        {
+            ValueType* operator->()
+            {
+                return &value;
+            }
+
+            ValueType value;
+        };
+
+    public:
+        ComponentPoolIterator() :
+            m_pool(nullptr),
+            m_index(0)
+        {
+        }
+
+        ComponentPoolIterator(ComponentPool<Type>* pool, std::size_t index) :
+            m_pool(pool),
+            m_index(index)
+        {
+        }
+
+        // Dereference operators.
+        ValueType operator*() const
+        {
+            Assert(m_pool != nullptr);
+            return ValueType(m_pool->m_handles[m_index], m_pool->m_components[m_index]);
+        }
+
+        PointerProxy operator->() const
+        {
+            PointerProxy proxy = { **this };
+            return proxy;
+        }
+
+        // Increment operators.
+        ComponentPoolIterator& operator++()
+        {
+            ++m_index;
+            return *this;
+        }
+
+        ComponentPoolIterator operator++(int)
+        {
+            ComponentPoolIterator previous(*this);
+            ++m_index;
+            return previous;
+        }
+
+        // Comparison operators.
+        bool operator==(const ComponentPoolIterator& other) const
+        {
+            return m_pool == other.m_pool && m_index == other.m_index;
+        }
+
+        bool operator!=(const ComponentPoolIterator& other) const
+        {
+            return !(*this == other);
+        }
+
+    private:
+        // Iterated pool.
+        ComponentPool<Type>* m_pool;
+
+        // Index in the dense array.
+        std::size_t m_index;
     };
 
     // Component pool class.
@@ -37,8 +131,12 @@ namespace Game
         static_assert(std::is_base_of<Component, Type>::value, "Not a component type.");
 
         // Type declarations.
-        typedef std::unordered_map<EntityHandle, Type> ComponentList;
-        typedef typename ComponentList::iterator       ComponentIterator;
+        typedef std::vector<Type>           ComponentList;
+        typedef std::vector<int>            LookupList;
+        typedef ComponentPoolIterator<Type> ComponentIterator;
+
+        // Constant variables.
+        static const int InvalidIndex = -1;
 
     public:
         ComponentPool();
@@ -53,15 +151,27 @@ namespace Game
         // Lookups a component.
         Type* Lookup(EntityHandle handle);
 
-        // Finalizes a component.
-        bool Finalize(EntityHandle handle, const Context& context) override;
+        // Finalizes components of entities.
+        void Finalize(Span<const EntityHandle> handles, Span<uint8_t> results, const Context& context) override;
 
         // Removes a component.
         bool Remove(EntityHandle handle) override;
 
+        // Removes components of entities.
+        void Remove(Span<const EntityHandle> handles) override;
+
+        // Reserves memory for additional components.
+        void Reserve(std::size_t count);
+
         // Clears all components.
         void Clear();
 
+        // Gets the number of components.
+        std::size_t GetCount() const;
+
+        // Gets the list of component owners.
+        const HandleList& GetHandles() const override;
+
         // Gets the begin iterator.
         ComponentIterator Begin();
 
@@ -69,11 +179,27 @@ namespace Game
         ComponentIterator End();
 
     private:
-        // List of components.
+        // Gets the dense index of a component.
+        int GetIndex(EntityHandle handle) const;
+
+    private:
+        // Dense list of components.
         ComponentList m_components;
+
+        // Dense list of component owners.
+        HandleList m_handles;
+
+        // Sparse list of dense indices.
+        LookupList m_lookup;
+
+        // Allow iterators to access dense lists.
+        friend class ComponentPoolIterator<Type>;
     };
 
     // Template definitions.
+    template<typename Type>
+    const int ComponentPool<Type>::InvalidIndex;
+
     template<typename Type>
     ComponentPool<Type>::ComponentPool()
     {
@@ -87,77 +213,183 @@ namespace Game
     template<typename Type>
     void ComponentPool<Type>::Cleanup()
     {
-        *this = ComponentPool<Type>();
+        Utility::ClearContainer(m_components);
+        Utility::ClearContainer(m_handles);
+        Utility::ClearContainer(m_lookup);
     }
 
     template<typename Type>
     Type* ComponentPool<Type>::Create(EntityHandle handle)
     {
-        // Create a new component for this entity handle.
-        auto result = m_components.emplace(std::piecewise_construct, std::forward_as_tuple(handle), std::forward_as_tuple());
+        // Validate the entity handle.
+        if(handle.identifier <= 0)
+            return nullptr;
+
+        // Make sure the sparse list can hold the identifier.
+        std::size_t lookupIndex = handle.identifier - 1;
+
+        if(lookupIndex >= m_lookup.size())
+        {
+            m_lookup.resize(lookupIndex + 1, InvalidIndex);
+        }
 
-        if(result.second == false)
+        // Check if the entity already has this component.
+        if(m_lookup[lookupIndex] != InvalidIndex)
+        {
+            Assert(m_handles[m_lookup[lookupIndex]] == handle, "Component of a destroyed entity has not been removed.");
             return nullptr;
+        }
+
+        // Create a new component for this entity handle.
+        m_components.emplace_back();
+        m_handles.push_back(handle);
+
+        m_lookup[lookupIndex] = (int)m_components.size() - 1;
 
         // Return a pointer to a newly created component.
-        return &result.first->second;
+        return &m_components.back();
     }
 
     template<typename Type>
     Type* ComponentPool<Type>::Lookup(EntityHandle handle)
     {
         // Find a component.
-        auto result = m_components.find(handle);
+        int index = this->GetIndex(handle);
 
-        if(result == m_components.end())
+        if(index == InvalidIndex)
             return nullptr;
 
-        // Make sure handles match.
-        Assert(result->first == handle);
-
         // Return a pointer to the component.
-        return &result->second;
+        return &m_components[index];
     }
 
     template<typename Type>
-    bool ComponentPool<Type>::Finalize(EntityHandle handle, const Context& context)
+    void ComponentPool<Type>::Finalize(Span<const EntityHandle> handles, Span<uint8_t> results, const Context& context)
     {
+        Assert(handles.GetSize() == results.GetSize());
+
         if(m_components.empty())
-            return true;
+            return;
 
-        // Find the component.
-        Component* component = this->Lookup(handle);
+        for(std::size_t i = 0; i < handles.GetSize(); ++i)
+        {
+            // Skip entities that already failed to finalize.
+            if(!results[i])
+                continue;
+
+            // Find the component.
+            Component* component = this->Lookup(handles[i]);
+
+            // Call the finalizing function.
+            if(component != nullptr)
+            {
+                results[i] = component->Finalize(handles[i], context);
+            }
+        }
+    }
 
-        // Call the finalizing function.
-        if(component != nullptr)
+    template<typename Type>
+    bool ComponentPool<Type>::Remove(EntityHandle handle)
+    {
+        // Find a component.
+        int index = this->GetIndex(handle);
+
+        if(index == InvalidIndex)
+            return false;
+
+        // Move the last component in place of the removed one.
+        int lastIndex = (int)m_components.size() - 1;
+
+        if(index != lastIndex)
         {
-            return component->Finalize(handle, context);
+            m_components[index] = std::move(m_components[lastIndex]);
+            m_handles[index] = m_handles[lastIndex];
+
+            m_lookup[m_handles[index].identifier - 1] = index;
         }
 
+        // Remove the component.
+        m_lookup[handle.identifier - 1] = InvalidIndex;
+
+        m_components.pop_back();
+        m_handles.pop_back();
+
         return true;
     }
 
     template<typename Type>
-    bool ComponentPool<Type>::Remove(EntityHandle handle)
+    void ComponentPool<Type>::Remove(Span<const EntityHandle> handles)
+    {
+        if(m_components.empty())
+            return;
+
+        for(const EntityHandle& handle : handles)
+        {
+            this->Remove(handle);
+        }
+    }
+
+    template<typename Type>
+    void ComponentPool<Type>::Reserve(std::size_t count)
     {
-        return m_components.erase(handle) == 1;
+        m_components.reserve(m_components.size() + count);
+        m_handles.reserve(m_handles.size() + count);
     }
 
     template<typename Type>
     void ComponentPool<Type>::Clear()
     {
         m_components.clear();
+        m_handles.clear();
+        m_lookup.clear();
+    }
+
+    template<typename Type>
+    std::size_t ComponentPool<Type>::GetCount() const
+    {
+        return m_components.size();
+    }
+
+    template<typename Type>
+    const typename ComponentPool<Type>::HandleList& ComponentPool<Type>::GetHandles() const
+    {
+        return m_handles;
     }
 
     template<typename Type>
     typename ComponentPool<Type>::ComponentIterator ComponentPool<Type>::Begin()
     {
-        return m_components.begin();
+        return ComponentIterator(this, 0);
     }
 
     template<typename Type>
     typename ComponentPool<Type>::ComponentIterator ComponentPool<Type>::End()
     {
-        return m_components.end();
+        return ComponentIterator(this, m_components.size());
+    }
+
+    template<typename Type>
+    int ComponentPool<Type>::GetIndex(EntityHandle handle) const
+    {
+        // Check if the identifier is in range.
+        if(handle.identifier <= 0)
+            return InvalidIndex;
+
+        std::size_t lookupIndex = handle.identifier - 1;
+
+        if(lookupIndex >= m_lookup.size())
+            return InvalidIndex;
+
+        // Get the dense index.
+        int index = m_lookup[lookupIndex];
+
+        if(index == InvalidIndex)
+            return InvalidIndex;
+
+        // Check if handle versions match.
+        if(m_handles[index] != handle)
+            return InvalidIndex;
+
+        return index;
     }
 }
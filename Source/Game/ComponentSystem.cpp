@@ -8,9 +8,57 @@ namespace
 {
     // Log error messages.
     #define LogInitializeError() "Failed to initialize the component system! "
+
+    // Number of allocated component type identifiers.
+    std::atomic<ComponentTypeId> componentTypeCount(0);
+
+    // Current version of component changes.
+    std::atomic<ComponentVersion> componentVersion(1);
+
+    // Versions of the last change of each component type.
+    std::atomic<ComponentVersion> componentTypeVersions[MaximumComponentTypes];
+}
+
+ComponentTypeId Game::AllocateComponentTypeId()
+{
+    ComponentTypeId identifier = componentTypeCount++;
+    Assert(identifier < MaximumComponentTypes, "Too many component types!");
+    return identifier;
+}
+
+ComponentVersion Game::GetComponentVersion()
+{
+    return componentVersion.load(std::memory_order_relaxed);
+}
+
+ComponentVersion Game::AdvanceComponentVersion()
+{
+    return componentVersion.fetch_add(1, std::memory_order_relaxed);
+}
+
+ComponentVersion Game::GetComponentTypeVersion(ComponentTypeId type)
+{
+    Assert(type < MaximumComponentTypes);
+
+    return componentTypeVersions[type].load(std::memory_order_relaxed);
+}
+
+void Game::MarkComponentTypeChanged(ComponentTypeId type)
+{
+    Assert(type < MaximumComponentTypes);
+
+    // Avoid writing to the shared version when it is already current,
+    // as components of a type are often changed from many threads.
+    ComponentVersion version = GetComponentVersion();
+
+    if(componentTypeVersions[type].load(std::memory_order_relaxed) != version)
+    {
+        componentTypeVersions[type].store(version, std::memory_order_relaxed);
+    }
 }
 
 ComponentSystem::ComponentSystem() :
+    m_storage(ComponentStorage::Pools),
     m_context(nullptr),
     m_initialized(false)
 {
@@ -31,6 +79,11 @@ void ComponentSystem::Cleanup()
 
     // Clear all component pools.
     Utility::ClearContainer(m_pools);
+    Utility::ClearContainer(m_masks);
+
+    // Clear archetype storage.
+    m_archetypes.Cleanup();
+    m_storage = ComponentStorage::Pools;
 
     // Unsubscribe event signals.
     m_entityFinalize.Unsubscribe();
@@ -43,7 +96,7 @@ void ComponentSystem::Cleanup()
     m_initialized = false;
 }
 
-bool ComponentSystem::Initialize(Context& context)
+bool ComponentSystem::Initialize(Context& context, ComponentStorage::Type storage)
 {
     Assert(context.entitySystem != nullptr);
     Assert(context.componentSystem == nullptr);
@@ -61,6 +114,9 @@ bool ComponentSystem::Initialize(Context& context)
         }
     );
 
+    // Set the component storage type.
+    m_storage = storage;
+
     // Subscribe event receivers.
     context.entitySystem->events.entityFinalize.Subscribe(m_entityFinalize);
     context.entitySystem->events.entityDestroyed.Subscribe(m_entityDestroyed);
@@ -75,31 +131,231 @@ bool ComponentSystem::Initialize(Context& context)
     return m_initialized = true;
 }
 
-bool ComponentSystem::OnEntityFinalize(EntityHandle handle)
+ComponentMask ComponentSystem::GetComponentMask(EntityHandle handle) const
+{
+    if(!m_initialized)
+        return 0;
+
+    // Check if the identifier is in range.
+    if(handle.identifier <= 0 || handle.identifier > (int)m_masks.size())
+        return 0;
+
+    // Check if the mask belongs to the same handle version.
+    const ComponentMaskEntry& entry = m_masks[handle.identifier - 1];
+
+    if(entry.version != handle.version)
+        return 0;
+
+    return entry.mask;
+}
+
+ComponentSystem::EntityQuery ComponentSystem::BeginQuery(ComponentMask mask) const
+{
+    EntityQuery query;
+    query.mask = mask;
+    query.handles = nullptr;
+    query.archetype = 0;
+    query.chunk = 0;
+    query.index = 0;
+
+    if(!m_initialized || mask == 0)
+        return query;
+
+    // Archetypes are matched while advancing the query.
+    if(m_storage == ComponentStorage::Archetypes)
+        return query;
+
+    // Drive the query from the smallest pool.
+    for(ComponentTypeId type = 0; type < MaximumComponentTypes; ++type)
+    {
+        if(!(mask & (ComponentMask(1) << type)))
+            continue;
+
+        if(type >= m_pools.size() || m_pools[type] == nullptr)
+        {
+            query.handles = nullptr;
+            break;
+        }
+
+        const ComponentPoolInterface::HandleList& handles = m_pools[type]->GetHandles();
+
+        if(query.handles == nullptr || handles.size() < query.handles->size())
+        {
+            query.handles = &handles;
+        }
+    }
+
+    return query;
+}
+
+bool ComponentSystem::NextQuery(EntityQuery& query, EntityHandle& entity) const
+{
+    if(!m_initialized || query.mask == 0)
+        return false;
+
+    // Walk chunks of matching archetypes.
+    if(m_storage == ComponentStorage::Archetypes)
+    {
+        while(query.archetype < m_archetypes.GetArchetypeCount())
+        {
+            const ArchetypeStorage::Archetype& archetype = m_archetypes.GetArchetype(query.archetype);
+
+            if((archetype.mask & query.mask) == query.mask && query.chunk < archetype.chunks.size())
+            {
+                if(query.index < archetype.chunks[query.chunk].count)
+                {
+                    entity = m_archetypes.GetHandles(archetype, query.chunk)[query.index++];
+                    return true;
+                }
+
+                query.index = 0;
+                ++query.chunk;
+                continue;
+            }
+
+            query.index = 0;
+            query.chunk = 0;
+            ++query.archetype;
+        }
+
+        return false;
+    }
+
+    // Walk the driving pool and check masks of remaining components.
+    if(query.handles == nullptr)
+        return false;
+
+    while(query.index < query.handles->size())
+    {
+        const EntityHandle& handle = (*query.handles)[query.index++];
+
+        if((this->GetComponentMask(handle) & query.mask) == query.mask)
+        {
+            entity = handle;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+ComponentSystem::ComponentStorage::Type ComponentSystem::GetStorage() const
+{
+    return m_storage;
+}
+
+void ComponentSystem::SetComponentBits(EntityHandle handle, ComponentMask mask)
+{
+    Assert(m_initialized);
+    Assert(handle.identifier > 0);
+
+    // Make sure the mask list can hold the identifier.
+    if(handle.identifier > (int)m_masks.size())
+    {
+        ComponentMaskEntry empty;
+        empty.version = 0;
+        empty.mask = 0;
+
+        m_masks.resize(handle.identifier, empty);
+    }
+
+    // Reset the mask left by a previous version of the handle.
+    ComponentMaskEntry& entry = m_masks[handle.identifier - 1];
+
+    if(entry.version != handle.version)
+    {
+        entry.version = handle.version;
+        entry.mask = 0;
+    }
+
+    entry.mask |= mask;
+}
+
+void ComponentSystem::ClearComponentBits(EntityHandle handle, ComponentMask mask)
+{
+    Assert(m_initialized);
+
+    if(handle.identifier <= 0 || handle.identifier > (int)m_masks.size())
+        return;
+
+    // Ignore stale handles.
+    ComponentMaskEntry& entry = m_masks[handle.identifier - 1];
+
+    if(entry.version != handle.version)
+        return;
+
+    entry.mask &= ~mask;
+}
+
+void ComponentSystem::OnEntityFinalize(Span<const EntityHandle> handles, Span<uint8_t> results)
 {
     Assert(m_initialized);
     Assert(m_context != nullptr);
 
-    // Finalize entity components from every pool.
-    for(auto& pair : m_pools)
+    // Finalize entity components from archetypes.
+    if(m_storage == ComponentStorage::Archetypes)
     {
-        auto& pool = pair.second;
+        for(std::size_t i = 0; i < handles.GetSize(); ++i)
+        {
+            if(results[i])
+            {
+                results[i] = m_archetypes.Finalize(handles[i], *m_context);
+            }
+        }
 
-        if(!pool->Finalize(handle, *m_context))
-            return false;
+        return;
     }
 
-    return true;
+    // Finalize entity components from every pool.
+    for(auto& pool : m_pools)
+    {
+        if(pool != nullptr)
+        {
+            pool->Finalize(handles, results, *m_context);
+        }
+    }
 }
 
-void ComponentSystem::OnEntityDestroyed(EntityHandle handle)
+void ComponentSystem::OnEntityDestroyed(Span<const EntityHandle> handles)
 {
     Assert(m_initialized);
 
-    // Remove entity components from every pool.
-    for(auto& pair : m_pools)
+    // Collect component types owned by any of the entities.
+    ComponentMask mask = 0;
+
+    for(const EntityHandle& handle : handles)
+    {
+        mask |= this->GetComponentMask(handle);
+        this->ClearComponentBits(handle, ~ComponentMask(0));
+    }
+
+    // Mark removed component types as changed.
+    for(ComponentTypeId type = 0; type < MaximumComponentTypes; ++type)
+    {
+        if(mask & (ComponentMask(1) << type))
+        {
+            MarkComponentTypeChanged(type);
+        }
+    }
+
+    // Remove all entity components from archetypes.
+    if(m_storage == ComponentStorage::Archetypes)
     {
-        auto& pool = pair.second;
-        pool->Remove(handle);
+        for(const EntityHandle& handle : handles)
+        {
+            m_archetypes.RemoveEntity(handle);
+        }
+
+        return;
+    }
+
+    // Remove the whole batch only from pools that have components of it.
+    for(ComponentTypeId type = 0; mask != 0; ++type, mask >>= 1)
+    {
+        if(mask & 1)
+        {
+            Assert(m_pools[type] != nullptr);
+            m_pools[type]->Remove(handles);
+        }
     }
 }
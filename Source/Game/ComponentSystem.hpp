@@ -3,6 +3,8 @@
 #include "Precompiled.hpp"
 #include "Component.hpp"
 #include "ComponentPool.hpp"
+#include "ArchetypeStorage.hpp"
+#include "ComponentView.hpp"
 
 // Forward declarations.
 struct Context;
@@ -24,7 +26,7 @@ struct Context;
 //          /* ... */
 //      };
 //
-//  Iterate over all components of a type:
+//  Iterate over all components of a type (component pools only):
 //      auto componentsBegin = m_componentSystem->Begin<Components::Class>();
 //      auto componentsEnd = m_componentSystem->End<Components::Class>();
 //      
@@ -36,6 +38,42 @@ struct Context;
 //          /* ... */
 //      }
 //
+//  Iterate over entities that have all of the specified components:
+//      auto view = m_componentSystem->View<Components::Transform, Components::Render>();
+//
+//      for(auto it = view.Begin(); it != view.End(); ++it)
+//      {
+//          const EntityHandle& entity = it.GetEntity();
+//          Components::Transform& transform = it.Get<Components::Transform>();
+//          Components::Render& render = it.Get<Components::Render>();
+//
+//          /* ... */
+//      }
+//
+//  Pointers to components are not stable. They become invalid when another
+//  component of the same type is created or removed, so they should not be
+//  kept across frames. Lookup components by entity handles instead.
+//
+//  Pools are stored in a flat array indexed by component type identifiers.
+//  Every entity has a mask of component types it owns, so components must
+//  be created and removed through the component system, not its pools.
+//  Masks keep the version of their entity handle, so stale handles of
+//  reused identifiers have empty masks.
+//
+//  Components can be stored either in per type pools (default) or in chunks
+//  of archetypes (see ArchetypeStorage), which is chosen per instance when
+//  the system is initialized. Pools make adding and removing components cheap,
+//  while archetypes favor iterating over views of many component types.
+//
+//  Skipping a view when none of its component types changed:
+//      if(m_componentSystem->IsChangedSince<Components::Transform>(lastVersion))
+//      {
+//          auto view = m_componentSystem->View<Components::Transform>();
+//          /* ... */
+//      }
+//
+//  Change versions of component types are shared by all component systems.
+//
 
 namespace Game
 {
@@ -44,9 +82,37 @@ namespace Game
     {
     public:
         // Type declarations.
-        typedef std::unique_ptr<ComponentPoolInterface>               ComponentPoolPtr;
-        typedef std::unordered_map<std::type_index, ComponentPoolPtr> ComponentPoolList;
-        typedef ComponentPoolList::value_type                         ComponentPoolPair;
+        typedef std::unique_ptr<ComponentPoolInterface> ComponentPoolPtr;
+        typedef std::vector<ComponentPoolPtr>           ComponentPoolList;
+
+        // Component mask entry structure.
+        struct ComponentMaskEntry
+        {
+            int version;
+            ComponentMask mask;
+        };
+
+        typedef std::vector<ComponentMaskEntry> ComponentMaskList;
+
+        // Component storage types.
+        struct ComponentStorage
+        {
+            enum Type
+            {
+                Pools,
+                Archetypes,
+            };
+        };
+
+        // Entity query structure.
+        struct EntityQuery
+        {
+            ComponentMask mask;
+            const ComponentPoolInterface::HandleList* handles;
+            std::size_t archetype;
+            std::size_t chunk;
+            std::size_t index;
+        };
 
     public:
         ComponentSystem();
@@ -56,7 +122,7 @@ namespace Game
         void Cleanup();
 
         // Initializes the component system.
-        bool Initialize(Context& context);
+        bool Initialize(Context& context, ComponentStorage::Type storage = ComponentStorage::Pools);
 
         // Creates a component.
         template<typename Type>
@@ -70,6 +136,22 @@ namespace Game
         template<typename Type>
         bool Remove(EntityHandle handle);
 
+        // Checks if an entity has a component.
+        template<typename Type>
+        bool Has(EntityHandle handle) const;
+
+        // Reserves memory for additional components of a type.
+        template<typename Type>
+        void Reserve(std::size_t count);
+
+        // Checks if any component of a type was created,
+        // changed or removed after a version.
+        template<typename Type>
+        bool IsChangedSince(ComponentVersion version) const;
+
+        // Gets the mask of component types owned by an entity.
+        ComponentMask GetComponentMask(EntityHandle handle) const;
+
         // Gets the begin iterator.
         template<typename Type>
         typename ComponentPool<Type>::ComponentIterator Begin();
@@ -78,29 +160,55 @@ namespace Game
         template<typename Type>
         typename ComponentPool<Type>::ComponentIterator End();
 
+        // Creates a view over multiple component types.
+        template<typename... Types>
+        ComponentView<Types...> View();
+
+        // Starts a query over entities that own all components in a mask.
+        EntityQuery BeginQuery(ComponentMask mask) const;
+
+        // Gets the next entity of a query.
+        bool NextQuery(EntityQuery& query, EntityHandle& entity) const;
+
         // Gets a component pool.
         template<typename Type>
         ComponentPool<Type>* GetPool();
 
+        // Gets the component storage type.
+        ComponentStorage::Type GetStorage() const;
+
     private:
         // Creates a component type.
         template<typename Type>
         ComponentPool<Type>* CreatePool();
 
+        // Sets or clears mask bits of an entity.
+        void SetComponentBits(EntityHandle handle, ComponentMask mask);
+        void ClearComponentBits(EntityHandle handle, ComponentMask mask);
+
     private:
-        // Called when an entity needs to be finalized.
-        bool OnEntityFinalize(EntityHandle handle);
+        // Called when entities need to be finalized.
+        void OnEntityFinalize(Span<const EntityHandle> handles, Span<uint8_t> results);
 
-        // Called when an entity gets destroyed.
-        void OnEntityDestroyed(EntityHandle handle);
+        // Called when entities get destroyed.
+        void OnEntityDestroyed(Span<const EntityHandle> handles);
 
     private:
+        // Component storage type.
+        ComponentStorage::Type m_storage;
+
         // Component pools.
         ComponentPoolList m_pools;
 
+        // Archetype storage.
+        ArchetypeStorage m_archetypes;
+
+        // Masks of entity components.
+        ComponentMaskList m_masks;
+
         // Event receivers.
-        Receiver<bool(EntityHandle)> m_entityFinalize;
-        Receiver<void(EntityHandle)> m_entityDestroyed;
+        Receiver<void(Span<const EntityHandle>, Span<uint8_t>)> m_entityFinalize;
+        Receiver<void(Span<const EntityHandle>)> m_entityDestroyed;
 
         // Context reference.
         Context* m_context;
@@ -119,12 +227,32 @@ namespace Game
         // Validate component type.
         static_assert(std::is_base_of<Component, Type>::value, "Not a component type.");
 
-        // Get the component pool.
-        ComponentPool<Type>* pool = this->GetPool<Type>();
-        Assert(pool != nullptr);
+        // Create the component.
+        Type* component = nullptr;
+
+        if(m_storage == ComponentStorage::Archetypes)
+        {
+            m_archetypes.RegisterType<Type>();
+            component = static_cast<Type*>(m_archetypes.Create(handle, GetComponentTypeId<Type>()));
+        }
+        else
+        {
+            ComponentPool<Type>* pool = this->GetPool<Type>();
+            Assert(pool != nullptr);
+
+            component = pool->Create(handle);
+        }
+
+        if(component != nullptr)
+        {
+            this->SetComponentBits(handle, GetComponentTypeMask<Type>());
 
-        // Create and return the component.
-        return pool->Create(handle);
+            // Track changes of the component type.
+            component->m_type = (uint32_t)GetComponentTypeId<Type>();
+            MarkComponentTypeChanged(GetComponentTypeId<Type>());
+        }
+
+        return component;
     }
 
     template<typename Type>
@@ -136,6 +264,12 @@ namespace Game
         // Validate component type.
         static_assert(std::is_base_of<Component, Type>::value, "Not a component type.");
 
+        // Lookup the component in archetypes.
+        if(m_storage == ComponentStorage::Archetypes)
+        {
+            return static_cast<Type*>(m_archetypes.Lookup(handle, GetComponentTypeId<Type>()));
+        }
+
         // Get the component pool.
         ComponentPool<Type>* pool = this->GetPool<Type>();
         Assert(pool != nullptr);
@@ -153,12 +287,58 @@ namespace Game
         // Validate component type.
         static_assert(std::is_base_of<Component, Type>::value, "Not a component type.");
 
+        // Remove a component.
+        if(m_storage == ComponentStorage::Archetypes)
+        {
+            if(!m_archetypes.Remove(handle, GetComponentTypeId<Type>()))
+                return false;
+        }
+        else
+        {
+            ComponentPool<Type>* pool = this->GetPool<Type>();
+            Assert(pool != nullptr);
+
+            if(!pool->Remove(handle))
+                return false;
+        }
+
+        this->ClearComponentBits(handle, GetComponentTypeMask<Type>());
+        MarkComponentTypeChanged(GetComponentTypeId<Type>());
+
+        return true;
+    }
+
+    template<typename Type>
+    bool ComponentSystem::IsChangedSince(ComponentVersion version) const
+    {
+        // Validate component type.
+        static_assert(std::is_base_of<Component, Type>::value, "Not a component type.");
+
+        return GetComponentTypeVersion(GetComponentTypeId<Type>()) > version;
+    }
+
+    template<typename Type>
+    bool ComponentSystem::Has(EntityHandle handle) const
+    {
+        return (this->GetComponentMask(handle) & GetComponentTypeMask<Type>()) != 0;
+    }
+
+    template<typename Type>
+    void ComponentSystem::Reserve(std::size_t count)
+    {
+        if(!m_initialized)
+            return;
+
+        // Archetype chunks are allocated as entities are moved into them.
+        if(m_storage != ComponentStorage::Pools)
+            return;
+
         // Get the component pool.
         ComponentPool<Type>* pool = this->GetPool<Type>();
         Assert(pool != nullptr);
 
-        // Remove a component.
-        return pool->Remove(handle);
+        // Reserve component memory.
+        pool->Reserve(count);
     }
 
     template<typename Type>
@@ -167,6 +347,9 @@ namespace Game
         if(!m_initialized)
             return ComponentPool<Type>::ComponentIterator();
 
+        // Archetypes do not keep components of a type together.
+        Assert(m_storage == ComponentStorage::Pools, "Use views to iterate over components in archetypes.");
+
         // Validate component type.
         static_assert(std::is_base_of<Component, Type>::value, "Not a component type.");
 
@@ -184,6 +367,9 @@ namespace Game
         if(!m_initialized)
             return ComponentPool<Type>::ComponentIterator();
 
+        // Archetypes do not keep components of a type together.
+        Assert(m_storage == ComponentStorage::Pools, "Use views to iterate over components in archetypes.");
+
         // Validate component type.
         static_assert(std::is_base_of<Component, Type>::value, "Not a component type.");
 
@@ -195,6 +381,20 @@ namespace Game
         return pool->End();
     }
 
+    template<typename... Types>
+    ComponentView<Types...> ComponentSystem::View()
+    {
+        if(!m_initialized)
+            return ComponentView<Types...>();
+
+        // Create a view over archetype chunks.
+        if(m_storage == ComponentStorage::Archetypes)
+            return ComponentView<Types...>(&m_archetypes);
+
+        // Create a view from component pools.
+        return ComponentView<Types...>(this->GetPool<Types>()...);
+    }
+
     template<typename Type>
     ComponentPool<Type>* ComponentSystem::CreatePool()
     {
@@ -203,15 +403,22 @@ namespace Game
         // Validate component type.
         static_assert(std::is_base_of<Component, Type>::value, "Not a component type.");
 
-        // Create and add pool to the collection.
-        auto pool = std::make_unique<ComponentPool<Type>>();
-        auto pair = ComponentPoolPair(typeid(Type), std::move(pool));
-        auto result = m_pools.insert(std::move(pair));
+        ComponentTypeId type = GetComponentTypeId<Type>();
+        Assert(type < MaximumComponentTypes);
 
-        Assert(result.second == true);
+        // Make sure the pool list can hold the type.
+        if(type >= m_pools.size())
+        {
+            m_pools.resize(type + 1);
+        }
+
+        Assert(m_pools[type] == nullptr);
+
+        // Create and add a pool to the list.
+        m_pools[type] = std::make_unique<ComponentPool<Type>>();
 
         // Return created pool.
-        return reinterpret_cast<ComponentPool<Type>*>(result.first->second.get());
+        return static_cast<ComponentPool<Type>*>(m_pools[type].get());
     }
 
     template<typename Type>
@@ -220,18 +427,22 @@ namespace Game
         if(!m_initialized)
             return nullptr;
 
+        // There are no pools when components are stored in archetypes.
+        if(m_storage != ComponentStorage::Pools)
+            return nullptr;
+
         // Validate component type.
         static_assert(std::is_base_of<Component, Type>::value, "Not a component type.");
 
         // Find pool by component type.
-        auto it = m_pools.find(typeid(Type));
+        ComponentTypeId type = GetComponentTypeId<Type>();
 
-        if(it == m_pools.end())
+        if(type >= m_pools.size() || m_pools[type] == nullptr)
         {
             return this->CreatePool<Type>();
         }
 
         // Cast and return the pointer that we already know is a component pool.
-        return reinterpret_cast<ComponentPool<Type>*>(it->second.get());
+        return static_cast<ComponentPool<Type>*>(m_pools[type].get());
     }
 }
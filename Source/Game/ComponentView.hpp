@@ -0,0 +1,431 @@
+#pragma once
+
+#include "Precompiled.hpp"
+#include "ComponentPool.hpp"
+#include "ArchetypeStorage.hpp"
+
+//
+// Component View
+//
+//  Iterates over entities that have all of the specified component types.
+//  With component pools, iteration is driven by the smallest of the pools,
+//  while the remaining components are found through sparse arrays of other
+//  pools. With archetype storage, iteration walks arrays of components in
+//  chunks of matching archetypes instead.
+//  See ComponentSystem for more context.
+//
+//  Views can be split into parts that are iterated independently, e.g. on
+//  different threads. Parts are entities of the driving pool or chunks of
+//  matching archetypes. Iterating a range of parts:
+//      for(auto it = view.Begin(first); it != view.Begin(last); ++it)
+//      {
+//          /* ... */
+//      }
+//
+
+namespace Game
+{
+    // Forward declarations.
+    template<typename... Types>
+    class ComponentView;
+
+    // Component view iterator class.
+    template<typename... Types>
+    class ComponentViewIterator
+    {
+    public:
+        // Type declarations.
+        typedef std::tuple<ComponentPool<Types>*...> PoolList;
+        typedef std::tuple<Types*...>                ComponentList;
+        typedef std::tuple<Types&...>                ValueType;
+        typedef ComponentPoolInterface::HandleList   HandleList;
+
+    public:
+        ComponentViewIterator() :
+            m_handles(nullptr),
+            m_index(0),
+            m_storage(nullptr),
+            m_mask(0),
+            m_archetype(0),
+            m_chunk(0),
+            m_chunkHandles(nullptr)
+        {
+        }
+
+        ComponentViewIterator(const PoolList& pools, const HandleList* handles, std::size_t index) :
+            m_pools(pools),
+            m_handles(handles),
+            m_index(index),
+            m_storage(nullptr),
+            m_mask(0),
+            m_archetype(0),
+            m_chunk(0),
+            m_chunkHandles(nullptr)
+        {
+            this->Advance();
+        }
+
+        ComponentViewIterator(ArchetypeStorage* storage, ComponentMask mask, std::size_t archetype, std::size_t chunk = 0) :
+            m_handles(nullptr),
+            m_index(0),
+            m_storage(storage),
+            m_mask(mask),
+            m_archetype(archetype),
+            m_chunk(chunk),
+            m_chunkHandles(nullptr)
+        {
+            this->AdvanceChunk();
+        }
+
+        // Gets the entity handle.
+        const EntityHandle& GetEntity() const
+        {
+            if(m_storage != nullptr)
+            {
+                Assert(m_chunkHandles != nullptr);
+                return m_chunkHandles[m_index];
+            }
+
+            Assert(m_handles != nullptr);
+            return (*m_handles)[m_index];
+        }
+
+        // Gets a component.
+        template<typename Type>
+        Type& Get() const
+        {
+            return *std::get<Type*>(m_components);
+        }
+
+        // Dereference operator.
+        ValueType operator*() const
+        {
+            return this->Dereference(std::index_sequence_for<Types...>());
+        }
+
+        // Increment operator.
+        ComponentViewIterator& operator++()
+        {
+            ++m_index;
+
+            if(m_storage != nullptr)
+            {
+                // Step through the chunk or move to the next one.
+                if(m_index < m_storage->GetArchetype(m_archetype).chunks[m_chunk].count)
+                {
+                    this->IncrementComponents(std::index_sequence_for<Types...>());
+                }
+                else
+                {
+                    m_index = 0;
+                    ++m_chunk;
+                    this->AdvanceChunk();
+                }
+            }
+            else
+            {
+                this->Advance();
+            }
+
+            return *this;
+        }
+
+        // Comparison operators.
+        bool operator==(const ComponentViewIterator& other) const
+        {
+            return m_handles == other.m_handles && m_index == other.m_index &&
+                m_storage == other.m_storage && m_archetype == other.m_archetype && m_chunk == other.m_chunk;
+        }
+
+        bool operator!=(const ComponentViewIterator& other) const
+        {
+            return !(*this == other);
+        }
+
+    private:
+        // Moves to the next entity that has all components.
+        void Advance()
+        {
+            if(m_handles == nullptr)
+                return;
+
+            while(m_index < m_handles->size())
+            {
+                if(this->LookupComponents((*m_handles)[m_index], std::index_sequence_for<Types...>()))
+                    break;
+
+                ++m_index;
+            }
+        }
+
+        // Lookups components of an entity.
+        template<std::size_t... Indices>
+        bool LookupComponents(const EntityHandle& handle, std::index_sequence<Indices...>)
+        {
+            const bool found[] = { (std::get<Indices>(m_components) = std::get<Indices>(m_pools)->Lookup(handle)) != nullptr... };
+
+            for(bool result : found)
+            {
+                if(!result)
+                    return false;
+            }
+
+            return true;
+        }
+
+        // Moves to the next chunk of an archetype that has all components.
+        void AdvanceChunk()
+        {
+            if(m_storage == nullptr)
+                return;
+
+            while(m_archetype < m_storage->GetArchetypeCount())
+            {
+                const ArchetypeStorage::Archetype& archetype = m_storage->GetArchetype(m_archetype);
+
+                if((archetype.mask & m_mask) == m_mask && m_chunk < archetype.chunks.size())
+                {
+                    m_chunkHandles = m_storage->GetHandles(archetype, m_chunk);
+                    this->LookupChunk(archetype, std::index_sequence_for<Types...>());
+                    return;
+                }
+
+                m_chunk = 0;
+                ++m_archetype;
+            }
+
+            m_chunkHandles = nullptr;
+        }
+
+        // Lookups component arrays of a chunk.
+        template<std::size_t... Indices>
+        void LookupChunk(const ArchetypeStorage::Archetype& archetype, std::index_sequence<Indices...>)
+        {
+            const int unused[] = { (std::get<Indices>(m_components) = static_cast<Types*>(m_storage->GetComponents(archetype, m_chunk, GetComponentTypeId<Types>())), 0)... };
+            (void)unused;
+        }
+
+        // Moves component pointers to the next row of a chunk.
+        template<std::size_t... Indices>
+        void IncrementComponents(std::index_sequence<Indices...>)
+        {
+            const int unused[] = { (++std::get<Indices>(m_components), 0)... };
+            (void)unused;
+        }
+
+        // Creates a tuple of component references.
+        template<std::size_t... Indices>
+        ValueType Dereference(std::index_sequence<Indices...>) const
+        {
+            return ValueType(*std::get<Indices>(m_components)...);
+        }
+
+    private:
+        // Viewed pools.
+        PoolList m_pools;
+
+        // Handles of the driving pool.
+        const HandleList* m_handles;
+        std::size_t m_index;
+
+        // Position in archetype storage.
+        ArchetypeStorage* m_storage;
+        ComponentMask m_mask;
+        std::size_t m_archetype;
+        std::size_t m_chunk;
+        const EntityHandle* m_chunkHandles;
+
+        // Components at the current position.
+        ComponentList m_components;
+    };
+
+    // Component view class.
+    template<typename... Types>
+    class ComponentView
+    {
+    public:
+        // Check template types.
+        static_assert(sizeof...(Types) >= 1, "View needs at least one component type.");
+
+        // Type declarations.
+        typedef ComponentViewIterator<Types...>     ViewIterator;
+        typedef typename ViewIterator::PoolList     PoolList;
+        typedef ComponentPoolInterface::HandleList  HandleList;
+
+    public:
+        ComponentView();
+        ComponentView(ComponentPool<Types>*... pools);
+        ComponentView(ArchetypeStorage* storage);
+
+        // Gets the begin iterator.
+        ViewIterator Begin() const;
+
+        // Gets the end iterator.
+        ViewIterator End() const;
+
+        // Gets the iterator at the beginning of a part.
+        ViewIterator Begin(std::size_t part) const;
+
+        // Gets the number of parts.
+        std::size_t GetPartCount() const;
+
+        // Gets the maximum number of entities that can be visited.
+        std::size_t GetMaximumCount() const;
+
+    private:
+        // Viewed pools.
+        PoolList m_pools;
+
+        // Handles of the smallest pool.
+        const HandleList* m_handles;
+
+        // Viewed archetype storage.
+        ArchetypeStorage* m_storage;
+        ComponentMask m_mask;
+    };
+
+    // Template definitions.
+    template<typename... Types>
+    ComponentView<Types...>::ComponentView() :
+        m_handles(nullptr),
+        m_storage(nullptr),
+        m_mask(0)
+    {
+    }
+
+    template<typename... Types>
+    ComponentView<Types...>::ComponentView(ComponentPool<Types>*... pools) :
+        m_pools(pools...),
+        m_handles(nullptr),
+        m_storage(nullptr),
+        m_mask(0)
+    {
+        // Drive the iteration from the smallest pool.
+        const ComponentPoolInterface* poolList[] = { pools... };
+
+        for(const ComponentPoolInterface* pool : poolList)
+        {
+            if(pool == nullptr)
+            {
+                m_handles = nullptr;
+                return;
+            }
+
+            if(m_handles == nullptr || pool->GetHandles().size() < m_handles->size())
+            {
+                m_handles = &pool->GetHandles();
+            }
+        }
+    }
+
+    template<typename... Types>
+    ComponentView<Types...>::ComponentView(ArchetypeStorage* storage) :
+        m_handles(nullptr),
+        m_storage(storage),
+        m_mask(0)
+    {
+        Assert(storage != nullptr);
+
+        // Combine masks of viewed component types.
+        const ComponentMask masks[] = { GetComponentTypeMask<Types>()... };
+
+        for(ComponentMask mask : masks)
+        {
+            m_mask |= mask;
+        }
+    }
+
+    template<typename... Types>
+    typename ComponentView<Types...>::ViewIterator ComponentView<Types...>::Begin() const
+    {
+        if(m_storage != nullptr)
+            return ViewIterator(m_storage, m_mask, 0);
+
+        return ViewIterator(m_pools, m_handles, 0);
+    }
+
+    template<typename... Types>
+    typename ComponentView<Types...>::ViewIterator ComponentView<Types...>::End() const
+    {
+        if(m_storage != nullptr)
+            return ViewIterator(m_storage, m_mask, m_storage->GetArchetypeCount());
+
+        return ViewIterator(m_pools, m_handles, this->GetMaximumCount());
+    }
+
+    template<typename... Types>
+    typename ComponentView<Types...>::ViewIterator ComponentView<Types...>::Begin(std::size_t part) const
+    {
+        if(m_storage != nullptr)
+        {
+            // Find the archetype chunk of the part.
+            for(std::size_t i = 0; i < m_storage->GetArchetypeCount(); ++i)
+            {
+                const ArchetypeStorage::Archetype& archetype = m_storage->GetArchetype(i);
+
+                if((archetype.mask & m_mask) != m_mask)
+                    continue;
+
+                if(part < archetype.chunks.size())
+                    return ViewIterator(m_storage, m_mask, i, part);
+
+                part -= archetype.chunks.size();
+            }
+
+            return this->End();
+        }
+
+        return ViewIterator(m_pools, m_handles, std::min(part, this->GetMaximumCount()));
+    }
+
+    template<typename... Types>
+    std::size_t ComponentView<Types...>::GetPartCount() const
+    {
+        // Count chunks of matching archetypes.
+        if(m_storage != nullptr)
+        {
+            std::size_t count = 0;
+
+            for(std::size_t i = 0; i < m_storage->GetArchetypeCount(); ++i)
+            {
+                const ArchetypeStorage::Archetype& archetype = m_storage->GetArchetype(i);
+
+                if((archetype.mask & m_mask) == m_mask)
+                {
+                    count += archetype.chunks.size();
+                }
+            }
+
+            return count;
+        }
+
+        return this->GetMaximumCount();
+    }
+
+    template<typename... Types>
+    std::size_t ComponentView<Types...>::GetMaximumCount() const
+    {
+        // Sum entities of matching archetypes.
+        if(m_storage != nullptr)
+        {
+            std::size_t count = 0;
+
+            for(std::size_t i = 0; i < m_storage->GetArchetypeCount(); ++i)
+            {
+                const ArchetypeStorage::Archetype& archetype = m_storage->GetArchetype(i);
+
+                if((archetype.mask & m_mask) == m_mask)
+                {
+                    count += archetype.entityCount;
+                }
+            }
+
+            return count;
+        }
+
+        if(m_handles == nullptr)
+            return 0;
+
+        return m_handles->size();
+    }
+}
@@ -0,0 +1,202 @@
+#include "Precompiled.hpp"
+#include "ParticleEmitter.hpp"
+#include "Transform.hpp"
+#include "Game/ComponentSystem.hpp"
+#include "Graphics/Texture.hpp"
+#include "Context.hpp"
+using namespace Game;
+using namespace Components;
+
+ParticleEmitter::ParticleEmitter() :
+    m_rectangle(0.0f, 0.0f, 1.0f, 1.0f),
+    m_spawnRate(10.0f),
+    m_maximumCount(1000),
+    m_lifetimeMin(1.0f),
+    m_lifetimeMax(1.0f),
+    m_velocityMin(0.0f, 0.0f),
+    m_velocityMax(0.0f, 0.0f),
+    m_acceleration(0.0f, 0.0f),
+    m_startColor(1.0f, 1.0f, 1.0f, 1.0f),
+    m_endColor(1.0f, 1.0f, 1.0f, 1.0f),
+    m_size(1.0f, 1.0f),
+    m_transparent(true),
+    m_emitting(true)
+{
+}
+
+ParticleEmitter::~ParticleEmitter()
+{
+}
+
+bool ParticleEmitter::Finalize(EntityHandle self, const Context& context)
+{
+    Assert(context.componentSystem != nullptr);
+
+    // Check required components.
+    if(context.componentSystem->Lookup<Transform>(self) == nullptr)
+        return false;
+
+    return true;
+}
+
+void ParticleEmitter::SetTexture(TexturePtr texture)
+{
+    if(texture == nullptr)
+        return;
+
+    m_texture = texture;
+    m_rectangle = glm::vec4(0.0f, 0.0f, texture->GetWidth(), texture->GetHeight());
+
+    this->MarkChanged();
+}
+
+void ParticleEmitter::SetTexture(TexturePtr texture, const glm::vec4& rectangle)
+{
+    m_texture = texture;
+    m_rectangle = rectangle;
+
+    this->MarkChanged();
+}
+
+void ParticleEmitter::SetRectangle(const glm::vec4& rectangle)
+{
+    m_rectangle = rectangle;
+
+    this->MarkChanged();
+}
+
+void ParticleEmitter::SetSpawnRate(float rate)
+{
+    m_spawnRate = std::max(rate, 0.0f);
+
+    this->MarkChanged();
+}
+
+void ParticleEmitter::SetMaximumCount(int count)
+{
+    m_maximumCount = std::max(count, 0);
+
+    this->MarkChanged();
+}
+
+void ParticleEmitter::SetLifetime(float minimum, float maximum)
+{
+    m_lifetimeMin = std::max(minimum, 0.0f);
+    m_lifetimeMax = std::max(maximum, m_lifetimeMin);
+
+    this->MarkChanged();
+}
+
+void ParticleEmitter::SetVelocity(const glm::vec2& minimum, const glm::vec2& maximum)
+{
+    m_velocityMin = minimum;
+    m_velocityMax = maximum;
+
+    this->MarkChanged();
+}
+
+void ParticleEmitter::SetAcceleration(const glm::vec2& acceleration)
+{
+    m_acceleration = acceleration;
+
+    this->MarkChanged();
+}
+
+void ParticleEmitter::SetColor(const glm::vec4& start, const glm::vec4& end)
+{
+    m_startColor = start;
+    m_endColor = end;
+
+    this->MarkChanged();
+}
+
+void ParticleEmitter::SetSize(const glm::vec2& size)
+{
+    m_size = size;
+
+    this->MarkChanged();
+}
+
+void ParticleEmitter::SetTransparent(bool transparent)
+{
+    m_transparent = transparent;
+
+    this->MarkChanged();
+}
+
+void ParticleEmitter::SetEmitting(bool emitting)
+{
+    m_emitting = emitting;
+
+    this->MarkChanged();
+}
+
+const ParticleEmitter::TexturePtr& ParticleEmitter::GetTexture() const
+{
+    return m_texture;
+}
+
+const glm::vec4& ParticleEmitter::GetRectangle() const
+{
+    return m_rectangle;
+}
+
+float ParticleEmitter::GetSpawnRate() const
+{
+    return m_spawnRate;
+}
+
+int ParticleEmitter::GetMaximumCount() const
+{
+    return m_maximumCount;
+}
+
+float ParticleEmitter::GetLifetimeMin() const
+{
+    return m_lifetimeMin;
+}
+
+float ParticleEmitter::GetLifetimeMax() const
+{
+    return m_lifetimeMax;
+}
+
+const glm::vec2& ParticleEmitter::GetVelocityMin() const
+{
+    return m_velocityMin;
+}
+
+const glm::vec2& ParticleEmitter::GetVelocityMax() const
+{
+    return m_velocityMax;
+}
+
+const glm::vec2& ParticleEmitter::GetAcceleration() const
+{
+    return m_acceleration;
+}
+
+const glm::vec4& ParticleEmitter::GetStartColor() const
+{
+    return m_startColor;
+}
+
+const glm::vec4& ParticleEmitter::GetEndColor() const
+{
+    return m_endColor;
+}
+
+const glm::vec2& ParticleEmitter::GetSize() const
+{
+    return m_size;
+}
+
+bool ParticleEmitter::IsTransparent() const
+{
+    return m_transparent;
+}
+
+bool ParticleEmitter::IsEmitting() const
+{
+    return m_emitting;
+}
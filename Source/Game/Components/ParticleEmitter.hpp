@@ -0,0 +1,148 @@
+#pragma once
+
+#include "Precompiled.hpp"
+#include "Game/Component.hpp"
+
+// Forward declarations.
+namespace Graphics
+{
+    class Texture;
+}
+
+//
+// Particle Emitter Component
+//
+//  Spawns particles at the entity position that are simulated and drawn
+//  by the particle system, without creating an entity for each particle.
+//
+//  Example usage:
+//      auto emitter = componentSystem.Create<Game::Components::ParticleEmitter>(entity);
+//      emitter->SetTexture(texture, rectangle);
+//      emitter->SetSpawnRate(200.0f);
+//      emitter->SetLifetime(0.5f, 1.5f);
+//      emitter->SetVelocity(glm::vec2(-1.0f, 2.0f), glm::vec2(1.0f, 4.0f));
+//      emitter->SetColor(glm::vec4(1.0f), glm::vec4(1.0f, 1.0f, 1.0f, 0.0f));
+//
+//  Particles are given a random lifetime and velocity between minimum and
+//  maximum values when spawned. Their color fades from the start to the end
+//  color over their lifetime. Particle size is in world units and is not
+//  scaled by the transform, as particles do not move with their emitter.
+//
+
+namespace Game
+{
+    namespace Components
+    {
+        // Particle emitter component class.
+        class ParticleEmitter : public Component
+        {
+        public:
+            // Type declarations.
+            typedef std::shared_ptr<const Graphics::Texture> TexturePtr;
+
+        public:
+            ParticleEmitter();
+            ParticleEmitter(ParticleEmitter&&) = default;
+            ParticleEmitter& operator=(ParticleEmitter&&) = default;
+            ~ParticleEmitter();
+
+            // Sets the texture.
+            void SetTexture(TexturePtr texture);
+            void SetTexture(TexturePtr texture, const glm::vec4& rectangle);
+
+            // Sets the rectangle.
+            void SetRectangle(const glm::vec4& rectangle);
+
+            // Sets the number of particles spawned per second.
+            void SetSpawnRate(float rate);
+
+            // Sets the maximum number of alive particles.
+            void SetMaximumCount(int count);
+
+            // Sets the range of particle lifetimes in seconds.
+            void SetLifetime(float minimum, float maximum);
+
+            // Sets the range of initial particle velocities.
+            void SetVelocity(const glm::vec2& minimum, const glm::vec2& maximum);
+
+            // Sets the acceleration of particles.
+            void SetAcceleration(const glm::vec2& acceleration);
+
+            // Sets the start and end colors.
+            void SetColor(const glm::vec4& start, const glm::vec4& end);
+
+            // Sets the particle size.
+            void SetSize(const glm::vec2& size);
+
+            // Sets transparency state.
+            void SetTransparent(bool transparent);
+
+            // Sets emitting state.
+            // Alive particles are still simulated when not emitting.
+            void SetEmitting(bool emitting);
+
+            // Gets the texture.
+            const TexturePtr& GetTexture() const;
+
+            // Gets the rectangle.
+            const glm::vec4& GetRectangle() const;
+
+            // Gets the spawn rate.
+            float GetSpawnRate() const;
+
+            // Gets the maximum count.
+            int GetMaximumCount() const;
+
+            // Gets the minimum and maximum lifetime.
+            float GetLifetimeMin() const;
+            float GetLifetimeMax() const;
+
+            // Gets the minimum and maximum velocity.
+            const glm::vec2& GetVelocityMin() const;
+            const glm::vec2& GetVelocityMax() const;
+
+            // Gets the acceleration.
+            const glm::vec2& GetAcceleration() const;
+
+            // Gets the start and end colors.
+            const glm::vec4& GetStartColor() const;
+            const glm::vec4& GetEndColor() const;
+
+            // Gets the particle size.
+            const glm::vec2& GetSize() const;
+
+            // Checks if is transparent.
+            bool IsTransparent() const;
+
+            // Checks if is emitting.
+            bool IsEmitting() const;
+
+        protected:
+            // Finalizes the particle emitter component.
+            bool Finalize(EntityHandle self, const Context& context) override;
+
+        private:
+            // Texture resource.
+            TexturePtr m_texture;
+            glm::vec4 m_rectangle;
+
+            // Spawn parameters.
+            float m_spawnRate;
+            int m_maximumCount;
+            float m_lifetimeMin;
+            float m_lifetimeMax;
+            glm::vec2 m_velocityMin;
+            glm::vec2 m_velocityMax;
+            glm::vec2 m_acceleration;
+
+            // Render parameters.
+            glm::vec4 m_startColor;
+            glm::vec4 m_endColor;
+            glm::vec2 m_size;
+            bool m_transparent;
+
+            // Emitting state.
+            bool m_emitting;
+        };
+    }
+}
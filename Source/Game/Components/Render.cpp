@@ -10,11 +10,11 @@ using namespace Components;
 Render::Render() :
     m_offset(0.0f, 0.0f),
     m_rectangle(0.0f, 0.0f, 1.0f, 1.0f),
+    m_wholeTexture(false),
     m_diffuseColor(1.0f, 1.0f, 1.0f, 1.0f),
     m_emissiveColor(1.0f, 1.0f, 1.0f, 1.0f),
     m_emissivePower(0.0f),
-    m_transparent(true),
-    m_transform(nullptr)
+    m_transparent(true)
 {
 }
 
@@ -26,9 +26,9 @@ bool Render::Finalize(EntityHandle self, const Context& context)
 {
     Assert(context.componentSystem != nullptr);
 
-    // Get required components.
-    m_transform = context.componentSystem->Lookup<Transform>(self);
-    if(m_transform == nullptr) return false;
+    // Check required components.
+    if(context.componentSystem->Lookup<Transform>(self) == nullptr)
+        return false;
 
     return true;
 }
@@ -36,6 +36,8 @@ bool Render::Finalize(EntityHandle self, const Context& context)
 void Render::SetOffset(const glm::vec2& offset)
 {
     m_offset = offset;
+
+    this->MarkChanged();
 }
 
 glm::vec4 Render::CalculateColor() const
@@ -50,37 +52,54 @@ void Render::SetTexture(TexturePtr texture)
 
     m_texture = texture;
     m_rectangle = glm::vec4(0.0f, 0.0f, texture->GetWidth(), texture->GetHeight());
+    m_wholeTexture = true;
+
+    this->MarkChanged();
 }
 
 void Render::SetTexture(TexturePtr texture, const glm::vec4& rectangle)
 {
     m_texture = texture;
     m_rectangle = rectangle;
+    m_wholeTexture = false;
+
+    this->MarkChanged();
 }
 
 void Render::SetRectangle(const glm::vec4& rectangle)
 {
     m_rectangle = rectangle;
+    m_wholeTexture = false;
+
+    this->MarkChanged();
 }
 
 void Render::SetDiffuseColor(const glm::vec4& color)
 {
     m_diffuseColor = color;
+
+    this->MarkChanged();
 }
 
 void Render::SetEmissiveColor(const glm::vec4& color)
 {
     m_emissiveColor = color;
+
+    this->MarkChanged();
 }
 
 void Render::SetEmissivePower(float power)
 {
     m_emissivePower = power;
+
+    this->MarkChanged();
 }
 
 void Render::SetTransparent(bool transparent)
 {
     m_transparent = transparent;
+
+    this->MarkChanged();
 }
 
 const glm::vec2& Render::GetOffset() const
@@ -93,11 +112,22 @@ const Render::TexturePtr& Render::GetTexture() const
     return m_texture;
 }
 
-const glm::vec4& Render::GetRectangle() const
+glm::vec4 Render::GetRectangle() const
 {
+    // Take the size of a texture that was still pending when it was set.
+    if(m_wholeTexture)
+    {
+        return glm::vec4(0.0f, 0.0f, m_texture->GetWidth(), m_texture->GetHeight());
+    }
+
     return m_rectangle;
 }
 
+bool Render::IsWholeTexture() const
+{
+    return m_wholeTexture;
+}
+
 const glm::vec4& Render::GetDiffuseColor() const
 {
     return m_diffuseColor;
@@ -117,8 +147,3 @@ bool Render::IsTransparent() const
 {
     return m_transparent;
 }
-
-Transform* Render::GetTransform()
-{
-    return m_transform;
-}
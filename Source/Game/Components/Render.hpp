@@ -17,9 +17,6 @@ namespace Game
 {
     namespace Components
     {
-        // Forward declarations.
-        class Transform;
-
         // Render component class.
         class Render : public Component
         {
@@ -29,6 +26,8 @@ namespace Game
 
         public:
             Render();
+            Render(Render&&) = default;
+            Render& operator=(Render&&) = default;
             ~Render();
 
             // Calculates the final color.
@@ -38,6 +37,7 @@ namespace Game
             void SetOffset(const glm::vec2& offset);
 
             // Sets the texture.
+            // Without a rectangle, the whole texture is drawn even if it is uploaded later.
             void SetTexture(TexturePtr texture);
             void SetTexture(TexturePtr texture, const glm::vec4& rectangle);
 
@@ -63,7 +63,10 @@ namespace Game
             const TexturePtr& GetTexture() const;
 
             // Gets the rectangle.
-            const glm::vec4& GetRectangle() const;
+            glm::vec4 GetRectangle() const;
+
+            // Checks if the whole texture is drawn.
+            bool IsWholeTexture() const;
 
             // Gets the diffuse color.
             const glm::vec4& GetDiffuseColor() const;
@@ -77,9 +80,6 @@ namespace Game
             // Checks if is transparent.
             bool IsTransparent() const;
 
-            // Gets the transform component.
-            Transform* GetTransform();
-
         protected:
             // Finalizes the render component.
             bool Finalize(EntityHandle self, const Context& context) override;
@@ -88,6 +88,7 @@ namespace Game
             // Texture resource.
             TexturePtr m_texture;
             glm::vec4 m_rectangle;
+            bool m_wholeTexture;
 
             // Render parameters.
             glm::vec2 m_offset;
@@ -95,9 +96,6 @@ namespace Game
             glm::vec4 m_emissiveColor;
             float m_emissivePower;
             bool m_transparent;
-
-            // Entity components.
-            Transform* m_transform;
         };
     }
 }
@@ -18,6 +18,8 @@ namespace Game
         {
         public:
             Script();
+            Script(Script&&) = default;
+            Script& operator=(Script&&) = default;
             ~Script();
 
             // Adds a script instance.
@@ -0,0 +1,197 @@
+#include "Precompiled.hpp"
+#include "TileMap.hpp"
+#include "Transform.hpp"
+#include "Game/ComponentSystem.hpp"
+#include "Graphics/SpriteSheet.hpp"
+#include "Context.hpp"
+using namespace Game;
+using namespace Components;
+
+const int TileMap::ChunkSize;
+
+TileMap::TileMap() :
+    m_width(0),
+    m_height(0),
+    m_tileSize(1.0f, 1.0f),
+    m_color(1.0f, 1.0f, 1.0f, 1.0f),
+    m_transparent(true),
+    m_drawOrder(0)
+{
+}
+
+TileMap::~TileMap()
+{
+}
+
+bool TileMap::Finalize(EntityHandle self, const Context& context)
+{
+    Assert(context.componentSystem != nullptr);
+
+    // Check required components.
+    if(context.componentSystem->Lookup<Transform>(self) == nullptr)
+        return false;
+
+    return true;
+}
+
+void TileMap::SetSpriteSheet(SpriteSheetPtr spriteSheet)
+{
+    m_spriteSheet = spriteSheet;
+
+    this->MarkChanged();
+}
+
+void TileMap::Resize(int width, int height)
+{
+    m_width = std::max(width, 0);
+    m_height = std::max(height, 0);
+
+    // Clear all tiles.
+    m_tiles.assign(m_width * m_height, glm::i16vec4(0));
+
+    // Create chunks that are changed since now.
+    m_chunkVersions.assign(this->GetChunkCountX() * this->GetChunkCountY(), GetComponentVersion());
+
+    this->MarkChanged();
+}
+
+bool TileMap::SetTile(int x, int y, std::string sprite)
+{
+    if(m_spriteSheet == nullptr)
+        return false;
+
+    // Find the sprite rectangle.
+    const glm::vec4& rectangle = m_spriteSheet->GetSprite(sprite);
+
+    if(rectangle.z == 0.0f || rectangle.w == 0.0f)
+        return false;
+
+    return this->SetTile(x, y, rectangle);
+}
+
+bool TileMap::SetTile(int x, int y, const glm::vec4& rectangle)
+{
+    if(x < 0 || x >= m_width || y < 0 || y >= m_height)
+        return false;
+
+    // Change the tile only if it differs.
+    glm::i16vec4& tile = m_tiles[y * m_width + x];
+    glm::i16vec4 value(glm::round(rectangle));
+
+    if(tile != value)
+    {
+        tile = value;
+
+        this->MarkTileChanged(x, y);
+    }
+
+    return true;
+}
+
+bool TileMap::ClearTile(int x, int y)
+{
+    return this->SetTile(x, y, glm::vec4(0.0f));
+}
+
+void TileMap::SetTileSize(const glm::vec2& size)
+{
+    m_tileSize = size;
+
+    this->MarkChunksChanged();
+}
+
+void TileMap::SetColor(const glm::vec4& color)
+{
+    m_color = color;
+
+    this->MarkChunksChanged();
+}
+
+void TileMap::SetTransparent(bool transparent)
+{
+    m_transparent = transparent;
+
+    this->MarkChanged();
+}
+
+void TileMap::SetDrawOrder(int order)
+{
+    m_drawOrder = order;
+
+    this->MarkChanged();
+}
+
+void TileMap::MarkTileChanged(int x, int y)
+{
+    m_chunkVersions[(y / ChunkSize) * this->GetChunkCountX() + x / ChunkSize] = GetComponentVersion();
+
+    this->MarkChanged();
+}
+
+void TileMap::MarkChunksChanged()
+{
+    std::fill(m_chunkVersions.begin(), m_chunkVersions.end(), GetComponentVersion());
+
+    this->MarkChanged();
+}
+
+const TileMap::SpriteSheetPtr& TileMap::GetSpriteSheet() const
+{
+    return m_spriteSheet;
+}
+
+int TileMap::GetWidth() const
+{
+    return m_width;
+}
+
+int TileMap::GetHeight() const
+{
+    return m_height;
+}
+
+glm::i16vec4 TileMap::GetTile(int x, int y) const
+{
+    if(x < 0 || x >= m_width || y < 0 || y >= m_height)
+        return glm::i16vec4(0);
+
+    return m_tiles[y * m_width + x];
+}
+
+const glm::vec2& TileMap::GetTileSize() const
+{
+    return m_tileSize;
+}
+
+const glm::vec4& TileMap::GetColor() const
+{
+    return m_color;
+}
+
+bool TileMap::IsTransparent() const
+{
+    return m_transparent;
+}
+
+int TileMap::GetDrawOrder() const
+{
+    return m_drawOrder;
+}
+
+int TileMap::GetChunkCountX() const
+{
+    return (m_width + ChunkSize - 1) / ChunkSize;
+}
+
+int TileMap::GetChunkCountY() const
+{
+    return (m_height + ChunkSize - 1) / ChunkSize;
+}
+
+bool TileMap::IsChunkChangedSince(int chunkX, int chunkY, ComponentVersion version) const
+{
+    Assert(chunkX >= 0 && chunkX < this->GetChunkCountX());
+    Assert(chunkY >= 0 && chunkY < this->GetChunkCountY());
+
+    return m_chunkVersions[chunkY * this->GetChunkCountX() + chunkX] > version;
+}
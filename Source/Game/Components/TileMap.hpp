@@ -0,0 +1,143 @@
+#pragma once
+
+#include "Precompiled.hpp"
+#include "Game/Component.hpp"
+
+// Forward declarations.
+namespace Graphics
+{
+    class SpriteSheet;
+}
+
+//
+// Tile Map Component
+//
+//  Grid of tiles drawn with sprites of a single sprite sheet.
+//  Tiles are placed from the entity position towards positive axes,
+//  with the first tile in the bottom left corner of the map.
+//
+//  Example usage:
+//      auto tileMap = componentSystem.Create<Game::Components::TileMap>(entity);
+//      tileMap->SetSpriteSheet(spriteSheet);
+//      tileMap->Resize(64, 64);
+//      tileMap->SetTile(0, 0, "grass");
+//
+//  Tiles are grouped in square chunks that remember the version of their
+//  last change, so renderers can rebuild only chunks with changed tiles.
+//  Tile size is in world units and is scaled by the transform scale,
+//  while the transform rotation is not applied, the same as for sprites.
+//
+
+namespace Game
+{
+    namespace Components
+    {
+        // Tile map component class.
+        class TileMap : public Component
+        {
+        public:
+            // Type declarations.
+            typedef std::shared_ptr<const Graphics::SpriteSheet> SpriteSheetPtr;
+            typedef std::vector<glm::i16vec4> TileList;
+            typedef std::vector<ComponentVersion> ChunkVersionList;
+
+            // Constant variables.
+            static const int ChunkSize = 32;
+
+        public:
+            TileMap();
+            TileMap(TileMap&&) = default;
+            TileMap& operator=(TileMap&&) = default;
+            ~TileMap();
+
+            // Sets the sprite sheet.
+            void SetSpriteSheet(SpriteSheetPtr spriteSheet);
+
+            // Resizes the map and clears all tiles.
+            void Resize(int width, int height);
+
+            // Sets a tile to a sprite from the sprite sheet.
+            bool SetTile(int x, int y, std::string sprite);
+
+            // Sets a tile to a rectangle of the sprite sheet texture.
+            bool SetTile(int x, int y, const glm::vec4& rectangle);
+
+            // Clears a tile.
+            bool ClearTile(int x, int y);
+
+            // Sets the tile size.
+            void SetTileSize(const glm::vec2& size);
+
+            // Sets the color.
+            void SetColor(const glm::vec4& color);
+
+            // Sets transparency state.
+            void SetTransparent(bool transparent);
+
+            // Sets the draw order.
+            // Tile maps with lower orders are drawn first.
+            void SetDrawOrder(int order);
+
+            // Gets the sprite sheet.
+            const SpriteSheetPtr& GetSpriteSheet() const;
+
+            // Gets the map width in tiles.
+            int GetWidth() const;
+
+            // Gets the map height in tiles.
+            int GetHeight() const;
+
+            // Gets the rectangle of a tile.
+            // Returns an empty rectangle for cleared tiles.
+            glm::i16vec4 GetTile(int x, int y) const;
+
+            // Gets the tile size.
+            const glm::vec2& GetTileSize() const;
+
+            // Gets the color.
+            const glm::vec4& GetColor() const;
+
+            // Checks if is transparent.
+            bool IsTransparent() const;
+
+            // Gets the draw order.
+            int GetDrawOrder() const;
+
+            // Gets the number of chunks along each axis.
+            int GetChunkCountX() const;
+            int GetChunkCountY() const;
+
+            // Checks if a chunk changed after a version.
+            bool IsChunkChangedSince(int chunkX, int chunkY, ComponentVersion version) const;
+
+        protected:
+            // Finalizes the tile map component.
+            bool Finalize(EntityHandle self, const Context& context) override;
+
+        private:
+            // Marks a chunk containing a tile as changed.
+            void MarkTileChanged(int x, int y);
+
+            // Marks all chunks as changed.
+            void MarkChunksChanged();
+
+        private:
+            // Sprite sheet resource.
+            SpriteSheetPtr m_spriteSheet;
+
+            // Tile rectangles in rows from the bottom.
+            TileList m_tiles;
+            int m_width;
+            int m_height;
+
+            // Versions of chunk changes.
+            ChunkVersionList m_chunkVersions;
+
+            // Render parameters.
+            glm::vec2 m_tileSize;
+            glm::vec4 m_color;
+            bool m_transparent;
+            int m_drawOrder;
+        };
+    }
+}
@@ -16,6 +16,8 @@ namespace Game
         {
         public:
             Transform();
+            Transform(Transform&&) = default;
+            Transform& operator=(Transform&&) = default;
             ~Transform();
 
             // Calculates the transform matrix.
@@ -28,18 +30,21 @@ namespace Game
             void SetPosition(const glm::vec2& position)
             {
                 m_position = position;
+                this->MarkChanged();
             }
 
             // Sets the scale.
             void SetScale(const glm::vec2& scale)
             {
                 m_scale = scale;
+                this->MarkChanged();
             }
 
             // Sets the rotation.
             void SetRotation(float rotation)
             {
                 m_rotation = glm::mod(rotation, 360.0f);
+                this->MarkChanged();
             }
 
             // Gets the position.
@@ -0,0 +1,64 @@
+#include "Precompiled.hpp"
+#include "EntityCommandBuffer.hpp"
+using namespace Game;
+
+EntityCommandBuffer::EntityCommandBuffer(EntitySystem& entitySystem, uint32_t sortKey) :
+    m_entitySystem(&entitySystem)
+{
+    m_batch.sortKey = sortKey;
+}
+
+EntityCommandBuffer::~EntityCommandBuffer()
+{
+    this->Submit();
+}
+
+EntityHandle EntityCommandBuffer::CreateEntity(SetupFunction setup)
+{
+    // Reserve an entity handle.
+    EntityHandle handle = m_entitySystem->ReserveHandle();
+
+    if(handle.identifier == 0)
+        return handle;
+
+    // Record a create entity command.
+    EntitySystem::EntityCommand command;
+    command.type = EntitySystem::EntityCommands::Create;
+    command.handle = handle;
+
+    m_batch.commands.push_back(command);
+    m_batch.setups.push_back(std::move(setup));
+
+    return handle;
+}
+
+void EntityCommandBuffer::DestroyEntity(const EntityHandle& entity)
+{
+    // Record a destroy entity command.
+    EntitySystem::EntityCommand command;
+    command.type = EntitySystem::EntityCommands::Destroy;
+    command.handle = entity;
+
+    m_batch.commands.push_back(command);
+    m_batch.setups.push_back(nullptr);
+}
+
+void EntityCommandBuffer::Submit()
+{
+    if(m_batch.commands.empty())
+        return;
+
+    // Hand over recorded commands.
+    uint32_t sortKey = m_batch.sortKey;
+
+    m_entitySystem->SubmitCommands(std::move(m_batch));
+
+    // Reset the batch for further recording.
+    m_batch = EntitySystem::CommandBatch();
+    m_batch.sortKey = sortKey;
+}
+
+bool EntityCommandBuffer::IsEmpty() const
+{
+    return m_batch.commands.empty();
+}
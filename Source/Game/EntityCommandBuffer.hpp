@@ -0,0 +1,73 @@
+#pragma once
+
+#include "Precompiled.hpp"
+#include "EntitySystem.hpp"
+
+//
+// Entity Command Buffer
+//
+//  Records entity commands on any thread. Recorded commands are merged into
+//  the entity system at the beginning of the next ProcessCommands() call.
+//  Each thread or job should record into its own buffer instance.
+//
+//  Handles of created entities are reserved without locking and can be used
+//  right away, but entities remain inactive until their buffer is merged.
+//  Setup functions are called during the merge on the thread that processes
+//  commands, before entities are finalized, and can add components.
+//
+//  Submitted buffers are merged in the order of their sort keys, so the
+//  order of commands does not depend on the order in which threads finish.
+//  Give each buffer an unique key (e.g. index of the processed chunk).
+//  Buffers must not be used while ProcessCommands() is running.
+//
+//  Example usage:
+//      jobSystem.ParallelFor(count, 64, [&](std::size_t begin, std::size_t end)
+//      {
+//          Game::EntityCommandBuffer commands(entitySystem, begin);
+//
+//          for(std::size_t i = begin; i < end; ++i)
+//          {
+//              commands.CreateEntity([&](EntityHandle entity)
+//              {
+//                  /* Add components here! */
+//              });
+//          }
+//      });
+//
+//      entitySystem.ProcessCommands();
+//
+
+namespace Game
+{
+    // Entity command buffer class.
+    class EntityCommandBuffer : private NonCopyable
+    {
+    public:
+        // Type declarations.
+        typedef EntitySystem::SetupFunction SetupFunction;
+
+    public:
+        EntityCommandBuffer(EntitySystem& entitySystem, uint32_t sortKey = 0);
+        ~EntityCommandBuffer();
+
+        // Records entity creation.
+        EntityHandle CreateEntity(SetupFunction setup = nullptr);
+
+        // Records entity destruction.
+        void DestroyEntity(const EntityHandle& entity);
+
+        // Submits recorded commands.
+        // Called automatically when the buffer is destroyed.
+        void Submit();
+
+        // Checks if there are any recorded commands.
+        bool IsEmpty() const;
+
+    private:
+        // Entity system reference.
+        EntitySystem* m_entitySystem;
+
+        // Recorded commands.
+        EntitySystem::CommandBatch m_batch;
+    };
+}
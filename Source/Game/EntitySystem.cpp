@@ -13,10 +13,16 @@ namespace
     const int InvalidIdentifier   = 0;
     const int InvalidNextFree     = -1;
     const int InvalidQueueElement = -1;
+    const int FirstIdentifier     = 1;
+
+    // Number of handles reserved for other threads.
+    const std::size_t ReservedHandleCount = 256;
 }
 
 EntitySystem::EntitySystem() :
     events(m_dispatchers),
+    m_nextIdentifier(FirstIdentifier),
+    m_reservedCursor(0),
     m_entityCount(0),
     m_freeListDequeue(InvalidQueueElement),
     m_freeListEnqueue(InvalidQueueElement),
@@ -51,11 +57,25 @@ void EntitySystem::Cleanup()
     m_dispatchers.entityCreated.Cleanup();
     m_dispatchers.entityDestroyed.Cleanup();
 
-    // Clear the command list.
+    // Clear the command lists.
     Utility::ClearContainer(m_commands);
+    Utility::ClearContainer(m_processedCommands);
+
+    // Clear the batch lists.
+    Utility::ClearContainer(m_batchEntities);
+    Utility::ClearContainer(m_batchResults);
 
     // Clear the handle list.
     Utility::ClearContainer(m_handles);
+    m_nextIdentifier = FirstIdentifier;
+
+    // Clear reserved handles.
+    Utility::ClearContainer(m_reservedHandles);
+    m_reservedCursor = 0;
+
+    // Clear command batches.
+    Utility::ClearContainer(m_submittedBatches);
+    Utility::ClearContainer(m_mergedBatches);
 
     // Reset the entity counter.
     m_entityCount = 0;
@@ -98,69 +118,68 @@ EntityHandle EntitySystem::CreateEntity()
     if(!m_initialized)
         return EntityHandle();
 
-    // Check if we reached the numerical limits.
-    Assert(m_handles.size() != MaximumIdentifier);
-
-    // Create a new handle if the free list queue is empty.
-    if(m_freeListIsEmpty)
-    {
-        // Create an entity handle.
-        EntityHandle handle;
-        handle.identifier = m_handles.size() + 1;
-        handle.version = 0;
+    // Allocate an entity handle.
+    HandleEntry& handleEntry = this->AllocateHandle();
 
-        // Create a handle entry.
-        HandleEntry entry;
-        entry.handle = handle;
-        entry.nextFree = InvalidNextFree;
-        entry.flags = HandleFlags::Free;
+    // Add a create entity command.
+    EntityCommand command;
+    command.type = EntityCommands::Create;
+    command.handle = handleEntry.handle;
 
-        m_handles.push_back(entry);
+    m_commands.push_back(command);
 
-        // Add new handle entry to the free list queue.
-        int handleIndex = m_handles.size() - 1;
+    // Return the handle, which is still inactive
+    // until the next ProcessCommands() call.
+    return handleEntry.handle;
+}
 
-        m_freeListDequeue = handleIndex;
-        m_freeListEnqueue = handleIndex;
-        m_freeListIsEmpty = false;
-    }
+void EntitySystem::CreateEntities(std::size_t count, std::vector<EntityHandle>& entities)
+{
+    if(!m_initialized)
+        return;
 
-    // Retrieve an unused handle from the free list.
-    int handleIndex = m_freeListDequeue;
-    HandleEntry& handleEntry = m_handles[handleIndex];
+    if(count == 0)
+        return;
 
-    // Clear next free handle index.
-    handleEntry.nextFree = InvalidNextFree;
+    // Check if we reached the numerical limits.
+    Assert((std::size_t)m_nextIdentifier + count <= (std::size_t)MaximumIdentifier);
 
-    // Update the free list queue.
-    if(m_freeListDequeue == m_freeListEnqueue)
-    {
-        // If there was only one element in the queue,
-        // set the free list queue state to empty.
-        m_freeListDequeue = InvalidQueueElement;
-        m_freeListEnqueue = InvalidQueueElement;
-        m_freeListIsEmpty = true;
-    }
-    else
+    // Reuse handles from the free list first.
+    while(count > 0 && !m_freeListIsEmpty)
     {
-        // If there were more than a single element in the queue,
-        // set the beginning of the queue to the next free element.
-        m_freeListDequeue = handleEntry.nextFree;
+        HandleEntry& handleEntry = this->AllocateHandle();
+
+        EntityCommand command;
+        command.type = EntityCommands::Create;
+        command.handle = handleEntry.handle;
+
+        m_commands.push_back(command);
+        entities.push_back(handleEntry.handle);
+
+        count -= 1;
     }
 
-    // Mark handle as valid.
-    handleEntry.flags |= HandleFlags::Valid;
+    if(count == 0)
+        return;
 
-    // Add a create entity command.
-    EntityCommand command;
-    command.type = EntityCommands::Create;
-    command.handle = handleEntry.handle;
+    // Create the remaining handles as a single range.
+    int firstIdentifier = m_nextIdentifier.fetch_add((int)count);
+    int lastIdentifier = firstIdentifier + (int)count - 1;
 
-    m_commands.push(command);
+    this->CreateHandleEntries(lastIdentifier);
 
-    // Return the handle, which is still inactive
-    // until the next ProcessCommands() call.
-    return handleEntry.handle;
+    for(int identifier = firstIdentifier; identifier <= lastIdentifier; ++identifier)
+    {
+        HandleEntry& handleEntry = m_handles[identifier - 1];
+        handleEntry.flags = HandleFlags::Valid;
+
+        EntityCommand command;
+        command.type = EntityCommands::Create;
+        command.handle = handleEntry.handle;
+
+        m_commands.push_back(command);
+        entities.push_back(handleEntry.handle);
+    }
 }
 
 void EntitySystem::DestroyEntity(const EntityHandle& entity)
@@ -184,7 +203,19 @@ void EntitySystem::DestroyEntity(const EntityHandle& entity)
     command.type = EntityCommands::Destroy;
     command.handle = handleEntry.handle;
 
-    m_commands.push(command);
+    m_commands.push_back(command);
+}
+
+void EntitySystem::DestroyEntities(EntitySpan entities)
+{
+    if(!m_initialized)
+        return;
+
+    // Destroy each entity.
+    for(const EntityHandle& entity : entities)
+    {
+        this->DestroyEntity(entity);
+    }
 }
 
 void EntitySystem::DestroyAllEntities()
@@ -195,20 +226,41 @@ void EntitySystem::DestroyAllEntities()
     // Process entity commands.
     ProcessCommands();
 
+    // Create entries of identifiers reserved by other threads.
+    this->CreateHandleEntries(m_nextIdentifier - 1);
+
+    // Forget handles reserved for other threads.
+    m_reservedHandles.clear();
+    m_reservedCursor = 0;
+
     // Check if there are any entities to destroy.
     if(m_handles.empty())
         return;
 
-    // Inform about entities soon to be destroyed.
+    // Collect entities soon to be destroyed.
+    m_batchEntities.clear();
+
     for(auto it = m_handles.begin(); it != m_handles.end(); ++it)
     {
         HandleEntry& handleEntry = *it;
 
         if(handleEntry.flags & HandleFlags::Valid)
         {
-            // Send event about soon to be destroyed entity.
-            m_dispatchers.entityDestroyed(handleEntry.handle);
+            m_batchEntities.push_back(handleEntry.handle);
+        }
+    }
 
+    // Send event about soon to be destroyed entities.
+    m_dispatchers.entityDestroyed(EntitySpan(m_batchEntities));
+
+    // Free all handles, including reserved ones. Commands of buffers that
+    // still hold reserved handles will no longer match handle versions.
+    for(auto it = m_handles.begin(); it != m_handles.end(); ++it)
+    {
+        HandleEntry& handleEntry = *it;
+
+        if(handleEntry.flags & (HandleFlags::Valid | HandleFlags::Reserved))
+        {
             // Set the handle free flags.
             handleEntry.flags = HandleFlags::Free;
 
@@ -217,6 +269,9 @@ void EntitySystem::DestroyAllEntities()
         }
     }
 
+    // Reset the counter of active entities.
+    m_entityCount = 0;
+
     // Chain handles to form a free list.
     for(unsigned int i = 0; i < m_handles.size(); ++i)
     {
@@ -239,75 +294,359 @@ void EntitySystem::ProcessCommands()
     if(!m_initialized)
         return;
 
-    // Process entity commands.
+    // Merge commands recorded by other threads.
+    this->MergeCommandBatches();
+
+    // Process entity commands. Processing can issue
+    // new commands, which will be handled in the next pass.
     while(!m_commands.empty())
     {
-        // Get the command from the queue.
-        EntityCommand& command = m_commands.front();
+        // Take the list of commands.
+        m_processedCommands.swap(m_commands);
+        m_commands.clear();
 
-        // Process entity command.
-        switch(command.type)
+        // Process commands in batches of the same type.
+        std::size_t batchBegin = 0;
+
+        while(batchBegin < m_processedCommands.size())
         {
-        case EntityCommands::Create:
-            {
-                // Locate the handle entry.
-                int handleIndex = command.handle.identifier - 1;
-                HandleEntry& handleEntry = m_handles[handleIndex];
+            EntityCommands::Type batchType = m_processedCommands[batchBegin].type;
 
-                // Make sure handles match.
-                Assert(command.handle == handleEntry.handle);
+            // Collect entity handles of the batch.
+            m_batchEntities.clear();
 
-                // Inform that we want this entity finalized.
-                if(!m_dispatchers.entityFinalize(handleEntry.handle))
-                {
-                    // Destroy the entity.
-                    this->DestroyEntity(handleEntry.handle);
-                    break;
-                }
+            std::size_t batchEnd = batchBegin;
 
-                // Mark handle as active.
-                Assert(!(handleEntry.flags & HandleFlags::Active));
+            while(batchEnd < m_processedCommands.size() && m_processedCommands[batchEnd].type == batchType)
+            {
+                m_batchEntities.push_back(m_processedCommands[batchEnd].handle);
+                batchEnd += 1;
+            }
 
-                handleEntry.flags |= HandleFlags::Active;
+            // Process entity commands.
+            switch(batchType)
+            {
+            case EntityCommands::Create:
+                this->ProcessCreateCommands(EntitySpan(m_batchEntities));
+                break;
 
-                // Increment the counter of active entities.
-                m_entityCount += 1;
+            case EntityCommands::Destroy:
+                this->ProcessDestroyCommands(EntitySpan(m_batchEntities));
+                break;
 
-                // Send event about created entity.
-                m_dispatchers.entityCreated(handleEntry.handle);
+            case EntityCommands::Invalid:
+                Assert(false, "Invalid entity command type.");
+                break;
             }
-            break;
 
-        case EntityCommands::Destroy:
-            {
-                // Locate the handle entry.
-                int handleIndex = command.handle.identifier - 1;
-                HandleEntry& handleEntry = m_handles[handleIndex];
+            batchBegin = batchEnd;
+        }
+
+        m_processedCommands.clear();
+    }
+
+    // Reserve free handles for other threads.
+    this->RefillReservedHandles();
+}
 
-                // Check if handles match.
-                if(command.handle != handleEntry.handle)
+EntityHandle EntitySystem::ReserveHandle()
+{
+    if(!m_initialized)
+        return EntityHandle();
+
+    // Take one of the handles reserved from the free list.
+    std::size_t index = m_reservedCursor++;
+
+    if(index < m_reservedHandles.size())
+        return m_reservedHandles[index];
+
+    // Otherwise take an identifier of a new handle.
+    EntityHandle handle;
+    handle.identifier = m_nextIdentifier++;
+    handle.version = 0;
+
+    Assert(handle.identifier != MaximumIdentifier);
+
+    return handle;
+}
+
+void EntitySystem::SubmitCommands(CommandBatch&& batch)
+{
+    if(!m_initialized)
+        return;
+
+    Assert(batch.commands.size() == batch.setups.size());
+
+    if(batch.commands.empty())
+        return;
+
+    // Add the batch to the submitted list.
+    std::lock_guard<std::mutex> lock(m_batchMutex);
+    m_submittedBatches.push_back(std::move(batch));
+}
+
+void EntitySystem::MergeCommandBatches()
+{
+    Assert(m_initialized);
+
+    // Take submitted batches.
+    {
+        std::lock_guard<std::mutex> lock(m_batchMutex);
+        m_mergedBatches.swap(m_submittedBatches);
+    }
+
+    if(m_mergedBatches.empty())
+        return;
+
+    // Sort batches so the merge does not depend on the submission order.
+    std::stable_sort(m_mergedBatches.begin(), m_mergedBatches.end(),
+        [](const CommandBatch& a, const CommandBatch& b)
+        {
+            return a.sortKey < b.sortKey;
+        }
+    );
+
+    // Append commands of each batch.
+    for(auto& batch : m_mergedBatches)
+    {
+        for(std::size_t i = 0; i < batch.commands.size(); ++i)
+        {
+            const EntityCommand& command = batch.commands[i];
+
+            switch(command.type)
+            {
+            case EntityCommands::Create:
                 {
-                    // Trying to destroy an entity twice.
-                    Assert(false);
-                    continue;
-                }
+                    // Make sure the reserved handle has an entry.
+                    this->CreateHandleEntries(command.handle.identifier);
+
+                    // Skip handles reserved before all entities were destroyed.
+                    HandleEntry& handleEntry = m_handles[command.handle.identifier - 1];
+
+                    if(command.handle != handleEntry.handle)
+                        break;
 
-                // Send event about soon to be destroyed entity.
-                m_dispatchers.entityDestroyed(handleEntry.handle);
+                    // Mark handle as valid.
+                    Assert(handleEntry.flags & HandleFlags::Reserved);
 
-                // Decrement the counter of active entities.
-                m_entityCount -= 1;
+                    handleEntry.flags = HandleFlags::Valid;
 
-                // Free entity handle.
-                Assert(handleEntry.flags & HandleFlags::Destroy);
+                    // Setup the entity before it gets finalized.
+                    if(batch.setups[i])
+                    {
+                        batch.setups[i](command.handle);
+                    }
 
-                this->FreeHandle(handleIndex, handleEntry);
+                    m_commands.push_back(command);
+                }
+                break;
+
+            case EntityCommands::Destroy:
+                this->DestroyEntity(command.handle);
+                break;
+
+            case EntityCommands::Invalid:
+                Assert(false, "Invalid entity command type.");
+                break;
             }
-            break;
         }
+    }
+
+    m_mergedBatches.clear();
+}
+
+void EntitySystem::RefillReservedHandles()
+{
+    Assert(m_initialized);
+
+    // Remove handles that have been taken.
+    std::size_t takenCount = std::min<std::size_t>(m_reservedCursor, m_reservedHandles.size());
+    m_reservedHandles.erase(m_reservedHandles.begin(), m_reservedHandles.begin() + takenCount);
+    m_reservedCursor = 0;
+
+    // Reserve handles from the free list.
+    while(m_reservedHandles.size() < ReservedHandleCount && !m_freeListIsEmpty)
+    {
+        HandleEntry& handleEntry = this->PopFreeHandle();
+        handleEntry.flags = HandleFlags::Reserved;
+
+        m_reservedHandles.push_back(handleEntry.handle);
+    }
+}
+
+void EntitySystem::ProcessCreateCommands(EntitySpan entities)
+{
+    Assert(m_initialized);
+
+    // Make sure handles match.
+    for(const EntityHandle& entity : entities)
+    {
+        Assert(entity == m_handles[entity.identifier - 1].handle);
+    }
+
+    // Inform that we want these entities finalized.
+    m_batchResults.assign(entities.GetSize(), 1);
+    m_dispatchers.entityFinalize(entities, ResultSpan(m_batchResults));
+
+    // Activate finalized entities.
+    std::size_t createdCount = 0;
+
+    for(std::size_t i = 0; i < entities.GetSize(); ++i)
+    {
+        const EntityHandle& entity = entities[i];
+
+        // Destroy the entity if it could not be finalized.
+        if(!m_batchResults[i])
+        {
+            this->DestroyEntity(entity);
+            continue;
+        }
+
+        // Mark handle as active.
+        HandleEntry& handleEntry = m_handles[entity.identifier - 1];
+        Assert(!(handleEntry.flags & HandleFlags::Active));
+
+        handleEntry.flags |= HandleFlags::Active;
+
+        // Keep created entities at the front of the batch.
+        m_batchEntities[createdCount++] = entity;
+    }
+
+    // Increment the counter of active entities.
+    m_entityCount += createdCount;
+
+    // Send event about created entities.
+    if(createdCount != 0)
+    {
+        m_dispatchers.entityCreated(EntitySpan(m_batchEntities.data(), createdCount));
+    }
+}
+
+void EntitySystem::ProcessDestroyCommands(EntitySpan entities)
+{
+    Assert(m_initialized);
+
+    // Remove entities that are destroyed twice.
+    std::size_t destroyedCount = 0;
+
+    for(const EntityHandle& entity : entities)
+    {
+        // Check if handles match.
+        if(entity != m_handles[entity.identifier - 1].handle)
+        {
+            // Trying to destroy an entity twice.
+            Assert(false);
+            continue;
+        }
+
+        m_batchEntities[destroyedCount++] = entity;
+    }
+
+    if(destroyedCount == 0)
+        return;
+
+    // Send event about soon to be destroyed entities.
+    m_dispatchers.entityDestroyed(EntitySpan(m_batchEntities.data(), destroyedCount));
+
+    // Free entity handles.
+    for(std::size_t i = 0; i < destroyedCount; ++i)
+    {
+        int handleIndex = m_batchEntities[i].identifier - 1;
+        HandleEntry& handleEntry = m_handles[handleIndex];
+
+        Assert(handleEntry.flags & HandleFlags::Destroy);
+
+        // Decrement the counter of active entities.
+        if(handleEntry.flags & HandleFlags::Active)
+        {
+            m_entityCount -= 1;
+        }
+
+        this->FreeHandle(handleIndex, handleEntry);
+    }
+}
+
+EntitySystem::HandleEntry& EntitySystem::AllocateHandle()
+{
+    Assert(m_initialized);
+
+    // Create a new handle if the free list queue is empty.
+    if(m_freeListIsEmpty)
+    {
+        int identifier = m_nextIdentifier++;
+
+        // Check if we reached the numerical limits.
+        Assert(identifier != MaximumIdentifier);
+
+        // Create a handle entry.
+        this->CreateHandleEntries(identifier);
 
-        // Remove command from the queue.
-        m_commands.pop();
+        // Mark handle as valid.
+        HandleEntry& handleEntry = m_handles[identifier - 1];
+        handleEntry.flags = HandleFlags::Valid;
+
+        return handleEntry;
+    }
+
+    // Retrieve an unused handle from the free list.
+    HandleEntry& handleEntry = this->PopFreeHandle();
+
+    // Mark handle as valid.
+    handleEntry.flags |= HandleFlags::Valid;
+
+    return handleEntry;
+}
+
+EntitySystem::HandleEntry& EntitySystem::PopFreeHandle()
+{
+    Assert(m_initialized);
+    Assert(!m_freeListIsEmpty);
+
+    // Retrieve an unused handle from the free list.
+    int handleIndex = m_freeListDequeue;
+    HandleEntry& handleEntry = m_handles[handleIndex];
+
+    // Update the free list queue.
+    if(m_freeListDequeue == m_freeListEnqueue)
+    {
+        // If there was only one element in the queue,
+        // set the free list queue state to empty.
+        m_freeListDequeue = InvalidQueueElement;
+        m_freeListEnqueue = InvalidQueueElement;
+        m_freeListIsEmpty = true;
+    }
+    else
+    {
+        // If there were more than a single element in the queue,
+        // set the beginning of the queue to the next free element.
+        m_freeListDequeue = handleEntry.nextFree;
+    }
+
+    // Clear next free handle index.
+    handleEntry.nextFree = InvalidNextFree;
+
+    return handleEntry;
+}
+
+void EntitySystem::CreateHandleEntries(int identifier)
+{
+    Assert(m_initialized);
+
+    if(identifier <= (int)m_handles.size())
+        return;
+
+    // Create entries of new handles. Identifiers in between
+    // have been reserved by other threads.
+    std::size_t firstIndex = m_handles.size();
+    m_handles.resize(identifier);
+
+    for(std::size_t i = firstIndex; i < m_handles.size(); ++i)
+    {
+        HandleEntry& handleEntry = m_handles[i];
+        handleEntry.handle.identifier = (int)i + 1;
+        handleEntry.handle.version = 0;
+        handleEntry.nextFree = InvalidNextFree;
+        handleEntry.flags = HandleFlags::Reserved;
     }
 }
 
@@ -377,3 +716,18 @@ bool EntitySystem::IsHandleValid(const EntityHandle& entity) const
 
     return true;
 }
+
+void EntitySystem::GetActiveEntities(std::vector<EntityHandle>& entities) const
+{
+    if(!m_initialized)
+        return;
+
+    // Collect handles of active entities that are not being destroyed.
+    for(const HandleEntry& handleEntry : m_handles)
+    {
+        if((handleEntry.flags & HandleFlags::Active) && !(handleEntry.flags & HandleFlags::Destroy))
+        {
+            entities.push_back(handleEntry.handle);
+        }
+    }
+}
@@ -31,6 +31,27 @@ struct Context;
 //      */
 //      entitySystem.ProcessCommands();
 //
+//  Creating and destroying entities in bulk:
+//      std::vector<EntityHandle> entities;
+//      entitySystem.CreateEntities(5000, entities);
+//      entitySystem.ProcessCommands();
+//
+//      entitySystem.DestroyEntities(entities);
+//      entitySystem.ProcessCommands();
+//
+//  Commands of the same type that were issued one after another are
+//  processed together and their events carry spans of entity handles.
+//  Receivers of the finalize event clear results of entities they
+//  failed to finalize, which are then destroyed.
+//
+//  Methods of the entity system are not thread safe. Other threads have
+//  to record commands into their own EntityCommandBuffer instances, which
+//  are merged at the beginning of the next ProcessCommands() call.
+//
+//  DestroyAllEntities() also frees handles reserved for other threads and
+//  increments their versions, so commands of buffers that are submitted
+//  afterwards and refer to these handles are ignored.
+//
 
 namespace Game
 {
@@ -54,6 +75,9 @@ namespace Game
 
                 // Entity handle has been scheduled to be destroyed.
                 Destroy = 1 << 2,
+
+                // Entity handle has been reserved for another thread.
+                Reserved = 1 << 3,
             };
 
             static const uint32_t Free = None;
@@ -86,10 +110,32 @@ namespace Game
             EntityHandle handle;
         };
 
-    private:
+        // Entity setup function.
+        typedef std::function<void(EntityHandle)> SetupFunction;
+
+        // Command batch structure.
+        struct CommandBatch
+        {
+            CommandBatch() :
+                sortKey(0)
+            {
+            }
+
+            uint32_t sortKey;
+            std::vector<EntityCommand> commands;
+            std::vector<SetupFunction> setups;
+        };
+
         // Type declarations.
-        typedef std::vector<HandleEntry>  HandleList;
-        typedef std::queue<EntityCommand> CommandList;
+        typedef Span<const EntityHandle> EntitySpan;
+        typedef Span<uint8_t>            ResultSpan;
+
+    private:
+        typedef std::vector<HandleEntry>   HandleList;
+        typedef std::vector<EntityCommand> CommandList;
+        typedef std::vector<EntityHandle>  EntityList;
+        typedef std::vector<uint8_t>       ResultList;
+        typedef std::vector<CommandBatch>  BatchList;
 
     public:
         EntitySystem();
@@ -104,18 +150,35 @@ namespace Game
         // Creates an entity.
         EntityHandle CreateEntity();
 
+        // Creates multiple entities.
+        void CreateEntities(std::size_t count, std::vector<EntityHandle>& entities);
+
         // Destroys an entity.
         void DestroyEntity(const EntityHandle& entity);
 
+        // Destroys multiple entities.
+        void DestroyEntities(EntitySpan entities);
+
         // Destroys all entities.
         void DestroyAllEntities();
 
         // Process entity commands.
         void ProcessCommands();
 
+        // Reserves an entity handle.
+        // Can be called from any thread.
+        EntityHandle ReserveHandle();
+
+        // Submits a batch of recorded commands.
+        // Can be called from any thread.
+        void SubmitCommands(CommandBatch&& batch);
+
         // Checks if an entity handle is valid.
         bool IsHandleValid(const EntityHandle& entity) const;
 
+        // Gets handles of all active entities.
+        void GetActiveEntities(std::vector<EntityHandle>& entities) const;
+
         // Returns the number of active entities.
         unsigned int GetEntityCount() const
         {
@@ -123,37 +186,77 @@ namespace Game
         }
 
     private:
+        // Allocates an entity handle.
+        HandleEntry& AllocateHandle();
+
+        // Takes a handle from the free list.
+        HandleEntry& PopFreeHandle();
+
+        // Creates handle entries up to an identifier.
+        void CreateHandleEntries(int identifier);
+
+        // Merges submitted command batches.
+        void MergeCommandBatches();
+
+        // Refills handles reserved for other threads.
+        void RefillReservedHandles();
+
         // Frees an entity handle.
         void FreeHandle(int handleIndex, HandleEntry& handleEntry);
 
+        // Processes a batch of create commands.
+        void ProcessCreateCommands(EntitySpan entities);
+
+        // Processes a batch of destroy commands.
+        void ProcessDestroyCommands(EntitySpan entities);
+
+    private:
+        // Private event dispatchers.
+        struct EventDispatchers
+        {
+            Dispatcher<void(EntitySpan, ResultSpan)> entityFinalize;
+            Dispatcher<void(EntitySpan)> entityCreated;
+            Dispatcher<void(EntitySpan)> entityDestroyed;
+        };
+
+        // Event dispatchers, constructed before public events refer to them.
+        EventDispatchers m_dispatchers;
+
     public:
         // Public event dispatchers.
-        struct EventDispatchers;
-
         struct Events
         {
             Events(EventDispatchers& dispatchers);
 
-            DispatcherBase<bool(EntityHandle)>& entityFinalize;
-            DispatcherBase<void(EntityHandle)>& entityCreated;
-            DispatcherBase<void(EntityHandle)>& entityDestroyed;
+            DispatcherBase<void(EntitySpan, ResultSpan)>& entityFinalize;
+            DispatcherBase<void(EntitySpan)>& entityCreated;
+            DispatcherBase<void(EntitySpan)>& entityDestroyed;
         } events;
 
-        // Private event dispatchers.
-        struct EventDispatchers
-        {
-            Dispatcher<bool(EntityHandle), CollectWhileTrue<bool>> entityFinalize;
-            Dispatcher<void(EntityHandle)> entityCreated;
-            Dispatcher<void(EntityHandle)> entityDestroyed;
-        };
-
     private:
         // List of commands.
         CommandList m_commands;
+        CommandList m_processedCommands;
+
+        // Batch of processed entities.
+        EntityList m_batchEntities;
+        ResultList m_batchResults;
 
         // List of entity handles.
         HandleList m_handles;
 
+        // Next identifier of a new handle.
+        std::atomic<int> m_nextIdentifier;
+
+        // Handles reserved for other threads.
+        EntityList m_reservedHandles;
+        std::atomic<std::size_t> m_reservedCursor;
+
+        // Submitted command batches.
+        std::mutex m_batchMutex;
+        BatchList m_submittedBatches;
+        BatchList m_mergedBatches;
+
         // Number of active entities.
         unsigned int m_entityCount;
 
@@ -162,9 +265,6 @@ namespace Game
         int  m_freeListEnqueue;
         bool m_freeListIsEmpty;
 
-        // Event dispatchers.
-        EventDispatchers m_dispatchers;
-
         // Initialization state.
         bool m_initialized;
     };
@@ -173,17 +173,23 @@ void IdentitySystem::RemoveElement(std::size_t index)
     m_entities.pop_back();
 }
 
-void IdentitySystem::OnEntityDestroyed(EntityHandle handle)
+void IdentitySystem::OnEntityDestroyed(Span<const EntityHandle> handles)
 {
     Assert(m_initialized);
 
-    // Remove entity if it was registered.
-    // Pointer that's passed below will be dereferenced.
-    auto it = m_entityLookup.find(&handle);
-    
-    if(it != m_entityLookup.end())
+    if(m_entityLookup.empty())
+        return;
+
+    for(const EntityHandle& handle : handles)
     {
-        std::size_t index = it->second;
-        this->RemoveElement(index);
+        // Remove entity if it was registered.
+        // Pointer that's passed below will be dereferenced.
+        auto it = m_entityLookup.find(&handle);
+
+        if(it != m_entityLookup.end())
+        {
+            std::size_t index = it->second;
+            this->RemoveElement(index);
+        }
     }
 }
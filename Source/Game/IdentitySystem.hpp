@@ -66,8 +66,8 @@ namespace Game
         // Removes an element by index.
         void RemoveElement(std::size_t index);
 
-        // Called when an entity gets destroyed.
-        void OnEntityDestroyed(EntityHandle handle);
+        // Called when entities get destroyed.
+        void OnEntityDestroyed(Span<const EntityHandle> handles);
 
     private:
         // Registry of named entities.
@@ -78,7 +78,7 @@ namespace Game
         NameLookupList m_nameLookup;
 
         // Event receivers.
-        Receiver<void(EntityHandle)> m_entityDestroyed;
+        Receiver<void(Span<const EntityHandle>)> m_entityDestroyed;
 
         // Initialization state.
         bool m_initialized;
@@ -0,0 +1,397 @@
+#include "Precompiled.hpp"
+#include "ParticleSystem.hpp"
+#include "ComponentSystem.hpp"
+#include "Components/Transform.hpp"
+#include "Components/ParticleEmitter.hpp"
+#include "Graphics/RenderQueue.hpp"
+#include "Graphics/Texture.hpp"
+#include "Context.hpp"
+using namespace Game;
+
+// Use SSE2 kernels where available.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define PARTICLE_SYSTEM_SSE2
+    #include <emmintrin.h>
+#endif
+
+namespace
+{
+    // Number of particles processed together.
+    const int ParticleGroupSize = 4;
+
+    // Rounds a particle count up to whole groups.
+    int RoundToGroups(int count)
+    {
+        return (count + ParticleGroupSize - 1) / ParticleGroupSize * ParticleGroupSize;
+    }
+}
+
+ParticleSystem::ParticlePool::ParticlePool() :
+    count(0),
+    spawnAccumulator(0.0f),
+    filledCount(0),
+    sortKey(0),
+    version(0)
+{
+}
+
+ParticleSystem::ParticleSystem() :
+    m_renderQueue(nullptr),
+    m_componentSystem(nullptr),
+    m_version(0),
+    m_initialized(false)
+{
+}
+
+ParticleSystem::~ParticleSystem()
+{
+    this->Cleanup();
+}
+
+void ParticleSystem::Cleanup()
+{
+    if(!m_initialized)
+        return;
+
+    // Reset context references.
+    m_renderQueue = nullptr;
+    m_componentSystem = nullptr;
+
+    // Release particle pools.
+    Utility::ClearContainer(m_pools);
+    m_version = 0;
+
+    // Reset initialization state.
+    m_initialized = false;
+}
+
+bool ParticleSystem::Initialize(Context& context)
+{
+    Assert(context.renderQueue != nullptr);
+    Assert(context.componentSystem != nullptr);
+    Assert(context.particleSystem == nullptr);
+
+    // Cleanup this instance.
+    this->Cleanup();
+
+    // Get required context instances.
+    m_renderQueue = context.renderQueue;
+    m_componentSystem = context.componentSystem;
+
+    // Set context instance.
+    context.particleSystem = this;
+
+    // Success!
+    return m_initialized = true;
+}
+
+void ParticleSystem::Update(float timeDelta)
+{
+    if(!m_initialized)
+        return;
+
+    // Start tracking changes made after this update.
+    ComponentVersion lastVersion = m_version;
+    m_version = AdvanceComponentVersion();
+
+    // Update particles of emitters.
+    auto entities = m_componentSystem->View<Components::ParticleEmitter, Components::Transform>();
+
+    for(auto it = entities.Begin(); it != entities.End(); ++it)
+    {
+        const Components::ParticleEmitter& emitter = it.Get<Components::ParticleEmitter>();
+        const Components::Transform& transform = it.Get<Components::Transform>();
+
+        // Get the particle pool.
+        auto result = m_pools.emplace(it.GetEntity(), ParticlePool());
+        ParticlePool& pool = result.first->second;
+
+        if(result.second)
+        {
+            pool.random.seed(it.GetEntity().identifier);
+        }
+
+        // Mark the pool as present in this update.
+        pool.version = m_version;
+
+        // Update parameters of the emitter.
+        if(result.second || emitter.IsChangedSince(lastVersion))
+        {
+            pool.info.texture = emitter.GetTexture().get();
+            pool.info.transparent = emitter.IsTransparent();
+            pool.info.filter = false;
+
+            this->ResizePool(pool, emitter.GetMaximumCount());
+
+            // Refill instances with new parameters.
+            pool.filledCount = 0;
+        }
+
+        // Update particles.
+        this->Simulate(pool, emitter, timeDelta);
+        this->Spawn(pool, emitter, transform, timeDelta);
+        this->Pack(pool, emitter);
+
+        // Sort particles with world sprites at the emitter position.
+        Graphics::BasicRenderer::Sprite::Data data;
+        data.position = glm::vec3(transform.GetPosition(), 0.0f);
+
+        pool.sortKey = m_renderQueue->CalculateKey(Graphics::RenderQueue::Layers::World, pool.info, data);
+    }
+
+    // Remove pools of entities that no longer have required components.
+    for(auto it = m_pools.begin(); it != m_pools.end();)
+    {
+        if(it->second.version != m_version)
+        {
+            it = m_pools.erase(it);
+            continue;
+        }
+
+        ++it;
+    }
+}
+
+void ParticleSystem::Draw()
+{
+    if(!m_initialized)
+        return;
+
+    // Push instances of emitters with uploaded textures.
+    for(const auto& element : m_pools)
+    {
+        const ParticlePool& pool = element.second;
+
+        if(pool.count == 0)
+            continue;
+
+        if(pool.info.texture == nullptr || pool.info.texture->IsPending())
+            continue;
+
+        m_renderQueue->PushInstances(pool.sortKey, pool.info, pool.instances.data(), pool.count);
+    }
+}
+
+int ParticleSystem::GetParticleCount() const
+{
+    int count = 0;
+
+    for(const auto& element : m_pools)
+    {
+        count += element.second.count;
+    }
+
+    return count;
+}
+
+void ParticleSystem::ResizePool(ParticlePool& pool, int capacity)
+{
+    // Remove particles over the capacity.
+    pool.count = std::min(pool.count, capacity);
+
+    // Pad arrays to whole groups, so kernels do not need a remainder loop.
+    // Values past the particle count are processed, but never drawn.
+    std::size_t size = RoundToGroups(capacity);
+
+    pool.positionX.resize(size, 0.0f);
+    pool.positionY.resize(size, 0.0f);
+    pool.velocityX.resize(size, 0.0f);
+    pool.velocityY.resize(size, 0.0f);
+    pool.age.resize(size, 0.0f);
+    pool.ageRate.resize(size, 0.0f);
+
+    pool.instances.resize(capacity);
+}
+
+void ParticleSystem::Simulate(ParticlePool& pool, const Components::ParticleEmitter& emitter, float timeDelta)
+{
+    if(pool.count == 0)
+        return;
+
+    float* positionX = pool.positionX.data();
+    float* positionY = pool.positionY.data();
+    float* velocityX = pool.velocityX.data();
+    float* velocityY = pool.velocityY.data();
+    float* age = pool.age.data();
+    float* ageRate = pool.ageRate.data();
+
+    // Integrate velocities and positions.
+    glm::vec2 velocityDelta = emitter.GetAcceleration() * timeDelta;
+
+#ifdef PARTICLE_SYSTEM_SSE2
+    __m128 deltaTime = _mm_set1_ps(timeDelta);
+    __m128 deltaVelocityX = _mm_set1_ps(velocityDelta.x);
+    __m128 deltaVelocityY = _mm_set1_ps(velocityDelta.y);
+
+    for(int i = 0; i < pool.count; i += ParticleGroupSize)
+    {
+        __m128 vx = _mm_add_ps(_mm_loadu_ps(velocityX + i), deltaVelocityX);
+        __m128 vy = _mm_add_ps(_mm_loadu_ps(velocityY + i), deltaVelocityY);
+
+        _mm_storeu_ps(velocityX + i, vx);
+        _mm_storeu_ps(velocityY + i, vy);
+
+        _mm_storeu_ps(positionX + i, _mm_add_ps(_mm_loadu_ps(positionX + i), _mm_mul_ps(vx, deltaTime)));
+        _mm_storeu_ps(positionY + i, _mm_add_ps(_mm_loadu_ps(positionY + i), _mm_mul_ps(vy, deltaTime)));
+
+        _mm_storeu_ps(age + i, _mm_add_ps(_mm_loadu_ps(age + i), _mm_mul_ps(_mm_loadu_ps(ageRate + i), deltaTime)));
+    }
+#else
+    for(int i = 0; i < pool.count; ++i)
+    {
+        velocityX[i] += velocityDelta.x;
+        velocityY[i] += velocityDelta.y;
+
+        positionX[i] += velocityX[i] * timeDelta;
+        positionY[i] += velocityY[i] * timeDelta;
+
+        age[i] += ageRate[i] * timeDelta;
+    }
+#endif
+
+    // Replace dead particles with the last alive ones.
+    int index = 0;
+
+    while(index < pool.count)
+    {
+#ifdef PARTICLE_SYSTEM_SSE2
+        // Skip whole groups of alive particles.
+        if(index + ParticleGroupSize <= pool.count)
+        {
+            __m128 dead = _mm_cmpge_ps(_mm_loadu_ps(age + index), _mm_set1_ps(1.0f));
+
+            if(_mm_movemask_ps(dead) == 0)
+            {
+                index += ParticleGroupSize;
+                continue;
+            }
+        }
+#endif
+
+        if(age[index] < 1.0f)
+        {
+            ++index;
+            continue;
+        }
+
+        int last = --pool.count;
+
+        positionX[index] = positionX[last];
+        positionY[index] = positionY[last];
+        velocityX[index] = velocityX[last];
+        velocityY[index] = velocityY[last];
+        age[index] = age[last];
+        ageRate[index] = ageRate[last];
+    }
+}
+
+void ParticleSystem::Spawn(ParticlePool& pool, const Components::ParticleEmitter& emitter, const Components::Transform& transform, float timeDelta)
+{
+    if(!emitter.IsEmitting())
+    {
+        pool.spawnAccumulator = 0.0f;
+        return;
+    }
+
+    // Calculate the number of particles to spawn.
+    pool.spawnAccumulator += emitter.GetSpawnRate() * timeDelta;
+
+    int spawnCount = (int)pool.spawnAccumulator;
+    pool.spawnAccumulator -= (float)spawnCount;
+
+    spawnCount = std::min(spawnCount, emitter.GetMaximumCount() - pool.count);
+
+    if(spawnCount <= 0)
+        return;
+
+    // Spawn particles at the emitter position.
+    std::uniform_real_distribution<float> random(0.0f, 1.0f);
+
+    const glm::vec2& position = transform.GetPosition();
+    const glm::vec2& velocityMin = emitter.GetVelocityMin();
+    const glm::vec2& velocityMax = emitter.GetVelocityMax();
+
+    for(int i = 0; i < spawnCount; ++i)
+    {
+        int index = pool.count++;
+
+        glm::vec2 velocity = glm::mix(velocityMin, velocityMax, glm::vec2(random(pool.random), random(pool.random)));
+        float lifetime = glm::mix(emitter.GetLifetimeMin(), emitter.GetLifetimeMax(), random(pool.random));
+
+        pool.positionX[index] = position.x;
+        pool.positionY[index] = position.y;
+        pool.velocityX[index] = velocity.x;
+        pool.velocityY[index] = velocity.y;
+
+        // Ages are normalized to lifetimes.
+        pool.age[index] = 0.0f;
+        pool.ageRate[index] = lifetime > 0.0f ? 1.0f / lifetime : std::numeric_limits<float>::max();
+    }
+}
+
+void ParticleSystem::Pack(ParticlePool& pool, const Components::ParticleEmitter& emitter)
+{
+    // Fill constant fields of instances that were not used before.
+    if(pool.filledCount < pool.count)
+    {
+        glm::vec2 size = glm::abs(glm::vec2(emitter.GetRectangle().z, emitter.GetRectangle().w));
+
+        Graphics::BasicRenderer::Sprite::Data data;
+        data.scale = size.x > 0.0f && size.y > 0.0f ? emitter.GetSize() / size : glm::vec2(0.0f);
+        data.offset = size * -0.5f;
+        data.rectangle = glm::i16vec4(glm::round(emitter.GetRectangle()));
+
+        std::fill(pool.instances.begin() + pool.filledCount, pool.instances.begin() + pool.count, data);
+        pool.filledCount = pool.count;
+    }
+
+    // Write positions and colors faded over particle lifetimes.
+    glm::vec4 startColor = glm::clamp(emitter.GetStartColor(), 0.0f, 1.0f);
+    glm::vec4 endColor = glm::clamp(emitter.GetEndColor(), 0.0f, 1.0f);
+
+    const float* positionX = pool.positionX.data();
+    const float* positionY = pool.positionY.data();
+    const float* age = pool.age.data();
+    Graphics::BasicRenderer::Sprite::Data* instances = pool.instances.data();
+
+#ifdef PARTICLE_SYSTEM_SSE2
+    // Scale colors to bytes before fading them.
+    glm::vec4 startBytes = startColor * 255.0f;
+    glm::vec4 deltaBytes = (endColor - startColor) * 255.0f;
+
+    __m128 zero = _mm_setzero_ps();
+    __m128 one = _mm_set1_ps(1.0f);
+
+    for(int i = 0; i < pool.count; i += ParticleGroupSize)
+    {
+        __m128 t = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(age + i), zero), one);
+
+        __m128i r = _mm_cvtps_epi32(_mm_add_ps(_mm_set1_ps(startBytes.r), _mm_mul_ps(_mm_set1_ps(deltaBytes.r), t)));
+        __m128i g = _mm_cvtps_epi32(_mm_add_ps(_mm_set1_ps(startBytes.g), _mm_mul_ps(_mm_set1_ps(deltaBytes.g), t)));
+        __m128i b = _mm_cvtps_epi32(_mm_add_ps(_mm_set1_ps(startBytes.b), _mm_mul_ps(_mm_set1_ps(deltaBytes.b), t)));
+        __m128i a = _mm_cvtps_epi32(_mm_add_ps(_mm_set1_ps(startBytes.a), _mm_mul_ps(_mm_set1_ps(deltaBytes.a), t)));
+
+        // Pack channels with red in the lowest byte.
+        __m128i packed = _mm_or_si128(_mm_or_si128(r, _mm_slli_epi32(g, 8)), _mm_or_si128(_mm_slli_epi32(b, 16), _mm_slli_epi32(a, 24)));
+
+        uint32_t colors[ParticleGroupSize];
+        _mm_storeu_si128((__m128i*)colors, packed);
+
+        int groupCount = std::min(ParticleGroupSize, pool.count - i);
+
+        for(int j = 0; j < groupCount; ++j)
+        {
+            instances[i + j].position = glm::vec3(positionX[i + j], positionY[i + j], 0.0f);
+            instances[i + j].color = colors[j];
+        }
+    }
+#else
+    for(int i = 0; i < pool.count; ++i)
+    {
+        float t = glm::clamp(age[i], 0.0f, 1.0f);
+
+        instances[i].position = glm::vec3(positionX[i], positionY[i], 0.0f);
+        instances[i].color = glm::packUnorm4x8(glm::mix(startColor, endColor, t));
+    }
+#endif
+}
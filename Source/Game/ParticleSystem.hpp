@@ -0,0 +1,137 @@
+#pragma once
+
+#include "Precompiled.hpp"
+#include "Graphics/BasicRenderer.hpp"
+#include "Game/Component.hpp"
+
+// Forward declarations.
+struct Context;
+
+namespace Graphics
+{
+    class RenderQueue;
+}
+
+//
+// Particle System
+//
+//  Simulates and draws particles of particle emitter components.
+//
+//  Example usage:
+//      Game::ParticleSystem particleSystem;
+//      particleSystem.Initialize(context);
+//
+//      particleSystem.Update(timeDelta);
+//      particleSystem.Draw();
+//
+//  Particles of each emitter are stored in separate arrays of their
+//  attributes, which are padded to groups of four, so integration, aging
+//  and color fading are done four particles at a time with SSE2. Dead
+//  particles are replaced with the last alive one, so arrays stay packed.
+//
+//  Sprite instances of particles are kept between updates. Only their
+//  positions and colors are written every update, while other fields are
+//  filled when the emitter changes or new particles take unused instances.
+//
+//  Instances are pushed to the world layer of the render queue as instance
+//  runs, which are sorted with world sprites by the emitter position and
+//  are drawn with the same sprite shader. Particles are drawn until the
+//  next update, which has to run after the render queue has been submitted.
+//  Emitters with pending textures are simulated, but not drawn.
+//
+
+namespace Game
+{
+    // Forward declarations.
+    class ComponentSystem;
+
+    namespace Components
+    {
+        class ParticleEmitter;
+        class Transform;
+    }
+
+    // Particle system class.
+    class ParticleSystem
+    {
+    public:
+        // Type declarations.
+        typedef std::vector<float> AttributeList;
+
+        // Particle pool structure.
+        struct ParticlePool
+        {
+            ParticlePool();
+
+            // Particle attributes.
+            AttributeList positionX;
+            AttributeList positionY;
+            AttributeList velocityX;
+            AttributeList velocityY;
+            AttributeList age;
+            AttributeList ageRate;
+            int count;
+
+            // Spawning state.
+            float spawnAccumulator;
+            std::minstd_rand random;
+
+            // Sprite instances of particles.
+            Graphics::BasicRenderer::Sprite::Info info;
+            Graphics::BasicRenderer::SpriteDataList instances;
+            int filledCount;
+            uint64_t sortKey;
+
+            // Component version of the last update.
+            ComponentVersion version;
+        };
+
+        typedef std::unordered_map<EntityHandle, ParticlePool> ParticlePoolList;
+
+    public:
+        ParticleSystem();
+        ~ParticleSystem();
+
+        // Restores instance to it's original state.
+        void Cleanup();
+
+        // Initializes the particle system.
+        bool Initialize(Context& context);
+
+        // Updates particles of all emitters.
+        void Update(float timeDelta);
+
+        // Pushes particles to the render queue.
+        void Draw();
+
+        // Gets the number of alive particles.
+        int GetParticleCount() const;
+
+    private:
+        // Resizes attribute arrays of a pool.
+        void ResizePool(ParticlePool& pool, int capacity);
+
+        // Moves and ages particles, then removes dead ones.
+        void Simulate(ParticlePool& pool, const Components::ParticleEmitter& emitter, float timeDelta);
+
+        // Spawns new particles.
+        void Spawn(ParticlePool& pool, const Components::ParticleEmitter& emitter, const Components::Transform& transform, float timeDelta);
+
+        // Writes sprite instances of particles.
+        void Pack(ParticlePool& pool, const Components::ParticleEmitter& emitter);
+
+    private:
+        // Context references.
+        Graphics::RenderQueue* m_renderQueue;
+        ComponentSystem*       m_componentSystem;
+
+        // Particle pools of emitter entities.
+        ParticlePoolList m_pools;
+
+        // Component version of the last update.
+        ComponentVersion m_version;
+
+        // Initialization state.
+        bool m_initialized;
+    };
+}
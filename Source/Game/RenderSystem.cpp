@@ -4,6 +4,9 @@
 #include "Components/Transform.hpp"
 #include "Components/Render.hpp"
 #include "System/Window.hpp"
+#include "System/JobSystem.hpp"
+#include "System/ResourceManager.hpp"
+#include "Graphics/Texture.hpp"
 #include "Context.hpp"
 using namespace Game;
 
@@ -14,12 +17,53 @@ namespace
 
     // Global render scale.
     const glm::vec3 RenderScale(1.0f / 16.0f, 1.0f / 16.0f, 1.0f);
+
+    // Size of sprite grid cells in world units.
+    const float SpriteGridCellSize = 8.0f;
+
+    // Number of entities gathered by a single job.
+    const std::size_t SpriteGatherGrain = 2048;
+
+    // Frame size used when drawing without a window.
+    const int HeadlessFrameWidth = 1024;
+    const int HeadlessFrameHeight = 576;
+
+    // Checks if two [left, bottom, right, top] bounds overlap.
+    bool IsOverlapping(const glm::vec4& a, const glm::vec4& b)
+    {
+        return a.x <= b.z && b.x <= a.z && a.y <= b.w && b.y <= a.w;
+    }
+
+    // Checks if a sprite rectangle samples only the inside of a texture.
+    // Rectangle's y coordinate marks its bottom edge and sizes can be negative.
+    bool IsInsideTexture(const glm::vec4& rectangle, const Graphics::Texture& texture)
+    {
+        float left = std::min(rectangle.x, rectangle.x + rectangle.z);
+        float right = std::max(rectangle.x, rectangle.x + rectangle.z);
+        float top = std::min(rectangle.y, rectangle.y - rectangle.w);
+        float bottom = std::max(rectangle.y, rectangle.y - rectangle.w);
+
+        return left >= 0.0f && right <= texture.GetWidth() && top >= 0.0f && bottom <= texture.GetHeight();
+    }
+
+    // Checks if the texture of a render component waits for its upload.
+    bool IsTexturePending(const Game::Components::Render& render)
+    {
+        const auto& texture = render.GetTexture();
+        return texture != nullptr && texture->IsPending();
+    }
 }
 
 RenderSystem::RenderSystem() :
     m_window(nullptr),
     m_basicRenderer(nullptr),
+    m_renderQueue(nullptr),
     m_componentSystem(nullptr),
+    m_jobSystem(nullptr),
+    m_resourceManager(nullptr),
+    m_parallelGather(true),
+    m_version(0),
+    m_pendingSprites(false),
     m_initialized(false)
 {
 }
@@ -37,15 +81,31 @@ void RenderSystem::Cleanup()
     // Reset context references.
     m_window = nullptr;
     m_basicRenderer = nullptr;
+    m_renderQueue = nullptr;
     m_componentSystem = nullptr;
+    m_jobSystem = nullptr;
+    m_resourceManager = nullptr;
+
+    // Release the placeholder texture.
+    m_placeholderTexture = nullptr;
 
     // Reset screen space transform.
     m_screenSpace.Cleanup();
 
-    // Cleanup sprite lists.
-    Utility::ClearContainer(m_spriteInfo);
-    Utility::ClearContainer(m_spriteData);
-    Utility::ClearContainer(m_spriteSort);
+    // Cleanup the texture atlas.
+    m_textureAtlas.Cleanup();
+
+    // Cleanup the tile map renderer.
+    m_tileMapRenderer.Cleanup();
+
+    // Cleanup sprite cache.
+    Utility::ClearContainer(m_spriteCache);
+    Utility::ClearContainer(m_visibleSprites);
+    Utility::ClearContainer(m_rebuiltSprites);
+    m_spriteGrid.Cleanup();
+    m_parallelGather = true;
+    m_version = 0;
+    m_pendingSprites = false;
 
     // Reset initialization state.
     m_initialized = false;
@@ -53,8 +113,8 @@ void RenderSystem::Cleanup()
 
 bool RenderSystem::Initialize(Context& context)
 {
-    Assert(context.window != nullptr);
     Assert(context.basicRenderer != nullptr);
+    Assert(context.renderQueue != nullptr);
     Assert(context.componentSystem != nullptr);
     Assert(context.renderSystem == nullptr);
 
@@ -72,18 +132,42 @@ bool RenderSystem::Initialize(Context& context)
     );
 
     // Get required context instances.
-    m_window = context.window;
     m_basicRenderer = context.basicRenderer;
+    m_renderQueue = context.renderQueue;
     m_componentSystem = context.componentSystem;
 
+    // Get optional context instances.
+    m_window = context.window;
+    m_jobSystem = context.jobSystem;
+    m_resourceManager = context.resourceManager;
+
     // Set screen space target size.
     m_screenSpace.SetTargetSize(10.0f, 10.0f);
 
-    // Allocate initial sprite list memory.
-    const int SpriteListSize = 128;
-    m_spriteInfo.reserve(SpriteListSize);
-    m_spriteData.reserve(SpriteListSize);
-    m_spriteSort.reserve(SpriteListSize);
+    // Initialize the sprite grid.
+    if(!m_spriteGrid.Initialize(SpriteGridCellSize))
+    {
+        Log() << LogInitializeError() << "Couldn't initialize the sprite grid.";
+        return false;
+    }
+
+    // Initialize the texture atlas.
+    // Atlas pages are copied on the GPU, so other backends draw original textures.
+    if(m_basicRenderer->GetBackendType() == Graphics::BasicRenderer::Backend::OpenGL)
+    {
+        if(!m_textureAtlas.Initialize())
+        {
+            Log() << LogInitializeError() << "Couldn't initialize the texture atlas.";
+            return false;
+        }
+    }
+
+    // Initialize the tile map renderer.
+    if(!m_tileMapRenderer.Initialize(context))
+    {
+        Log() << LogInitializeError() << "Couldn't initialize the tile map renderer.";
+        return false;
+    }
 
     // Set context instance.
     context.renderSystem = this;
@@ -98,11 +182,17 @@ void RenderSystem::Draw()
         return;
 
     // Get window size.
-    int windowWidth = m_window->GetWidth();
-    int windowHeight = m_window->GetHeight();
+    int windowWidth = HeadlessFrameWidth;
+    int windowHeight = HeadlessFrameHeight;
+
+    if(m_window != nullptr)
+    {
+        windowWidth = m_window->GetWidth();
+        windowHeight = m_window->GetHeight();
+    }
 
     // Set viewport size.
-    glViewport(0, 0, windowWidth, windowHeight);
+    m_basicRenderer->SetViewport(0, 0, windowWidth, windowHeight);
 
     // Set screen space source size.
     m_screenSpace.SetSourceSize(windowWidth, windowHeight);
@@ -116,106 +206,281 @@ void RenderSystem::Draw()
     m_basicRenderer->SetClearDepth(1.0f);
     m_basicRenderer->Clear();
 
-    // Iterate over all render components.
-    auto componentsBegin = m_componentSystem->Begin<Components::Render>();
-    auto componentsEnd = m_componentSystem->End<Components::Render>();
+    // Collect drawing statistics for this frame only.
+    m_basicRenderer->ResetStatistics();
 
-    for(auto it = componentsBegin; it != componentsEnd; ++it)
+    // Get the placeholder for pending textures.
+    if(m_resourceManager != nullptr)
     {
-        // Get entity components.
-        Components::Render* render = &it->second;
-        Assert(render != nullptr);
+        m_placeholderTexture = m_resourceManager->GetPool<Graphics::Texture>()->GetDefault();
+    }
 
-        Components::Transform* transform = render->GetTransform();
-        Assert(transform != nullptr);
+    // Update cached sprites only when a render or transform component has changed
+    // since the last update or when some sprites wait for their textures.
+    if(m_pendingSprites || m_componentSystem->IsChangedSince<Components::Render>(m_version) ||
+        m_componentSystem->IsChangedSince<Components::Transform>(m_version))
+    {
+        this->UpdateSprites();
+    }
 
-        // Add sprite to render the list.
-        Graphics::BasicRenderer::Sprite::Info info;
-        info.texture = render->GetTexture().get();
-        info.transparent = render->IsTransparent();
-        info.filter = false;
+    // Calculate view bounds from corners of the clip space.
+    glm::mat4 inverseTransform = glm::inverse(transform);
+    glm::vec4 viewBounds(std::numeric_limits<float>::max(), std::numeric_limits<float>::max(),
+        -std::numeric_limits<float>::max(), -std::numeric_limits<float>::max());
 
-        Graphics::BasicRenderer::Sprite::Data data;
-        data.transform = glm::translate(data.transform, glm::vec3(transform->GetPosition(), 0.0f));
-//      data.transform = glm::rotate(data.transform, transform->GetRotation(), glm::vec3(0.0f, 0.0f, -1.0f));
-        data.transform = glm::scale(data.transform, glm::vec3(transform->GetScale(), 1.0f) * RenderScale);
-        data.transform = glm::translate(data.transform, glm::vec3(render->GetOffset(), 0.0f));
-        data.rectangle = render->GetRectangle();
-        data.color = render->CalculateColor();
+    for(int i = 0; i < 4; ++i)
+    {
+        glm::vec4 corner = inverseTransform * glm::vec4(i & 1 ? 1.0f : -1.0f, i & 2 ? 1.0f : -1.0f, 0.0f, 1.0f);
 
-        m_spriteInfo.push_back(info);
-        m_spriteData.push_back(data);
+        viewBounds.x = std::min(viewBounds.x, corner.x);
+        viewBounds.y = std::min(viewBounds.y, corner.y);
+        viewBounds.z = std::max(viewBounds.z, corner.x);
+        viewBounds.w = std::max(viewBounds.w, corner.y);
     }
 
-    // Define sorting function.
-    auto SpriteSort = [&](const int& a, const int& b)
+    // Queue tile maps behind sprites.
+    m_tileMapRenderer.Draw(transform, viewBounds);
+
+    // Find sprites in grid cells overlapping the view.
+    m_spriteGrid.Query(viewBounds, m_visibleSprites);
+
+    for(uint32_t cacheIndex : m_visibleSprites)
     {
-        // Get sprite info and data.
-        const auto& spriteInfoA = m_spriteInfo[a];
-        const auto& spriteDataA = m_spriteData[a];
+        CachedSprite& sprite = m_spriteCache[cacheIndex];
+
+        // Remove sprites of entities that no longer have required components.
+        if(sprite.version != m_version)
+        {
+            m_spriteGrid.Remove(cacheIndex);
+            sprite.entity = EntityHandle();
+            continue;
+        }
+
+        // Skip sprites that are outside of the view.
+        if(!IsOverlapping(sprite.bounds, viewBounds))
+            continue;
+
+        // Add sprite to the render queue.
+        m_renderQueue->Push(sprite.sortKey, sprite.info, sprite.data);
+    }
 
-        const auto& spriteInfoB = m_spriteInfo[b];
-        const auto& spriteDataB = m_spriteData[b];
+    m_visibleSprites.clear();
 
-        // Sort by transparency (opaque first, transparent second).
-        if(spriteInfoA.transparent < spriteInfoB.transparent)
-            return true;
+    // Draw queued sprites.
+    m_renderQueue->SetTransform(Graphics::RenderQueue::Layers::World, transform);
+    m_renderQueue->Submit();
+}
+
+void RenderSystem::UpdateSprites()
+{
+    Assert(m_initialized);
+
+    // Start tracking changes made after this update.
+    ComponentVersion lastVersion = m_version;
+    m_version = AdvanceComponentVersion();
+
+    // Reclaim atlas regions of released textures.
+    // Sprites that used them have been removed or are rebuilt below.
+    m_textureAtlas.ReleaseUnused();
+
+    // Iterate over entities with render and transform components.
+    auto entities = m_componentSystem->View<Components::Render, Components::Transform>();
+
+    // Track sprites that still wait for their textures.
+    std::atomic<bool> pendingSprites(false);
+
+    // Define gathering function.
+    typedef decltype(entities.Begin()) EntityIterator;
 
-        if(spriteInfoA.transparent == spriteInfoB.transparent)
+    auto GatherSprites = [&](EntityIterator begin, EntityIterator end, RebuiltSpriteList& rebuilt)
+    {
+        for(auto it = begin; it != end; ++it)
         {
-            if(spriteInfoA.transparent)
+            // Get entity components.
+            RebuiltSprite entry;
+            entry.entity = it.GetEntity();
+            entry.render = &it.Get<Components::Render>();
+            entry.transform = &it.Get<Components::Transform>();
+
+            // Defer sprites that do not fit in the cache, as it cannot be resized here.
+            std::size_t cacheIndex = entry.entity.identifier - 1;
+
+            if(cacheIndex >= m_spriteCache.size())
             {
-                // Sort transparent by depth (back to front).
-                if(spriteDataA.transform[3][2] < spriteDataB.transform[3][2])
-                    return true;
+                rebuilt.push_back(entry);
+                continue;
+            }
 
-                if(spriteDataA.transform[3][2] == spriteDataB.transform[3][2])
-                {
-                    // Sort by the y position.
-                    if(spriteDataA.transform[3][1] > spriteDataB.transform[3][1])
-                        return true;
-
-                    if(spriteDataA.transform[3][1] == spriteDataB.transform[3][1])
-                    {
-                        // Sort by texture.
-                        if(spriteInfoA.texture < spriteInfoB.texture)
-                            return true;
-                    }
-                }
+            CachedSprite& sprite = m_spriteCache[cacheIndex];
+
+            // Rebuild the sprite if it belongs to a different entity, its components changed or its texture got uploaded.
+            if(sprite.entity != entry.entity || entry.render->IsChangedSince(lastVersion) || entry.transform->IsChangedSince(lastVersion) ||
+                (sprite.pending && !IsTexturePending(*entry.render)))
+            {
+                this->BuildSprite(sprite, entry);
+                rebuilt.push_back(entry);
+            }
+
+            if(sprite.pending)
+            {
+                pendingSprites.store(true, std::memory_order_relaxed);
+            }
+
+            // Mark the sprite as present in this update.
+            sprite.version = m_version;
+        }
+    };
+
+    // Grow the sprite cache up front, so fewer sprites have to be deferred.
+    if(m_spriteCache.size() < entities.GetMaximumCount())
+    {
+        m_spriteCache.resize(entities.GetMaximumCount());
+    }
+
+    // Gather sprites in parts of the view.
+    std::size_t partCount = entities.GetPartCount();
+
+    if(m_parallelGather && m_jobSystem != nullptr)
+    {
+        // Split parts into ranges of similar numbers of entities.
+        std::size_t entityCount = std::max<std::size_t>(entities.GetMaximumCount(), 1);
+        std::size_t grain = std::max<std::size_t>(partCount * SpriteGatherGrain / entityCount, 1);
+
+        m_rebuiltSprites.resize((partCount + grain - 1) / grain + 1);
+
+        m_jobSystem->ParallelFor(partCount, grain, [&](std::size_t begin, std::size_t end)
+        {
+            GatherSprites(entities.Begin(begin), entities.Begin(end), m_rebuiltSprites[begin / grain]);
+        });
+    }
+    else
+    {
+        m_rebuiltSprites.resize(1);
+
+        GatherSprites(entities.Begin(), entities.End(), m_rebuiltSprites[0]);
+    }
+
+    // Finish rebuilt sprites.
+    for(RebuiltSpriteList& rebuilt : m_rebuiltSprites)
+    {
+        for(const RebuiltSprite& entry : rebuilt)
+        {
+            std::size_t cacheIndex = entry.entity.identifier - 1;
+
+            if(cacheIndex >= m_spriteCache.size())
+            {
+                m_spriteCache.resize(cacheIndex + 1);
             }
-            else
+
+            CachedSprite& sprite = m_spriteCache[cacheIndex];
+
+            // Build sprites that have been deferred.
+            if(sprite.version != m_version)
             {
-                // Sort opaque by depth (front to back).
-                if(spriteDataA.transform[3][2] > spriteDataB.transform[3][2])
-                    return true;
+                this->BuildSprite(sprite, entry);
+                sprite.version = m_version;
 
-                if(spriteDataA.transform[3][2] == spriteDataB.transform[3][2])
+                if(sprite.pending)
                 {
-                    // Sort by texture.
-                    if(spriteInfoA.texture < spriteInfoB.texture)
-                        return true;
+                    pendingSprites.store(true, std::memory_order_relaxed);
                 }
             }
+
+            this->FinishSprite(sprite, entry);
         }
 
-        return false;
-    };
+        rebuilt.clear();
+    }
+
+    // Update again next draw if some textures are still pending.
+    m_pendingSprites = pendingSprites.load(std::memory_order_relaxed);
+}
+
+void RenderSystem::SetParallelGather(bool enabled)
+{
+    m_parallelGather = enabled;
+}
+
+void RenderSystem::BuildSprite(CachedSprite& sprite, const RebuiltSprite& entry) const
+{
+    const Components::Render* render = entry.render;
+    const Components::Transform* transform = entry.transform;
+
+    // Build the sprite with its original texture.
+    Graphics::BasicRenderer::Sprite::Info info;
+    info.texture = render->GetTexture().get();
+    info.transparent = render->IsTransparent();
+    info.filter = false;
+
+    // Draw the placeholder texture until the texture is uploaded.
+    bool pending = IsTexturePending(*render);
+
+    if(pending)
+    {
+        info.texture = m_placeholderTexture.get();
+    }
+
+    Graphics::BasicRenderer::Sprite::Data data;
+    data.position = glm::vec3(transform->GetPosition(), 0.0f);
+//  data.rotation = transform->GetRotation();
+    data.scale = transform->GetScale() * glm::vec2(RenderScale);
+    data.offset = render->GetOffset();
+    data.rectangle = glm::i16vec4(glm::round(render->GetRectangle()));
+    data.color = glm::packUnorm4x8(render->CalculateColor());
+
+    sprite.entity = entry.entity;
+    sprite.info = info;
+    sprite.data = data;
+    sprite.bounds = this->CalculateBounds(data);
+    sprite.pending = pending;
+}
+
+void RenderSystem::FinishSprite(CachedSprite& sprite, const RebuiltSprite& entry)
+{
+    // Use the texture atlas unless the rectangle samples outside of the texture.
+    const auto& texture = entry.render->GetTexture();
+
+    if(texture != nullptr && !sprite.pending && IsInsideTexture(glm::vec4(sprite.data.rectangle), *texture))
+    {
+        const auto& atlasEntry = m_textureAtlas.Add(texture);
 
-    // Create sort permutation.
-    Assert(m_spriteInfo.size() == m_spriteData.size());
+        sprite.info.texture = atlasEntry.texture;
+        sprite.data.rectangle.x += (int16_t)atlasEntry.offset.x;
+        sprite.data.rectangle.y += (int16_t)atlasEntry.offset.y;
+    }
 
-    m_spriteSort.resize(m_spriteInfo.size());
-    std::iota(m_spriteSort.begin(), m_spriteSort.end(), 0);
-    std::sort(m_spriteSort.begin(), m_spriteSort.end(), SpriteSort);
+    // Calculate the sort key.
+    sprite.sortKey = m_renderQueue->CalculateKey(Graphics::RenderQueue::Layers::World, sprite.info, sprite.data);
 
-    // Sort sprite lists.
-    Utility::Reorder(m_spriteInfo, m_spriteSort);
-    Utility::Reorder(m_spriteData, m_spriteSort);
+    // Move the sprite in the spatial grid.
+    m_spriteGrid.Update((uint32_t)(entry.entity.identifier - 1), sprite.bounds);
+}
 
-    // Draw sprites.
-    m_basicRenderer->DrawSprites(m_spriteInfo, m_spriteData, transform);
+glm::vec4 RenderSystem::CalculateBounds(const Graphics::BasicRenderer::Sprite::Data& data) const
+{
+    // Transform sprite corners the same way as the sprite shader does.
+    float rotationSin = std::sin(data.rotation);
+    float rotationCos = std::cos(data.rotation);
+
+    glm::vec2 size = glm::abs(glm::vec2(data.rectangle.z, data.rectangle.w));
+
+    glm::vec4 bounds(std::numeric_limits<float>::max(), std::numeric_limits<float>::max(),
+        -std::numeric_limits<float>::max(), -std::numeric_limits<float>::max());
+
+    for(int i = 0; i < 4; ++i)
+    {
+        glm::vec2 corner(i & 1 ? size.x : 0.0f, i & 2 ? size.y : 0.0f);
+        corner = (corner + data.offset) * data.scale;
+
+        glm::vec2 position;
+        position.x = corner.x * rotationCos + corner.y * rotationSin + data.position.x;
+        position.y = corner.y * rotationCos - corner.x * rotationSin + data.position.y;
+
+        bounds.x = std::min(bounds.x, position.x);
+        bounds.y = std::min(bounds.y, position.y);
+        bounds.z = std::max(bounds.z, position.x);
+        bounds.w = std::max(bounds.w, position.y);
+    }
 
-    // Clear the sprite list.
-    m_spriteInfo.clear();
-    m_spriteData.clear();
+    return bounds;
 }
@@ -3,6 +3,11 @@
 #include "Precompiled.hpp"
 #include "Graphics/ScreenSpace.hpp"
 #include "Graphics/BasicRenderer.hpp"
+#include "Graphics/RenderQueue.hpp"
+#include "Graphics/TextureAtlas.hpp"
+#include "Game/Component.hpp"
+#include "Game/SpatialGrid.hpp"
+#include "Game/TileMapRenderer.hpp"
 
 // Forward declarations.
 struct Context;
@@ -10,6 +15,8 @@ struct Context;
 namespace System
 {
     class Window;
+    class JobSystem;
+    class ResourceManager;
 }
 
 //
@@ -17,20 +24,81 @@ namespace System
 //
 //  Draws the game world on the screen.
 //
+//  Sprites are cached per entity and rebuilt only when their render
+//  or transform components change, as most of them are static.
+//
+//  Visible sprites are pushed to the world layer of the render queue,
+//  which sorts them by 64-bit keys and draws them along with sprites of
+//  other producers. Keys are calculated when sprites are rebuilt. Depth
+//  and position in keys are the upper bits of floats, so nearly equal
+//  values may end up sorted by texture instead.
+//
+//  Textures of sprites are packed into a texture atlas, so sprites
+//  from different sprite sheets can be drawn in the same batch.
+//  The atlas is used only with the OpenGL backend of the basic renderer.
+//
+//  The window is optional, so frames can be drawn without one using
+//  the recording backend. A fixed frame size is used in such case.
+//
+//  Cached sprites are indexed by a spatial grid that is updated when they
+//  are rebuilt. Only sprites in grid cells overlapping the view are sorted
+//  and drawn. Sprites of entities that lost their components are removed
+//  from the grid once they are found in the view.
+//
+//  With a job system, parts of the component view are gathered in parallel.
+//  Workers check cached sprites and rebuild changed ones into the cache,
+//  while the texture atlas, sort keys and the spatial grid are updated for
+//  rebuilt sprites afterwards on the calling thread.
+//
+//  Sprites with pending textures are drawn with the default texture of the
+//  resource manager and rebuilt once their textures have been uploaded.
+//
+//  The component view is not gathered at all when no render or transform
+//  component has been created, changed or removed since the last update
+//  and no sprite waits for its texture.
+//
+//  Tile maps are queued as static batches by the tile map renderer
+//  in the background layer behind sprites (see TileMapRenderer).
+//
 
 namespace Game
 {
     // Forward declarations.
     class ComponentSystem;
 
+    namespace Components
+    {
+        class Render;
+        class Transform;
+    }
+
     // Render system class.
     class RenderSystem
     {
     public:
-        // Type delcarations.
-        typedef std::vector<Graphics::BasicRenderer::Sprite::Info> SpriteInfoList;
-        typedef std::vector<Graphics::BasicRenderer::Sprite::Data> SpriteDataList;
-        typedef std::vector<std::size_t> SpriteSortList;
+        // Cached sprite structure.
+        struct CachedSprite
+        {
+            EntityHandle entity;
+            Graphics::BasicRenderer::Sprite::Info info;
+            Graphics::BasicRenderer::Sprite::Data data;
+            glm::vec4 bounds;
+            uint64_t sortKey;
+            ComponentVersion version;
+            bool pending;
+        };
+
+        typedef std::vector<CachedSprite> SpriteCacheList;
+
+        // Rebuilt sprite structure.
+        struct RebuiltSprite
+        {
+            EntityHandle entity;
+            const Components::Render* render;
+            const Components::Transform* transform;
+        };
+
+        typedef std::vector<RebuiltSprite> RebuiltSpriteList;
 
     public:
         RenderSystem();
@@ -45,19 +113,59 @@ namespace Game
         // Draws the scene.
         void Draw();
 
+        // Sets parallel gathering of sprites.
+        void SetParallelGather(bool enabled);
+
+    private:
+        // Builds a cached sprite from entity components.
+        void BuildSprite(CachedSprite& sprite, const RebuiltSprite& entry) const;
+
+        // Rebuilds cached sprites of changed entities.
+        void UpdateSprites();
+
+        // Finishes a rebuilt sprite.
+        void FinishSprite(CachedSprite& sprite, const RebuiltSprite& entry);
+
+        // Calculates the bounds of a sprite.
+        glm::vec4 CalculateBounds(const Graphics::BasicRenderer::Sprite::Data& data) const;
+
     private:
         // Context references.
         System::Window*          m_window;
         Graphics::BasicRenderer* m_basicRenderer;
+        Graphics::RenderQueue*   m_renderQueue;
         ComponentSystem*         m_componentSystem;
+        System::JobSystem*       m_jobSystem;
+        System::ResourceManager* m_resourceManager;
+
+        // Texture drawn in place of pending textures.
+        std::shared_ptr<const Graphics::Texture> m_placeholderTexture;
 
         // Screen space transform.
         Graphics::ScreenSpace m_screenSpace;
 
-        // Sprite drawing lists.
-        SpriteInfoList m_spriteInfo;
-        SpriteDataList m_spriteData;
-        SpriteSortList m_spriteSort;
+        // Texture atlas of sprite textures.
+        Graphics::TextureAtlas m_textureAtlas;
+
+        // Renderer of tile maps.
+        TileMapRenderer m_tileMapRenderer;
+
+        // Sprites cached by entity identifiers.
+        SpriteCacheList m_spriteCache;
+
+        // Sprites rebuilt in each part of the gather.
+        std::vector<RebuiltSpriteList> m_rebuiltSprites;
+        bool m_parallelGather;
+
+        // Spatial index of cached sprites.
+        SpatialGrid m_spriteGrid;
+        SpatialGrid::ItemList m_visibleSprites;
+
+        // Component version of the last sprite update.
+        ComponentVersion m_version;
+
+        // Whether cached sprites wait for their textures.
+        bool m_pendingSprites;
 
         // Initialization state.
         bool m_initialized;
@@ -96,16 +96,15 @@ void ScriptSystem::Update(float timeDelta)
     m_state->CollectGarbage(0.002f);
 
     // Update all script components.
-    auto componentsBegin = m_componentSystem->Begin<Components::Script>();
-    auto componentsEnd = m_componentSystem->End<Components::Script>();
+    auto scripts = m_componentSystem->View<Components::Script>();
 
-    for(auto it = componentsBegin; it != componentsEnd; ++it)
+    for(auto it = scripts.Begin(); it != scripts.End(); ++it)
     {
-        const EntityHandle& entity = it->first;
-        Components::Script& script = it->second;
+        const EntityHandle& entity = it.GetEntity();
+        Components::Script& script = it.Get<Components::Script>();
 
         // Check if entity is active.
-        if(!m_entitySystem->IsHandleValid(it->first))
+        if(!m_entitySystem->IsHandleValid(entity))
             continue;
 
         // Update script component.
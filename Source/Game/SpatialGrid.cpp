@@ -0,0 +1,276 @@
+#include "Precompiled.hpp"
+#include "SpatialGrid.hpp"
+using namespace Game;
+
+namespace
+{
+    // Log error messages.
+    #define LogInitializeError() "Failed to initialize a spatial grid! "
+
+    // Creates a cell key from its coordinates.
+    uint64_t GetCellKey(int x, int y)
+    {
+        return ((uint64_t)(uint32_t)x << 32) | (uint64_t)(uint32_t)y;
+    }
+}
+
+const int SpatialGrid::MaxItemCells;
+const int SpatialGrid::MaxCellCoordinate;
+
+SpatialGrid::SpatialGrid() :
+    m_cellSize(0.0f),
+    m_query(0),
+    m_initialized(false)
+{
+}
+
+SpatialGrid::~SpatialGrid()
+{
+    this->Cleanup();
+}
+
+void SpatialGrid::Cleanup()
+{
+    if(!m_initialized)
+        return;
+
+    // Clear cells and items.
+    Utility::ClearContainer(m_cells);
+    Utility::ClearContainer(m_items);
+    Utility::ClearContainer(m_oversized);
+
+    m_cellSize = 0.0f;
+    m_query = 0;
+
+    // Reset initialization state.
+    m_initialized = false;
+}
+
+bool SpatialGrid::Initialize(float cellSize)
+{
+    this->Cleanup();
+
+    // Validate arguments.
+    if(cellSize <= 0.0f)
+    {
+        Log() << LogInitializeError() << "Invalid argument - \"cellSize\" is invalid.";
+        return false;
+    }
+
+    m_cellSize = cellSize;
+
+    // Success!
+    return m_initialized = true;
+}
+
+void SpatialGrid::Update(uint32_t item, const glm::vec4& bounds)
+{
+    if(!m_initialized)
+        return;
+
+    // Make sure the item list can hold the item.
+    if(item >= m_items.size())
+    {
+        Item empty;
+        empty.cells = glm::ivec4(0);
+        empty.query = 0;
+        empty.active = false;
+
+        m_items.resize(item + 1, empty);
+    }
+
+    Item& entry = m_items[item];
+
+    // Remove items with bounds that are not a number.
+    if(glm::any(glm::isnan(bounds)))
+    {
+        this->Remove(item);
+        return;
+    }
+
+    // Calculate overlapping cells.
+    glm::ivec4 cells = this->CalculateCells(bounds);
+
+    if(entry.active)
+    {
+        // Item has not moved to different cells.
+        if(entry.cells == cells)
+            return;
+
+        this->RemoveCells(item, entry.cells);
+    }
+
+    // Add the item to new cells.
+    this->InsertCells(item, cells);
+
+    entry.cells = cells;
+    entry.active = true;
+}
+
+void SpatialGrid::Remove(uint32_t item)
+{
+    if(!this->Contains(item))
+        return;
+
+    // Remove the item from its cells.
+    Item& entry = m_items[item];
+
+    this->RemoveCells(item, entry.cells);
+
+    entry.active = false;
+}
+
+void SpatialGrid::Query(const glm::vec4& bounds, ItemList& items)
+{
+    if(!m_initialized)
+        return;
+
+    // Start a new query.
+    // Items are marked with the query number, so they are returned only once.
+    if(++m_query == 0)
+    {
+        for(Item& entry : m_items)
+        {
+            entry.query = 0;
+        }
+
+        m_query = 1;
+    }
+
+    // Skip bounds that are not a number.
+    if(glm::any(glm::isnan(bounds)))
+        return;
+
+    // Add items that are not stored in cells.
+    this->QueryCell(m_oversized, items);
+
+    // Calculate overlapping cells.
+    glm::ivec4 cells = this->CalculateCells(bounds);
+
+    uint64_t cellCount = (uint64_t)((int64_t)cells.z - cells.x + 1) * (uint64_t)((int64_t)cells.w - cells.y + 1);
+
+    if(cellCount > m_cells.size())
+    {
+        // Visit allocated cells when there are fewer of them than overlapping ones.
+        for(const auto& cell : m_cells)
+        {
+            int x = (int)(uint32_t)(cell.first >> 32);
+            int y = (int)(uint32_t)(cell.first & 0xFFFFFFFF);
+
+            if(x >= cells.x && x <= cells.z && y >= cells.y && y <= cells.w)
+            {
+                this->QueryCell(cell.second, items);
+            }
+        }
+    }
+    else
+    {
+        // Visit overlapping cells.
+        for(int y = cells.y; y <= cells.w; ++y)
+        {
+            for(int x = cells.x; x <= cells.z; ++x)
+            {
+                auto it = m_cells.find(GetCellKey(x, y));
+
+                if(it != m_cells.end())
+                {
+                    this->QueryCell(it->second, items);
+                }
+            }
+        }
+    }
+}
+
+bool SpatialGrid::Contains(uint32_t item) const
+{
+    if(item >= m_items.size())
+        return false;
+
+    return m_items[item].active;
+}
+
+glm::ivec4 SpatialGrid::CalculateCells(const glm::vec4& bounds) const
+{
+    Assert(!glm::any(glm::isnan(bounds)));
+
+    // Clamp coordinates before casting, as infinite and huge values do not fit.
+    glm::vec4 cells = glm::floor(bounds / m_cellSize);
+    cells = glm::clamp(cells, glm::vec4((float)-MaxCellCoordinate), glm::vec4((float)MaxCellCoordinate));
+
+    return glm::ivec4(cells);
+}
+
+bool SpatialGrid::IsOversized(const glm::ivec4& cells) const
+{
+    int64_t cellCount = ((int64_t)cells.z - cells.x + 1) * ((int64_t)cells.w - cells.y + 1);
+
+    return cellCount > MaxItemCells;
+}
+
+void SpatialGrid::InsertCells(uint32_t item, const glm::ivec4& cells)
+{
+    if(this->IsOversized(cells))
+    {
+        m_oversized.push_back(item);
+        return;
+    }
+
+    for(int y = cells.y; y <= cells.w; ++y)
+    {
+        for(int x = cells.x; x <= cells.z; ++x)
+        {
+            m_cells[GetCellKey(x, y)].push_back(item);
+        }
+    }
+}
+
+void SpatialGrid::RemoveCells(uint32_t item, const glm::ivec4& cells)
+{
+    if(this->IsOversized(cells))
+    {
+        auto position = std::find(m_oversized.begin(), m_oversized.end(), item);
+        Assert(position != m_oversized.end());
+
+        *position = m_oversized.back();
+        m_oversized.pop_back();
+        return;
+    }
+
+    for(int y = cells.y; y <= cells.w; ++y)
+    {
+        for(int x = cells.x; x <= cells.z; ++x)
+        {
+            auto it = m_cells.find(GetCellKey(x, y));
+            Assert(it != m_cells.end());
+
+            // Swap the item with the last one and remove it.
+            ItemList& cell = it->second;
+
+            auto position = std::find(cell.begin(), cell.end(), item);
+            Assert(position != cell.end());
+
+            *position = cell.back();
+            cell.pop_back();
+
+            // Release empty cells.
+            if(cell.empty())
+            {
+                m_cells.erase(it);
+            }
+        }
+    }
+}
+
+void SpatialGrid::QueryCell(const ItemList& cell, ItemList& items)
+{
+    for(uint32_t item : cell)
+    {
+        Item& entry = m_items[item];
+
+        if(entry.query != m_query)
+        {
+            entry.query = m_query;
+            items.push_back(item);
+        }
+    }
+}
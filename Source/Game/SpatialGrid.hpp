@@ -0,0 +1,108 @@
+#pragma once
+
+#include "Precompiled.hpp"
+
+//
+// Spatial Grid
+//
+//  Uniform grid that indexes items by their bounds, so items
+//  in a region can be found without visiting all of them.
+//
+//  Example usage:
+//      Game::SpatialGrid grid;
+//      grid.Initialize(8.0f);
+//
+//      grid.Update(item, glm::vec4(left, bottom, right, top));
+//
+//      std::vector<uint32_t> items;
+//      grid.Query(glm::vec4(left, bottom, right, top), items);
+//
+//  Items are small integer identifiers that index an internal list.
+//  Only cells that contain items are allocated. Query returns each item
+//  in overlapping cells once, which may include items slightly outside
+//  of the queried region.
+//
+//  Items that overlap too many cells, including ones with infinite bounds,
+//  are kept in a separate list that is returned by every query instead.
+//  Cell coordinates are clamped, so huge bounds do not overflow them.
+//  Items with bounds that are not a number are removed from the grid.
+//
+
+namespace Game
+{
+    // Spatial grid class.
+    class SpatialGrid
+    {
+    public:
+        // Type declarations.
+        typedef std::vector<uint32_t> ItemList;
+        typedef std::unordered_map<uint64_t, ItemList> CellList;
+
+        // Constant variables.
+        static const int MaxItemCells = 256;
+        static const int MaxCellCoordinate = 1 << 30;
+
+    public:
+        SpatialGrid();
+        ~SpatialGrid();
+
+        // Restores instance to it's original state.
+        void Cleanup();
+
+        // Initializes the spatial grid.
+        bool Initialize(float cellSize);
+
+        // Inserts an item or moves it to new bounds.
+        // Bounds are a [left, bottom, right, top] vector.
+        // Items with bounds that are not a number are removed.
+        void Update(uint32_t item, const glm::vec4& bounds);
+
+        // Removes an item.
+        void Remove(uint32_t item);
+
+        // Finds items in cells overlapping the bounds.
+        void Query(const glm::vec4& bounds, ItemList& items);
+
+        // Checks if an item is in the grid.
+        bool Contains(uint32_t item) const;
+
+    private:
+        // Item structure.
+        struct Item
+        {
+            glm::ivec4 cells;
+            uint32_t query;
+            bool active;
+        };
+
+        // Calculates the range of cells overlapping the bounds.
+        glm::ivec4 CalculateCells(const glm::vec4& bounds) const;
+
+        // Checks if a range of cells is too large to insert an item in.
+        bool IsOversized(const glm::ivec4& cells) const;
+
+        // Adds or removes an item from cells.
+        void InsertCells(uint32_t item, const glm::ivec4& cells);
+        void RemoveCells(uint32_t item, const glm::ivec4& cells);
+
+        // Adds items of a cell to the query result.
+        void QueryCell(const ItemList& cell, ItemList& items);
+
+    private:
+        // Grid cells.
+        CellList m_cells;
+        float m_cellSize;
+
+        // Items that are not stored in cells.
+        ItemList m_oversized;
+
+        // Grid items.
+        std::vector<Item> m_items;
+
+        // Current query number.
+        uint32_t m_query;
+
+        // Initialization state.
+        bool m_initialized;
+    };
+}
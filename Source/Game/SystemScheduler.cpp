@@ -0,0 +1,161 @@
+#include "Precompiled.hpp"
+#include "SystemScheduler.hpp"
+#include "Context.hpp"
+using namespace Game;
+
+namespace
+{
+    // Log error messages.
+    #define LogInitializeError() "Failed to initialize the system scheduler! "
+
+    // Checks if two access lists share a type.
+    bool IsOverlapping(const SystemScheduler::AccessList& first, const SystemScheduler::AccessList& second)
+    {
+        for(const auto& type : first)
+        {
+            if(std::find(second.begin(), second.end(), type) != second.end())
+                return true;
+        }
+
+        return false;
+    }
+}
+
+SystemScheduler::SystemScheduler() :
+    m_jobSystem(nullptr),
+    m_initialized(false)
+{
+}
+
+SystemScheduler::~SystemScheduler()
+{
+    this->Cleanup();
+}
+
+void SystemScheduler::Cleanup()
+{
+    if(!m_initialized)
+        return;
+
+    // Reset context references.
+    m_jobSystem = nullptr;
+
+    // Remove all systems.
+    Utility::ClearContainer(m_systems);
+    Utility::ClearContainer(m_jobs);
+
+    // Reset initialization state.
+    m_initialized = false;
+}
+
+bool SystemScheduler::Initialize(Context& context)
+{
+    Assert(context.systemScheduler == nullptr);
+
+    // Cleanup this instance.
+    this->Cleanup();
+
+    // Setup a cleanup guard.
+    SCOPE_GUARD
+    (
+        if(!m_initialized)
+        {
+            m_initialized = true;
+            this->Cleanup();
+        }
+    );
+
+    // Get the job system.
+    if(context.jobSystem == nullptr)
+    {
+        Log() << LogInitializeError() << "Context is missing JobSystem instance.";
+        return false;
+    }
+
+    m_jobSystem = context.jobSystem;
+
+    // Set context instance.
+    context.systemScheduler = this;
+
+    // Success!
+    return m_initialized = true;
+}
+
+bool SystemScheduler::AddSystem(const SystemInfo& info)
+{
+    if(!m_initialized)
+        return false;
+
+    // Validate arguments.
+    if(!info.function)
+        return false;
+
+    // Find earlier systems that this system has to wait for.
+    SystemEntry entry;
+    entry.info = info;
+
+    for(std::size_t i = 0; i < m_systems.size(); ++i)
+    {
+        if(IsConflicting(m_systems[i].info, info))
+        {
+            entry.dependencies.push_back(i);
+        }
+    }
+
+    // Add the system to the list.
+    m_systems.push_back(std::move(entry));
+
+    return true;
+}
+
+void SystemScheduler::Execute(float timeDelta)
+{
+    if(!m_initialized)
+        return;
+
+    // Schedule a job for each system.
+    m_jobs.clear();
+    m_jobs.reserve(m_systems.size());
+
+    JobList dependencies;
+
+    for(const auto& system : m_systems)
+    {
+        dependencies.clear();
+
+        for(std::size_t index : system.dependencies)
+        {
+            dependencies.push_back(m_jobs[index]);
+        }
+
+        const SystemFunction& function = system.info.function;
+
+        auto job = m_jobSystem->Schedule([&function, timeDelta]()
+        {
+            function(timeDelta);
+        }, dependencies, system.info.mainThread);
+
+        m_jobs.push_back(std::move(job));
+    }
+
+    // Wait for all systems to finish.
+    for(const auto& job : m_jobs)
+    {
+        m_jobSystem->Wait(job);
+    }
+}
+
+bool SystemScheduler::IsConflicting(const SystemInfo& first, const SystemInfo& second)
+{
+    // Systems conflict when one of them writes a type the other accesses.
+    if(IsOverlapping(first.writes, second.writes))
+        return true;
+
+    if(IsOverlapping(first.writes, second.reads))
+        return true;
+
+    if(IsOverlapping(first.reads, second.writes))
+        return true;
+
+    return false;
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "Precompiled.hpp"
+#include "System/JobSystem.hpp"
+
+// Forward declarations.
+struct Context;
+
+//
+// System Scheduler
+//
+//  Runs game systems as jobs ordered by the types of data they access.
+//  A system that writes a type runs after systems added before it that
+//  read or write the same type, while systems that do not share written
+//  types run concurrently. Systems can split their own work further with
+//  the parallel for of the job system.
+//
+//  Adding a system:
+//      Game::SystemScheduler::SystemInfo info;
+//      info.name = "Render";
+//      info.reads = Game::SystemScheduler::Access<Components::Transform, Components::Render>();
+//      info.mainThread = true;
+//      info.function = [&](float timeDelta) { /* ... */ };
+//
+//      scheduler.AddSystem(info);
+//
+//  Running all systems for a frame:
+//      scheduler.Execute(timeDelta);
+//
+
+namespace Game
+{
+    // System scheduler class.
+    class SystemScheduler
+    {
+    public:
+        // Type declarations.
+        typedef std::vector<std::type_index>      AccessList;
+        typedef std::function<void(float)>        SystemFunction;
+        typedef System::JobSystem::JobList        JobList;
+
+        // System info structure.
+        struct SystemInfo
+        {
+            SystemInfo() :
+                mainThread(false)
+            {
+            }
+
+            // Name of the system.
+            std::string name;
+
+            // Types accessed by the system.
+            AccessList reads;
+            AccessList writes;
+
+            // Main thread affinity.
+            bool mainThread;
+
+            // Update function.
+            SystemFunction function;
+        };
+
+        // System entry structure.
+        struct SystemEntry
+        {
+            SystemInfo info;
+            std::vector<std::size_t> dependencies;
+        };
+
+        typedef std::vector<SystemEntry> SystemList;
+
+    public:
+        SystemScheduler();
+        ~SystemScheduler();
+
+        // Restores instance to it's original state.
+        void Cleanup();
+
+        // Initializes the system scheduler.
+        bool Initialize(Context& context);
+
+        // Adds a system.
+        bool AddSystem(const SystemInfo& info);
+
+        // Runs all systems and waits for them to finish.
+        void Execute(float timeDelta);
+
+        // Creates a list of accessed types.
+        template<typename... Types>
+        static AccessList Access();
+
+    private:
+        // Checks if two systems cannot run at the same time.
+        static bool IsConflicting(const SystemInfo& first, const SystemInfo& second);
+
+    private:
+        // Context references.
+        System::JobSystem* m_jobSystem;
+
+        // List of systems.
+        SystemList m_systems;
+
+        // Jobs of the current frame.
+        JobList m_jobs;
+
+        // Initialization state.
+        bool m_initialized;
+    };
+
+    // Template definitions.
+    template<typename... Types>
+    SystemScheduler::AccessList SystemScheduler::Access()
+    {
+        return AccessList({ std::type_index(typeid(Types))... });
+    }
+}
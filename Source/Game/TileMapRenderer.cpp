@@ -0,0 +1,257 @@
+#include "Precompiled.hpp"
+#include "TileMapRenderer.hpp"
+#include "ComponentSystem.hpp"
+#include "Components/Transform.hpp"
+#include "Components/TileMap.hpp"
+#include "Graphics/SpriteSheet.hpp"
+#include "Graphics/Texture.hpp"
+#include "Graphics/RenderQueue.hpp"
+#include "Context.hpp"
+using namespace Game;
+
+namespace
+{
+    // Checks if two [left, bottom, right, top] bounds overlap.
+    bool IsOverlapping(const glm::vec4& a, const glm::vec4& b)
+    {
+        return a.x <= b.z && b.x <= a.z && a.y <= b.w && b.y <= a.w;
+    }
+}
+
+TileMapRenderer::TileMapRenderer() :
+    m_basicRenderer(nullptr),
+    m_renderQueue(nullptr),
+    m_componentSystem(nullptr),
+    m_version(0),
+    m_initialized(false)
+{
+}
+
+TileMapRenderer::~TileMapRenderer()
+{
+    this->Cleanup();
+}
+
+void TileMapRenderer::Cleanup()
+{
+    if(!m_initialized)
+        return;
+
+    // Reset context references.
+    m_basicRenderer = nullptr;
+    m_renderQueue = nullptr;
+    m_componentSystem = nullptr;
+
+    // Release cached tile maps.
+    Utility::ClearContainer(m_tileMaps);
+    Utility::ClearContainer(m_drawList);
+    Utility::ClearContainer(m_instances);
+    m_version = 0;
+
+    // Reset initialization state.
+    m_initialized = false;
+}
+
+bool TileMapRenderer::Initialize(Context& context)
+{
+    Assert(context.basicRenderer != nullptr);
+    Assert(context.renderQueue != nullptr);
+    Assert(context.componentSystem != nullptr);
+
+    // Cleanup this instance.
+    this->Cleanup();
+
+    // Get required context instances.
+    m_basicRenderer = context.basicRenderer;
+    m_renderQueue = context.renderQueue;
+    m_componentSystem = context.componentSystem;
+
+    // Success!
+    return m_initialized = true;
+}
+
+void TileMapRenderer::Draw(const glm::mat4& transform, const glm::vec4& viewBounds)
+{
+    if(!m_initialized)
+        return;
+
+    // Rebuild tile maps only when a tile map or transform has changed since the last draw.
+    if(m_componentSystem->IsChangedSince<Components::TileMap>(m_version) ||
+        m_componentSystem->IsChangedSince<Components::Transform>(m_version))
+    {
+        this->RebuildTileMaps();
+    }
+
+    // Remove tile maps of entities that no longer have required components.
+    // Tile maps with pending textures are kept, but not drawn.
+    for(auto it = m_tileMaps.begin(); it != m_tileMaps.end();)
+    {
+        const CachedTileMap& cached = it->second;
+
+        if(cached.version != m_version)
+        {
+            it = m_tileMaps.erase(it);
+            continue;
+        }
+
+        if(cached.info.texture != nullptr && !cached.info.texture->IsPending())
+        {
+            m_drawList.push_back(&cached);
+        }
+
+        ++it;
+    }
+
+    // Sort tile maps by their draw orders.
+    std::sort(m_drawList.begin(), m_drawList.end(), [](const CachedTileMap* a, const CachedTileMap* b)
+    {
+        if(a->drawOrder != b->drawOrder)
+            return a->drawOrder < b->drawOrder;
+
+        return a->entity.identifier < b->entity.identifier;
+    });
+
+    // Push chunks in the view in the order of their tile maps.
+    for(std::size_t order = 0; order < m_drawList.size(); ++order)
+    {
+        const CachedTileMap* cached = m_drawList[order];
+
+        uint64_t key = m_renderQueue->CalculateOrderKey(Graphics::RenderQueue::Layers::Background, (uint32_t)order, cached->info);
+
+        for(const CachedChunk& chunk : cached->chunks)
+        {
+            if(chunk.batch == nullptr || chunk.batch->GetCount() == 0)
+                continue;
+
+            if(!IsOverlapping(chunk.bounds, viewBounds))
+                continue;
+
+            m_renderQueue->PushStaticBatch(key, cached->info, *chunk.batch);
+        }
+    }
+
+    m_drawList.clear();
+
+    m_renderQueue->SetTransform(Graphics::RenderQueue::Layers::Background, transform);
+}
+
+void TileMapRenderer::RebuildTileMaps()
+{
+    Assert(m_initialized);
+
+    // Start tracking changes made after this draw.
+    ComponentVersion lastVersion = m_version;
+    m_version = AdvanceComponentVersion();
+
+    // Rebuild changed tile maps.
+    auto entities = m_componentSystem->View<Components::TileMap, Components::Transform>();
+
+    for(auto it = entities.Begin(); it != entities.End(); ++it)
+    {
+        const Components::TileMap& tileMap = it.Get<Components::TileMap>();
+        const Components::Transform& entityTransform = it.Get<Components::Transform>();
+
+        // Get the cached tile map.
+        auto result = m_tileMaps.emplace(it.GetEntity(), CachedTileMap());
+        CachedTileMap& cached = result.first->second;
+
+        // Mark the tile map as present in this draw.
+        cached.version = m_version;
+
+        // Rebuild all chunks if the map is new, moved or resized.
+        bool rebuildAll = result.second || entityTransform.IsChangedSince(lastVersion) ||
+            cached.chunkCountX != tileMap.GetChunkCountX() || cached.chunkCountY != tileMap.GetChunkCountY();
+
+        if(!rebuildAll && !tileMap.IsChangedSince(lastVersion))
+            continue;
+
+        // Update parameters of the whole map.
+        const auto& spriteSheet = tileMap.GetSpriteSheet();
+
+        cached.entity = it.GetEntity();
+        cached.info.texture = spriteSheet != nullptr ? spriteSheet->GetTexture().get() : nullptr;
+        cached.info.transparent = tileMap.IsTransparent();
+        cached.info.filter = false;
+        cached.drawOrder = tileMap.GetDrawOrder();
+
+        if(rebuildAll)
+        {
+            cached.chunkCountX = tileMap.GetChunkCountX();
+            cached.chunkCountY = tileMap.GetChunkCountY();
+            cached.chunks.resize(cached.chunkCountX * cached.chunkCountY);
+        }
+
+        // Rebuild changed chunks.
+        for(int chunkY = 0; chunkY < cached.chunkCountY; ++chunkY)
+        {
+            for(int chunkX = 0; chunkX < cached.chunkCountX; ++chunkX)
+            {
+                if(rebuildAll || tileMap.IsChunkChangedSince(chunkX, chunkY, lastVersion))
+                {
+                    CachedChunk& chunk = cached.chunks[chunkY * cached.chunkCountX + chunkX];
+                    this->BuildChunk(chunk, tileMap, entityTransform, chunkX, chunkY);
+                }
+            }
+        }
+    }
+}
+
+void TileMapRenderer::BuildChunk(CachedChunk& chunk, const Components::TileMap& tileMap, const Components::Transform& transform, int chunkX, int chunkY)
+{
+    // Calculate the range of tiles in the chunk.
+    int beginX = chunkX * Components::TileMap::ChunkSize;
+    int beginY = chunkY * Components::TileMap::ChunkSize;
+    int endX = std::min(beginX + Components::TileMap::ChunkSize, tileMap.GetWidth());
+    int endY = std::min(beginY + Components::TileMap::ChunkSize, tileMap.GetHeight());
+
+    // Calculate the tile size in world units.
+    glm::vec2 tileSize = tileMap.GetTileSize() * transform.GetScale();
+    uint32_t color = glm::packUnorm4x8(tileMap.GetColor());
+
+    // Build sprite instances of tiles.
+    chunk.bounds = glm::vec4(std::numeric_limits<float>::max(), std::numeric_limits<float>::max(),
+        -std::numeric_limits<float>::max(), -std::numeric_limits<float>::max());
+
+    for(int y = beginY; y < endY; ++y)
+    {
+        for(int x = beginX; x < endX; ++x)
+        {
+            glm::i16vec4 rectangle = tileMap.GetTile(x, y);
+
+            if(rectangle.z == 0 || rectangle.w == 0)
+                continue;
+
+            // Scale the sprite to fill its tile.
+            Graphics::BasicRenderer::Sprite::Data data;
+            data.position = glm::vec3(transform.GetPosition() + glm::vec2(x, y) * tileSize, 0.0f);
+            data.scale = tileSize / glm::abs(glm::vec2(rectangle.z, rectangle.w));
+            data.rectangle = rectangle;
+            data.color = color;
+
+            m_instances.push_back(data);
+
+            // Extend the chunk bounds.
+            glm::vec2 first(data.position);
+            glm::vec2 second = first + tileSize;
+
+            chunk.bounds.x = std::min(chunk.bounds.x, std::min(first.x, second.x));
+            chunk.bounds.y = std::min(chunk.bounds.y, std::min(first.y, second.y));
+            chunk.bounds.z = std::max(chunk.bounds.z, std::max(first.x, second.x));
+            chunk.bounds.w = std::max(chunk.bounds.w, std::max(first.y, second.y));
+        }
+    }
+
+    // Create the batch once the chunk has tiles.
+    if(chunk.batch == nullptr && !m_instances.empty())
+    {
+        chunk.batch = m_basicRenderer->CreateStaticBatch();
+    }
+
+    // Upload instances to the batch.
+    if(chunk.batch != nullptr)
+    {
+        m_basicRenderer->UpdateStaticBatch(*chunk.batch, m_instances);
+    }
+
+    m_instances.clear();
+}
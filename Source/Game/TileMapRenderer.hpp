@@ -0,0 +1,119 @@
+#pragma once
+
+#include "Precompiled.hpp"
+#include "Graphics/BasicRenderer.hpp"
+#include "Game/Component.hpp"
+
+// Forward declarations.
+struct Context;
+
+namespace Graphics
+{
+    class RenderQueue;
+}
+
+//
+// Tile Map Renderer
+//
+//  Draws tile map components with static batches of the basic renderer.
+//
+//  Example usage:
+//      Game::TileMapRenderer tileMapRenderer;
+//      tileMapRenderer.Initialize(context);
+//
+//      tileMapRenderer.Draw(transform, viewBounds);
+//
+//  Each chunk of a tile map has its own static batch that is rebuilt
+//  only when tiles in the chunk change, while the transform of the entity
+//  or parameters of the whole map rebuild all its chunks. Unchanged maps
+//  cost only a check of their component versions, and when no tile map or
+//  transform component changed at all, the view is not iterated.
+//
+//  Chunks overlapping the view bounds are pushed to the background layer
+//  of the render queue, which draws them in a single draw call each behind
+//  world sprites, ordered by draw orders of their tile maps. Static batches
+//  of chunks stay valid until the render queue is submitted, which has to
+//  happen before the next draw. Maps with pending sprite sheet textures
+//  are skipped until uploaded.
+//
+
+namespace Game
+{
+    // Forward declarations.
+    class ComponentSystem;
+
+    namespace Components
+    {
+        class TileMap;
+        class Transform;
+    }
+
+    // Tile map renderer class.
+    class TileMapRenderer
+    {
+    public:
+        // Cached chunk structure.
+        struct CachedChunk
+        {
+            Graphics::BasicRenderer::StaticBatchPtr batch;
+            glm::vec4 bounds;
+        };
+
+        typedef std::vector<CachedChunk> ChunkCacheList;
+
+        // Cached tile map structure.
+        struct CachedTileMap
+        {
+            EntityHandle entity;
+            Graphics::BasicRenderer::Sprite::Info info;
+            ChunkCacheList chunks;
+            int chunkCountX;
+            int chunkCountY;
+            int drawOrder;
+            ComponentVersion version;
+        };
+
+        typedef std::unordered_map<EntityHandle, CachedTileMap> TileMapCacheList;
+        typedef std::vector<const CachedTileMap*> TileMapDrawList;
+
+    public:
+        TileMapRenderer();
+        ~TileMapRenderer();
+
+        // Restores instance to it's original state.
+        void Cleanup();
+
+        // Initializes the tile map renderer.
+        bool Initialize(Context& context);
+
+        // Rebuilds changed chunks and pushes chunks in the view to the render queue.
+        // View bounds are in [left, bottom, right, top] world coordinates.
+        void Draw(const glm::mat4& transform, const glm::vec4& viewBounds);
+
+    private:
+        // Rebuilds tile maps changed since the last rebuild.
+        void RebuildTileMaps();
+
+        // Builds a chunk from tiles.
+        void BuildChunk(CachedChunk& chunk, const Components::TileMap& tileMap, const Components::Transform& transform, int chunkX, int chunkY);
+
+    private:
+        // Context references.
+        Graphics::BasicRenderer* m_basicRenderer;
+        Graphics::RenderQueue*   m_renderQueue;
+        ComponentSystem*         m_componentSystem;
+
+        // Tile maps cached by entity handles.
+        TileMapCacheList m_tileMaps;
+        TileMapDrawList m_drawList;
+
+        // Instances of a rebuilt chunk.
+        Graphics::BasicRenderer::SpriteDataList m_instances;
+
+        // Component version of the last draw.
+        ComponentVersion m_version;
+
+        // Initialization state.
+        bool m_initialized;
+    };
+}
@@ -0,0 +1,757 @@
+#include "Precompiled.hpp"
+#include "WorldSnapshot.hpp"
+#include "EntitySystem.hpp"
+#include "ComponentSystem.hpp"
+#include "IdentitySystem.hpp"
+#include "Components/Transform.hpp"
+#include "Components/Render.hpp"
+#include "System/ResourceManager.hpp"
+#include "Graphics/Texture.hpp"
+#include "Context.hpp"
+using namespace Game;
+
+namespace
+{
+    // Log error messages.
+    #define LogSaveError(filename) "Failed to save a world snapshot to \"" << filename << "\" file! "
+    #define LogLoadError(filename) "Failed to load a world snapshot from \"" << filename << "\" file! "
+
+    // Snapshot file header.
+    struct HeaderRecord
+    {
+        uint32_t magic;
+        uint32_t version;
+    };
+
+    // Snapshot file records.
+    struct EntityRecord
+    {
+        int32_t identifier;
+        int32_t version;
+    };
+
+    struct NameRecord
+    {
+        uint32_t entity;
+        uint32_t name;
+    };
+
+    struct ComponentSectionRecord
+    {
+        uint32_t name;
+        uint32_t count;
+        uint32_t size;
+    };
+
+    // Records are written as they are in memory.
+    static_assert(sizeof(HeaderRecord) == 8, "Unexpected padding in snapshot records.");
+    static_assert(sizeof(EntityRecord) == 8, "Unexpected padding in snapshot records.");
+    static_assert(sizeof(NameRecord) == 8, "Unexpected padding in snapshot records.");
+    static_assert(sizeof(ComponentSectionRecord) == 12, "Unexpected padding in snapshot records.");
+
+    // Writes raw bytes to a buffer.
+    void WriteBytes(std::vector<char>& buffer, const void* data, std::size_t size)
+    {
+        const char* bytes = reinterpret_cast<const char*>(data);
+        buffer.insert(buffer.end(), bytes, bytes + size);
+    }
+
+    // Writes a value to a buffer.
+    template<typename Type>
+    void WriteValue(std::vector<char>& buffer, const Type& value)
+    {
+        WriteBytes(buffer, &value, sizeof(Type));
+    }
+
+    // Writes a counted array of records to a buffer.
+    template<typename Type>
+    void WriteArray(std::vector<char>& buffer, const std::vector<Type>& records)
+    {
+        WriteValue(buffer, (uint32_t)records.size());
+        WriteBytes(buffer, records.data(), records.size() * sizeof(Type));
+    }
+
+    // Reads raw bytes from a buffer.
+    bool ReadBytes(const std::vector<char>& buffer, std::size_t& offset, void* data, std::size_t size)
+    {
+        if(size > buffer.size() - offset)
+            return false;
+
+        memcpy(data, buffer.data() + offset, size);
+        offset += size;
+
+        return true;
+    }
+
+    // Reads a value from a buffer.
+    template<typename Type>
+    bool ReadValue(const std::vector<char>& buffer, std::size_t& offset, Type& value)
+    {
+        return ReadBytes(buffer, offset, &value, sizeof(Type));
+    }
+
+    // Reads a counted array of records from a buffer.
+    template<typename Type>
+    bool ReadArray(const std::vector<char>& buffer, std::size_t& offset, std::vector<Type>& records)
+    {
+        uint32_t count = 0;
+
+        if(!ReadValue(buffer, offset, count))
+            return false;
+
+        if(count > (buffer.size() - offset) / sizeof(Type))
+            return false;
+
+        records.resize(count);
+
+        return ReadBytes(buffer, offset, records.data(), count * sizeof(Type));
+    }
+
+    // Adds a string to a string table once and returns its index.
+    uint32_t AddString(WorldSnapshot::StringTable& table, const std::string& string)
+    {
+        auto result = table.lookup.emplace(string, (uint32_t)table.strings.size());
+
+        if(result.second)
+        {
+            table.strings.push_back(string);
+        }
+
+        return result.first->second;
+    }
+
+    // Writes components of a vector.
+    template<typename Vector>
+    void WriteVector(WorldSnapshot::Writer& writer, const Vector& vector)
+    {
+        for(std::size_t i = 0; i < sizeof(Vector) / sizeof(float); ++i)
+        {
+            writer.Write(vector[i]);
+        }
+    }
+
+    // Reads components of a vector.
+    template<typename Vector>
+    bool ReadVector(WorldSnapshot::Reader& reader, Vector& vector)
+    {
+        for(std::size_t i = 0; i < sizeof(Vector) / sizeof(float); ++i)
+        {
+            if(!reader.Read(vector[i]))
+                return false;
+        }
+
+        return true;
+    }
+}
+
+const uint32_t WorldSnapshot::Magic;
+const uint32_t WorldSnapshot::Version;
+
+WorldSnapshot::Writer::Writer(std::vector<char>& buffer, StringTable& strings) :
+    m_buffer(buffer),
+    m_strings(strings)
+{
+}
+
+void WorldSnapshot::Writer::WriteString(const std::string& string)
+{
+    this->Write(AddString(m_strings, string));
+}
+
+void WorldSnapshot::Writer::WriteEntity(const EntityHandle& entity)
+{
+    // Write the handle as it is saved in the entities section.
+    EntityRecord record;
+    record.identifier = entity.identifier;
+    record.version = entity.version;
+
+    this->Write(record);
+}
+
+void WorldSnapshot::Writer::WriteBytes(const void* data, std::size_t size)
+{
+    ::WriteBytes(m_buffer, data, size);
+}
+
+WorldSnapshot::Reader::Reader(const std::vector<char>& buffer, std::size_t offset, std::size_t end,
+    const std::vector<std::string>& strings, const EntityMap& entities) :
+    m_buffer(buffer),
+    m_offset(offset),
+    m_end(end),
+    m_strings(strings),
+    m_entities(entities)
+{
+    Assert(offset <= end && end <= buffer.size());
+}
+
+bool WorldSnapshot::Reader::ReadString(std::string& string)
+{
+    uint32_t index = 0;
+
+    if(!this->Read(index))
+        return false;
+
+    if(index >= m_strings.size())
+        return false;
+
+    string = m_strings[index];
+
+    return true;
+}
+
+bool WorldSnapshot::Reader::ReadEntity(EntityHandle& entity)
+{
+    EntityRecord record;
+
+    if(!this->Read(record))
+        return false;
+
+    // Map the saved handle to the loaded one.
+    EntityHandle saved;
+    saved.identifier = record.identifier;
+    saved.version = record.version;
+
+    auto it = m_entities.find(saved);
+
+    entity = it != m_entities.end() ? it->second : EntityHandle();
+
+    return true;
+}
+
+std::size_t WorldSnapshot::Reader::GetOffset() const
+{
+    return m_offset;
+}
+
+bool WorldSnapshot::Reader::ReadBytes(void* data, std::size_t size)
+{
+    if(size > m_end - m_offset)
+        return false;
+
+    memcpy(data, m_buffer.data() + m_offset, size);
+    m_offset += size;
+
+    return true;
+}
+
+WorldSnapshot::WorldSnapshot() :
+    m_entitySystem(nullptr),
+    m_componentSystem(nullptr),
+    m_identitySystem(nullptr),
+    m_resourceManager(nullptr),
+    m_initialized(false)
+{
+}
+
+WorldSnapshot::~WorldSnapshot()
+{
+    this->Cleanup();
+}
+
+void WorldSnapshot::Cleanup()
+{
+    if(!m_initialized)
+        return;
+
+    // Reset context references.
+    m_entitySystem = nullptr;
+    m_componentSystem = nullptr;
+    m_identitySystem = nullptr;
+    m_resourceManager = nullptr;
+
+    // Remove component serializers.
+    Utility::ClearContainer(m_serializers);
+
+    // Reset initialization state.
+    m_initialized = false;
+}
+
+bool WorldSnapshot::Initialize(Context& context)
+{
+    Assert(context.entitySystem != nullptr);
+    Assert(context.componentSystem != nullptr);
+
+    // Cleanup this instance.
+    this->Cleanup();
+
+    // Get required context instances.
+    m_entitySystem = context.entitySystem;
+    m_componentSystem = context.componentSystem;
+
+    // Get optional context instances.
+    // Names and textures are skipped without them.
+    m_identitySystem = context.identitySystem;
+    m_resourceManager = context.resourceManager;
+
+    // Success!
+    m_initialized = true;
+
+    // Register built-in component types.
+    this->RegisterComponents();
+
+    return true;
+}
+
+void WorldSnapshot::RegisterComponents()
+{
+    Assert(m_initialized);
+
+    // Register the transform component.
+    this->RegisterComponent<Components::Transform>("Transform",
+        [](const Components::Transform& transform, Writer& writer)
+        {
+            WriteVector(writer, transform.GetPosition());
+            WriteVector(writer, transform.GetScale());
+            writer.Write(transform.GetRotation());
+        },
+        [](Components::Transform& transform, Reader& reader) -> bool
+        {
+            glm::vec2 position;
+            glm::vec2 scale;
+            float rotation;
+
+            if(!ReadVector(reader, position) || !ReadVector(reader, scale) || !reader.Read(rotation))
+                return false;
+
+            transform.SetPosition(position);
+            transform.SetScale(scale);
+            transform.SetRotation(rotation);
+
+            return true;
+        }
+    );
+
+    // Register the render component.
+    System::ResourceManager* resourceManager = m_resourceManager;
+
+    this->RegisterComponent<Components::Render>("Render",
+        [](const Components::Render& render, Writer& writer)
+        {
+            // Textures are saved by their filenames.
+            const auto& texture = render.GetTexture();
+            writer.WriteString(texture != nullptr ? texture->GetFilename() : std::string());
+
+            // Rectangles of whole textures follow their size when loaded.
+            writer.Write((uint32_t)(render.IsWholeTexture() ? 1 : 0));
+            WriteVector(writer, render.GetRectangle());
+            WriteVector(writer, render.GetOffset());
+            WriteVector(writer, render.GetDiffuseColor());
+            WriteVector(writer, render.GetEmissiveColor());
+            writer.Write(render.GetEmissivePower());
+            writer.Write((uint32_t)(render.IsTransparent() ? 1 : 0));
+        },
+        [resourceManager](Components::Render& render, Reader& reader) -> bool
+        {
+            std::string filename;
+            uint32_t wholeTexture;
+            glm::vec4 rectangle;
+            glm::vec2 offset;
+            glm::vec4 diffuseColor;
+            glm::vec4 emissiveColor;
+            float emissivePower;
+            uint32_t transparent;
+
+            if(!reader.ReadString(filename) || !reader.Read(wholeTexture) ||
+                !ReadVector(reader, rectangle) || !ReadVector(reader, offset) ||
+                !ReadVector(reader, diffuseColor) || !ReadVector(reader, emissiveColor) ||
+                !reader.Read(emissivePower) || !reader.Read(transparent))
+            {
+                return false;
+            }
+
+            // Textures are cached by the resource manager.
+            Components::Render::TexturePtr texture;
+
+            if(!filename.empty() && resourceManager != nullptr)
+            {
+                texture = resourceManager->Load<Graphics::Texture>(filename);
+            }
+
+            if(wholeTexture != 0 && texture != nullptr)
+            {
+                render.SetTexture(texture);
+            }
+            else
+            {
+                render.SetTexture(texture, rectangle);
+            }
+
+            render.SetOffset(offset);
+            render.SetDiffuseColor(diffuseColor);
+            render.SetEmissiveColor(emissiveColor);
+            render.SetEmissivePower(emissivePower);
+            render.SetTransparent(transparent != 0);
+
+            return true;
+        }
+    );
+}
+
+void WorldSnapshot::AddSerializer(ComponentSerializer&& serializer)
+{
+    Assert(m_initialized);
+
+    // Replace a serializer registered under the same name.
+    for(ComponentSerializer& registered : m_serializers)
+    {
+        if(registered.name == serializer.name)
+        {
+            registered = std::move(serializer);
+            return;
+        }
+    }
+
+    m_serializers.push_back(std::move(serializer));
+}
+
+bool WorldSnapshot::Save(std::string filename)
+{
+    if(!m_initialized)
+        return false;
+
+    // Collect active entities.
+    std::vector<EntityHandle> entities;
+    m_entitySystem->GetActiveEntities(entities);
+
+    // Create entity and name records.
+    StringTable strings;
+
+    std::vector<EntityRecord> entityRecords;
+    std::vector<NameRecord> nameRecords;
+
+    entityRecords.reserve(entities.size());
+
+    for(uint32_t index = 0; index < (uint32_t)entities.size(); ++index)
+    {
+        const EntityHandle& entity = entities[index];
+
+        // Write the entity handle.
+        EntityRecord entityRecord;
+        entityRecord.identifier = entity.identifier;
+        entityRecord.version = entity.version;
+        entityRecords.push_back(entityRecord);
+
+        // Write the entity name.
+        if(m_identitySystem != nullptr)
+        {
+            std::string name = m_identitySystem->GetEntityName(entity);
+
+            if(!name.empty())
+            {
+                NameRecord nameRecord;
+                nameRecord.entity = index;
+                nameRecord.name = AddString(strings, name);
+                nameRecords.push_back(nameRecord);
+            }
+        }
+    }
+
+    // Write component sections of registered types.
+    std::vector<char> componentBuffer;
+    uint32_t sectionCount = 0;
+
+    for(const ComponentSerializer& serializer : m_serializers)
+    {
+        // Write components of a type after the section record.
+        std::size_t sectionOffset = componentBuffer.size();
+
+        ComponentSectionRecord section;
+        section.name = 0;
+        section.count = 0;
+        section.size = 0;
+        WriteValue(componentBuffer, section);
+
+        Writer writer(componentBuffer, strings);
+
+        for(uint32_t index = 0; index < (uint32_t)entities.size(); ++index)
+        {
+            if(!(m_componentSystem->GetComponentMask(entities[index]) & serializer.mask))
+                continue;
+
+            writer.Write(index);
+            serializer.save(entities[index], writer);
+
+            section.count += 1;
+        }
+
+        // Skip types without components.
+        if(section.count == 0)
+        {
+            componentBuffer.resize(sectionOffset);
+            continue;
+        }
+
+        // Fill in the section record.
+        section.name = AddString(strings, serializer.name);
+        section.size = (uint32_t)(componentBuffer.size() - sectionOffset - sizeof(section));
+        memcpy(componentBuffer.data() + sectionOffset, &section, sizeof(section));
+
+        sectionCount += 1;
+    }
+
+    // Write the snapshot to a buffer.
+    std::vector<char> buffer;
+
+    HeaderRecord header;
+    header.magic = Magic;
+    header.version = Version;
+    WriteValue(buffer, header);
+
+    WriteValue(buffer, (uint32_t)strings.strings.size());
+
+    for(const std::string& string : strings.strings)
+    {
+        WriteValue(buffer, (uint32_t)string.size());
+        WriteBytes(buffer, string.data(), string.size());
+    }
+
+    WriteArray(buffer, entityRecords);
+    WriteArray(buffer, nameRecords);
+
+    WriteValue(buffer, sectionCount);
+    WriteBytes(buffer, componentBuffer.data(), componentBuffer.size());
+
+    // Write the buffer to a file.
+    std::ofstream file(Build::GetWorkingDir() + filename, std::ios::binary);
+
+    if(!file.is_open())
+    {
+        Log() << LogSaveError(filename) << "Couldn't open the file.";
+        return false;
+    }
+
+    file.write(buffer.data(), buffer.size());
+
+    if(!file.good())
+    {
+        Log() << LogSaveError(filename) << "Couldn't write the file.";
+        return false;
+    }
+
+    return true;
+}
+
+bool WorldSnapshot::Load(std::string filename, std::vector<EntityHandle>* entities)
+{
+    if(!m_initialized)
+        return false;
+
+    // Read the whole file at once.
+    std::vector<char> buffer = Utility::GetBinaryFileContent(Build::GetWorkingDir() + filename);
+
+    if(buffer.empty())
+    {
+        Log() << LogLoadError(filename) << "Couldn't read the file.";
+        return false;
+    }
+
+    std::size_t offset = 0;
+
+    // Validate the header.
+    HeaderRecord header;
+
+    if(!ReadValue(buffer, offset, header) || header.magic != Magic)
+    {
+        Log() << LogLoadError(filename) << "Invalid file header.";
+        return false;
+    }
+
+    if(header.version != Version)
+    {
+        Log() << LogLoadError(filename) << "Unsupported version " << header.version << ".";
+        return false;
+    }
+
+    // Read the string table.
+    uint32_t stringCount = 0;
+
+    if(!ReadValue(buffer, offset, stringCount) || stringCount > (buffer.size() - offset) / sizeof(uint32_t))
+    {
+        Log() << LogLoadError(filename) << "Invalid string table.";
+        return false;
+    }
+
+    std::vector<std::string> strings(stringCount);
+
+    for(std::string& string : strings)
+    {
+        uint32_t length = 0;
+
+        if(!ReadValue(buffer, offset, length) || length > buffer.size() - offset)
+        {
+            Log() << LogLoadError(filename) << "Invalid string table.";
+            return false;
+        }
+
+        string.assign(buffer.data() + offset, length);
+        offset += length;
+    }
+
+    // Read entity and name records.
+    std::vector<EntityRecord> entityRecords;
+    std::vector<NameRecord> nameRecords;
+
+    if(!ReadArray(buffer, offset, entityRecords) ||
+        !ReadArray(buffer, offset, nameRecords))
+    {
+        Log() << LogLoadError(filename) << "Unexpected end of file.";
+        return false;
+    }
+
+    // Read component sections.
+    struct ComponentSection
+    {
+        const ComponentSerializer* serializer;
+        uint32_t count;
+        std::size_t offset;
+        std::size_t end;
+    };
+
+    std::vector<ComponentSection> sections;
+    uint32_t sectionCount = 0;
+
+    if(!ReadValue(buffer, offset, sectionCount))
+    {
+        Log() << LogLoadError(filename) << "Unexpected end of file.";
+        return false;
+    }
+
+    for(uint32_t i = 0; i < sectionCount; ++i)
+    {
+        ComponentSectionRecord record;
+
+        if(!ReadValue(buffer, offset, record) || record.size > buffer.size() - offset)
+        {
+            Log() << LogLoadError(filename) << "Unexpected end of file.";
+            return false;
+        }
+
+        if(record.name >= stringCount)
+        {
+            Log() << LogLoadError(filename) << "Invalid component section.";
+            return false;
+        }
+
+        // Find the serializer of the component type.
+        ComponentSection section;
+        section.serializer = nullptr;
+        section.count = record.count;
+        section.offset = offset;
+        section.end = offset + record.size;
+
+        for(const ComponentSerializer& serializer : m_serializers)
+        {
+            if(serializer.name == strings[record.name])
+            {
+                section.serializer = &serializer;
+                break;
+            }
+        }
+
+        offset = section.end;
+
+        // Skip components of unknown types.
+        if(section.serializer == nullptr)
+        {
+            Log() << "Skipped unknown \"" << strings[record.name] << "\" components in \"" << filename << "\" world snapshot.";
+            continue;
+        }
+
+        sections.push_back(section);
+    }
+
+    // Validate references before anything is created.
+    uint32_t entityCount = (uint32_t)entityRecords.size();
+
+    for(const NameRecord& record : nameRecords)
+    {
+        if(record.entity >= entityCount || record.name >= stringCount)
+        {
+            Log() << LogLoadError(filename) << "Invalid name record.";
+            return false;
+        }
+    }
+
+    // Map saved entity handles to their indices.
+    EntityMap entityMap;
+    entityMap.reserve(entityCount);
+
+    for(uint32_t index = 0; index < entityCount; ++index)
+    {
+        EntityHandle saved;
+        saved.identifier = entityRecords[index].identifier;
+        saved.version = entityRecords[index].version;
+
+        if(saved.identifier <= 0 || !entityMap.emplace(saved, EntityHandle()).second)
+        {
+            Log() << LogLoadError(filename) << "Invalid entity record.";
+            return false;
+        }
+    }
+
+    // Create entities.
+    std::vector<EntityHandle> handles;
+    handles.reserve(entityCount);
+
+    m_entitySystem->CreateEntities(entityCount, handles);
+
+    for(uint32_t index = 0; index < entityCount; ++index)
+    {
+        EntityHandle saved;
+        saved.identifier = entityRecords[index].identifier;
+        saved.version = entityRecords[index].version;
+
+        entityMap[saved] = handles[index];
+    }
+
+    // Destroy created entities if the load fails.
+    bool success = false;
+
+    SCOPE_GUARD_IF(!success,
+        m_entitySystem->DestroyEntities(handles)
+    );
+
+    // Set entity names.
+    if(m_identitySystem != nullptr)
+    {
+        for(const NameRecord& record : nameRecords)
+        {
+            m_identitySystem->SetEntityName(handles[record.entity], strings[record.name]);
+        }
+    }
+
+    // Create components of each section.
+    for(const ComponentSection& section : sections)
+    {
+        const ComponentSerializer& serializer = *section.serializer;
+
+        serializer.reserve(section.count);
+
+        Reader reader(buffer, section.offset, section.end, strings, entityMap);
+
+        for(uint32_t i = 0; i < section.count; ++i)
+        {
+            uint32_t index = 0;
+
+            if(!reader.Read(index) || index >= entityCount || !serializer.load(handles[index], reader))
+            {
+                Log() << LogLoadError(filename) << "Invalid \"" << serializer.name << "\" component record.";
+                return false;
+            }
+        }
+
+        if(reader.GetOffset() != section.end)
+        {
+            Log() << LogLoadError(filename) << "Invalid \"" << serializer.name << "\" component section.";
+            return false;
+        }
+    }
+
+    // Return created entities.
+    if(entities != nullptr)
+    {
+        entities->insert(entities->end(), handles.begin(), handles.end());
+    }
+
+    return success = true;
+}
@@ -0,0 +1,270 @@
+#pragma once
+
+#include "Precompiled.hpp"
+#include "EntityHandle.hpp"
+#include "ComponentSystem.hpp"
+
+// Forward declarations.
+struct Context;
+
+namespace System
+{
+    class ResourceManager;
+}
+
+//
+// World Snapshot
+//
+//  Saves and loads entities along with their names and components
+//  in a versioned binary format.
+//
+//  Example usage:
+//      Game::WorldSnapshot snapshot;
+//      snapshot.Initialize(context);
+//
+//      snapshot.Save("Data/Levels/Level.snapshot");
+//
+//      std::vector<EntityHandle> entities;
+//      snapshot.Load("Data/Levels/Level.snapshot", &entities);
+//      entitySystem.ProcessCommands();
+//
+//  Registering a component type:
+//      snapshot.RegisterComponent<Components::Class>("Class",
+//          [](const Components::Class& component, Game::WorldSnapshot::Writer& writer)
+//          {
+//              writer.Write(component.GetValue());
+//              writer.WriteEntity(component.GetTarget());
+//          },
+//          [](Components::Class& component, Game::WorldSnapshot::Reader& reader)
+//          {
+//              float value;
+//              EntityHandle target;
+//
+//              if(!reader.Read(value) || !reader.ReadEntity(target))
+//                  return false;
+//
+//              component.SetValue(value);
+//              component.SetTarget(target);
+//              return true;
+//          }
+//      );
+//
+//  Layout of a snapshot file:
+//      [Header][Strings][Entities][Names][Components]
+//
+//  Each section starts with the number of its elements. Components are
+//  stored in one section per registered type, which starts with the name
+//  of the type, the number of records and their size in bytes. Sections of
+//  unknown types are skipped. Entities are referenced by their index in the
+//  entities section and are given new handles when loaded. Saved handles are
+//  kept, so references to other entities read with ReadEntity() are mapped
+//  to their new handles. Strings are referenced by indices in the strings
+//  section. The whole file is read at once and components of each type are
+//  created in bulk. Entities created by a load that fails are destroyed.
+//
+//  Transform and render components are registered when initialized.
+//  Script components hold references to script instances and are not saved.
+//
+
+namespace Game
+{
+    // Forward declarations.
+    class EntitySystem;
+    class IdentitySystem;
+
+    // World snapshot class.
+    class WorldSnapshot
+    {
+    public:
+        // Constant variables.
+        static const uint32_t Magic = 0x504E5357; // "WSNP"
+        static const uint32_t Version = 3;
+
+        // String table structure.
+        struct StringTable
+        {
+            std::vector<std::string> strings;
+            std::unordered_map<std::string, uint32_t> lookup;
+        };
+
+        // Map of saved entity handles to loaded ones.
+        typedef std::unordered_map<EntityHandle, EntityHandle> EntityMap;
+
+        // Component record writer class.
+        class Writer
+        {
+        public:
+            Writer(std::vector<char>& buffer, StringTable& strings);
+
+            // Writes a value.
+            template<typename Type>
+            void Write(const Type& value);
+
+            // Writes a string.
+            void WriteString(const std::string& string);
+
+            // Writes a reference to an entity.
+            void WriteEntity(const EntityHandle& entity);
+
+        private:
+            // Writes raw bytes.
+            void WriteBytes(const void* data, std::size_t size);
+
+        private:
+            std::vector<char>& m_buffer;
+            StringTable& m_strings;
+        };
+
+        // Component record reader class.
+        class Reader
+        {
+        public:
+            Reader(const std::vector<char>& buffer, std::size_t offset, std::size_t end,
+                const std::vector<std::string>& strings, const EntityMap& entities);
+
+            // Reads a value.
+            template<typename Type>
+            bool Read(Type& value);
+
+            // Reads a string.
+            bool ReadString(std::string& string);
+
+            // Reads a reference to an entity.
+            // Entities that are not in the snapshot are read as invalid handles.
+            bool ReadEntity(EntityHandle& entity);
+
+            // Gets the current offset.
+            std::size_t GetOffset() const;
+
+        private:
+            // Reads raw bytes.
+            bool ReadBytes(void* data, std::size_t size);
+
+        private:
+            const std::vector<char>& m_buffer;
+            std::size_t m_offset;
+            std::size_t m_end;
+
+            const std::vector<std::string>& m_strings;
+            const EntityMap& m_entities;
+        };
+
+        // Component serializer structure.
+        struct ComponentSerializer
+        {
+            std::string name;
+            ComponentMask mask;
+            std::function<void(EntityHandle, Writer&)> save;
+            std::function<bool(EntityHandle, Reader&)> load;
+            std::function<void(std::size_t)> reserve;
+        };
+
+        typedef std::vector<ComponentSerializer> ComponentSerializerList;
+
+    public:
+        WorldSnapshot();
+        ~WorldSnapshot();
+
+        // Restores instance to it's original state.
+        void Cleanup();
+
+        // Initializes the world snapshot.
+        bool Initialize(Context& context);
+
+        // Registers a component type under an unique name.
+        template<typename Type>
+        void RegisterComponent(std::string name,
+            std::function<void(const Type&, Writer&)> save,
+            std::function<bool(Type&, Reader&)> load);
+
+        // Saves all active entities to a file.
+        bool Save(std::string filename);
+
+        // Loads entities from a file.
+        // Handles of created entities are returned in the optional list.
+        bool Load(std::string filename, std::vector<EntityHandle>* entities = nullptr);
+
+    private:
+        // Registers built-in component types.
+        void RegisterComponents();
+
+        // Adds a component serializer.
+        void AddSerializer(ComponentSerializer&& serializer);
+
+    private:
+        // Context references.
+        EntitySystem*            m_entitySystem;
+        ComponentSystem*         m_componentSystem;
+        IdentitySystem*          m_identitySystem;
+        System::ResourceManager* m_resourceManager;
+
+        // Registered component serializers.
+        ComponentSerializerList m_serializers;
+
+        // Initialization state.
+        bool m_initialized;
+    };
+
+    // Template definitions.
+    template<typename Type>
+    void WorldSnapshot::Writer::Write(const Type& value)
+    {
+        static_assert(std::is_trivially_copyable<Type>::value, "Not a trivially copyable type.");
+
+        this->WriteBytes(&value, sizeof(Type));
+    }
+
+    template<typename Type>
+    bool WorldSnapshot::Reader::Read(Type& value)
+    {
+        static_assert(std::is_trivially_copyable<Type>::value, "Not a trivially copyable type.");
+
+        return this->ReadBytes(&value, sizeof(Type));
+    }
+
+    template<typename Type>
+    void WorldSnapshot::RegisterComponent(std::string name,
+        std::function<void(const Type&, Writer&)> save,
+        std::function<bool(Type&, Reader&)> load)
+    {
+        if(!m_initialized)
+            return;
+
+        // Validate component type.
+        static_assert(std::is_base_of<Component, Type>::value, "Not a component type.");
+
+        Assert(save != nullptr && load != nullptr);
+
+        ComponentSystem* componentSystem = m_componentSystem;
+
+        // Wrap functions of the component type.
+        ComponentSerializer serializer;
+        serializer.name = std::move(name);
+        serializer.mask = GetComponentTypeMask<Type>();
+
+        serializer.save = [componentSystem, save](EntityHandle entity, Writer& writer)
+        {
+            const Type* component = componentSystem->Lookup<Type>(entity);
+            Assert(component != nullptr);
+
+            save(*component, writer);
+        };
+
+        serializer.load = [componentSystem, load](EntityHandle entity, Reader& reader) -> bool
+        {
+            Type* component = componentSystem->Create<Type>(entity);
+
+            if(component == nullptr)
+                return false;
+
+            return load(*component, reader);
+        };
+
+        serializer.reserve = [componentSystem](std::size_t count)
+        {
+            componentSystem->Reserve<Type>(count);
+        };
+
+        this->AddSerializer(std::move(serializer));
+    }
+}
@@ -1,7 +1,8 @@
 #include "Precompiled.hpp"
 #include "BasicRenderer.hpp"
-#include "System/ResourceManager.hpp"
-#include "Graphics/Texture.hpp"
+#include "OpenGLBackend.hpp"
+#include "RecordingBackend.hpp"
+#include "StateCache.hpp"
 #include "Context.hpp"
 using namespace Graphics;
 
@@ -9,13 +10,6 @@ namespace
 {
     // Log error messages.
     #define LogInitializeError() "Failed to initialize the basic renderer! "
-
-    // Vertex structure.
-    struct Vertex
-    {
-        glm::vec2 position;
-        glm::vec2 texture;
-    };
 }
 
 BasicRenderer::Sprite::Info::Info() :
@@ -36,13 +30,28 @@ bool BasicRenderer::Sprite::Info::operator!=(const Info& right) const
 }
 
 BasicRenderer::Sprite::Data::Data() :
-    transform(1.0f),
-    rectangle(0.0f, 0.0f, 1.0f, 1.0f),
-    color(1.0f, 1.0f, 1.0f, 1.0f)
+    position(0.0f, 0.0f, 0.0f),
+    rotation(0.0f),
+    scale(1.0f, 1.0f),
+    offset(0.0f, 0.0f),
+    rectangle(0, 0, 1, 1),
+    color(0xFFFFFFFF)
+{
+}
+
+BasicRenderer::Statistics::Statistics() :
+    drawCalls(0),
+    spritesDrawn(0),
+    largestBatch(0),
+    uploadedBytes(0),
+    stateChanges(0),
+    redundantStateChanges(0)
 {
 }
 
-BasicRenderer::BasicRenderer()
+BasicRenderer::BasicRenderer() :
+    m_backendType(Backend::OpenGL),
+    m_initialized(false)
 {
 }
 
@@ -56,22 +65,19 @@ void BasicRenderer::Cleanup()
     if(!m_initialized)
         return;
 
-    // Cleanup graphics objects.
-    m_vertexBuffer.Cleanup();
-    m_instanceBuffer.Cleanup();
-    m_vertexInput.Cleanup();
-    m_nearestSampler.Cleanup();
-    m_linearSampler.Cleanup();
+    // Release the render backend.
+    m_backend = nullptr;
+    m_backendType = Backend::OpenGL;
 
-    m_shader = nullptr;
+    // Reset drawing statistics.
+    m_statistics = Statistics();
 
     // Reset initialization state.
     m_initialized = false;
 }
 
-bool BasicRenderer::Initialize(Context& context)
+bool BasicRenderer::Initialize(Context& context, Backend::Type backend)
 {
-    Verify(context.resourceManager != nullptr);
     Verify(context.basicRenderer == nullptr);
 
     // Cleanup this instance.
@@ -87,68 +93,32 @@ bool BasicRenderer::Initialize(Context& context)
         }
     );
 
-    // Create a vertex buffer.
-    const Vertex vertices[4] =
-    {
-        // Sprite quad with flipped along y axis texture coordinates.
-        { glm::vec2(0.0f, 0.0f), glm::vec2(0.0f, 1.0f) }, // Bottom-Left
-        { glm::vec2(1.0f, 0.0f), glm::vec2(1.0f, 1.0f) }, // Bottom-Right
-        { glm::vec2(0.0f, 1.0f), glm::vec2(0.0f, 0.0f) }, // Top-Left
-        { glm::vec2(1.0f, 1.0f), glm::vec2(1.0f, 0.0f) }, // Top-Right
-    };
-
-    if(!m_vertexBuffer.Initialize(sizeof(Vertex), Utility::ArraySize(vertices), &vertices[0], GL_STATIC_DRAW))
+    // Create the render backend.
+    switch(backend)
     {
-        Log() << LogInitializeError() << "Couldn't create a vertex buffer.";
-        return false;
-    }
+    case Backend::OpenGL:
+        m_backend = std::make_unique<OpenGLBackend>();
+        break;
 
-    // Create an instance buffer.
-    if(!m_instanceBuffer.Initialize(sizeof(Sprite::Data), SpriteBatchSize, nullptr, GL_DYNAMIC_DRAW))
-    {
-        Log() << LogInitializeError() << "Couldn't create an instance buffer.";
-        return false;
-    }
+    case Backend::Recording:
+        m_backend = std::make_unique<RecordingBackend>();
+        break;
 
-    // Create a vertex input.
-    const VertexAttribute attributes[] =
-    {
-        { &m_vertexBuffer,   VertexAttributeTypes::Float2   }, // Position
-        { &m_vertexBuffer,   VertexAttributeTypes::Float2   }, // Texture
-        { &m_instanceBuffer, VertexAttributeTypes::Float4x4 }, // Transform
-        { &m_instanceBuffer, VertexAttributeTypes::Float4   }, // Rectangle
-        { &m_instanceBuffer, VertexAttributeTypes::Float4   }, // Color
-    };
-
-    if(!m_vertexInput.Initialize(Utility::ArraySize(attributes), &attributes[0]))
-    {
-        Log() << LogInitializeError() << "Couldn't create a vertex input.";
+    default:
+        Log() << LogInitializeError() << "Invalid argument - \"backend\" is invalid.";
         return false;
     }
 
-    // Create samplers.
-    if(!m_nearestSampler.Initialize() || !m_linearSampler.Initialize())
+    if(!m_backend->Initialize(context))
     {
-        Log() << LogInitializeError() << "Couldn't create samplers.";
-    }
-
-    m_nearestSampler.SetParameter(GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    m_nearestSampler.SetParameter(GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-
-    m_linearSampler.SetParameter(GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    m_linearSampler.SetParameter(GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-    // Load the shader.
-    m_shader = context.resourceManager->Load<Shader>("Data/Shaders/Sprite.glsl");
-
-    if(m_shader == nullptr)
-    {
-        Log() << LogInitializeError() << "Couldn't load the shader.";
+        Log() << LogInitializeError() << "Couldn't initialize the render backend.";
         return false;
     }
 
-    // Make sure we have a valid sprite batch size.
-    static_assert(SpriteBatchSize >= 1, "Invalid sprite batch size.");
+    m_backendType = backend;
+
+    // Make sure sprite data matches the vertex input layout.
+    static_assert(sizeof(Sprite::Data) == 44, "Unexpected sprite data size.");
 
     // Set context instance.
     context.basicRenderer = this;
@@ -157,19 +127,20 @@ bool BasicRenderer::Initialize(Context& context)
     return m_initialized = true;
 }
 
-void BasicRenderer::Clear(uint32_t flags)
+void BasicRenderer::SetViewport(int x, int y, int width, int height)
 {
     if(!m_initialized)
         return;
 
-    // Clear the frame buffer.
-    GLbitfield mask = GL_NONE;
+    m_backend->SetViewport(x, y, width, height);
+}
 
-    if(flags & ClearFlags::Color)   mask |= GL_COLOR_BUFFER_BIT;
-    if(flags & ClearFlags::Depth)   mask |= GL_DEPTH_BUFFER_BIT;
-    if(flags & ClearFlags::Stencil) mask |= GL_STENCIL_BUFFER_BIT;
+void BasicRenderer::Clear(uint32_t flags)
+{
+    if(!m_initialized)
+        return;
 
-    glClear(mask);
+    m_backend->Clear(flags);
 }
 
 void BasicRenderer::DrawSprite(const Sprite& sprite, const::glm::mat4& transform)
@@ -177,143 +148,140 @@ void BasicRenderer::DrawSprite(const Sprite& sprite, const::glm::mat4& transform
     if(!m_initialized)
         return;
 
-    // Bind the vertex input.
-    glBindVertexArray(m_vertexInput.GetHandle());
+    this->DrawBatches(&sprite.info, &sprite.data, 1, transform);
+}
 
-    SCOPE_GUARD
-    (
-        glBindVertexArray(0);
-    );
+void BasicRenderer::DrawSprites(const SpriteInfoList& spriteInfo, const SpriteDataList& spriteData, const glm::mat4& transform)
+{
+    if(!m_initialized)
+        return;
 
-    // Bind shader program.
-    glUseProgram(m_shader->GetHandle());
+    // Make sure both lists have the same size.
+    if(spriteInfo.size() != spriteData.size())
+        return;
 
-    SCOPE_GUARD
-    (
-        glUseProgram(0);
-    );
+    if(spriteInfo.empty())
+        return;
 
-    glUniformMatrix4fv(m_shader->GetUniform("viewTransform"), 1, GL_FALSE, glm::value_ptr(transform));
+    this->DrawBatches(&spriteInfo[0], &spriteData[0], (int)spriteInfo.size(), transform);
+}
 
-    // Setup transparency.
-    if(sprite.info.transparent)
-    {
-        // Enable alpha blending.
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+void BasicRenderer::DrawSprites(const Sprite::Info& info, const Sprite::Data* spriteData, int spriteCount, const glm::mat4& transform)
+{
+    if(!m_initialized)
+        return;
 
-        // Disable depth writing.
-        glDepthMask(GL_FALSE);
-    }
+    if(spriteData == nullptr || spriteCount <= 0)
+        return;
+
+    // Begin drawing sprites.
+    m_backend->BeginSprites(transform);
 
     SCOPE_GUARD
     (
-        if(sprite.info.transparent)
-        {
-            glDisable(GL_BLEND);
-            glDepthMask(GL_TRUE);
-        }
+        m_backend->EndSprites();
     );
 
-    // Setup texture.
-    if(sprite.info.texture != nullptr)
+    // Determine the maximum batch size.
+    int batchSizeLimit = spriteCount;
+
+    if(m_backend->GetBatchSizeLimit() > 0)
     {
-        // Calculate inversed texture size.
-        glm::vec2 textureInvSize;
-        textureInvSize.x = 1.0f / sprite.info.texture->GetWidth();
-        textureInvSize.y = 1.0f / sprite.info.texture->GetHeight();
+        batchSizeLimit = std::min(batchSizeLimit, m_backend->GetBatchSizeLimit());
+    }
 
-        glUniform2fv(m_shader->GetUniform("textureSizeInv"), 1, glm::value_ptr(textureInvSize));
+    // Set the shared sprite state once.
+    m_backend->SetSpriteState(info);
 
-        // Bind texture unit.
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, sprite.info.texture->GetHandle());
+    // Draw sprites in batches of the maximum size.
+    for(int spritesDrawn = 0; spritesDrawn < spriteCount; spritesDrawn += batchSizeLimit)
+    {
+        int spritesBatched = std::min(batchSizeLimit, spriteCount - spritesDrawn);
 
-        // Bind texture sampler.
-        if(sprite.info.filter)
+        if(m_backend->DrawSpriteInstances(&spriteData[spritesDrawn], spritesBatched))
         {
-            glBindSampler(0, m_linearSampler.GetHandle());
-        }
-        else
-        {
-            glBindSampler(0, m_nearestSampler.GetHandle());
+            // Update drawing statistics.
+            m_statistics.drawCalls += 1;
+            m_statistics.spritesDrawn += spritesBatched;
+            m_statistics.largestBatch = std::max(m_statistics.largestBatch, spritesBatched);
+            m_statistics.uploadedBytes += spritesBatched * sizeof(Sprite::Data);
         }
     }
+}
 
-    SCOPE_GUARD
-    (
-        if(sprite.info.texture != nullptr)
-        {
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, 0);
-        }
-    );
+BasicRenderer::StaticBatchPtr BasicRenderer::CreateStaticBatch()
+{
+    if(!m_initialized)
+        return nullptr;
 
-    glUniform1i(m_shader->GetUniform("textureDiffuse"), 0);
+    return m_backend->CreateStaticBatch();
+}
 
-    // Update the instance buffer with sprite data.
-    m_instanceBuffer.Update(&sprite.data, 1);
+bool BasicRenderer::UpdateStaticBatch(StaticSpriteBatch& batch, const SpriteDataList& spriteData)
+{
+    if(!m_initialized)
+        return false;
 
-    // Draw instanced sprite.
-    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, 1);
+    // Upload sprite instances.
+    const Sprite::Data* data = spriteData.empty() ? nullptr : &spriteData[0];
+
+    if(!m_backend->UpdateStaticBatch(batch, data, (int)spriteData.size()))
+        return false;
+
+    // Update drawing statistics.
+    m_statistics.uploadedBytes += spriteData.size() * sizeof(Sprite::Data);
+
+    return true;
 }
 
-void BasicRenderer::DrawSprites(const SpriteInfoList& spriteInfo, const SpriteDataList& spriteData, const glm::mat4& transform)
+void BasicRenderer::DrawStaticBatch(const Sprite::Info& info, const StaticSpriteBatch& batch, const glm::mat4& transform)
 {
     if(!m_initialized)
         return;
 
-    // Make sure both lists have the same size.
-    if(spriteInfo.size() != spriteData.size())
+    if(batch.GetCount() == 0)
         return;
 
-    const int spriteCount = spriteInfo.size();
-
-    // Bind the vertex input.
-    glBindVertexArray(m_vertexInput.GetHandle());
+    // Begin drawing sprites.
+    m_backend->BeginSprites(transform);
 
     SCOPE_GUARD
     (
-        glBindVertexArray(0);
+        m_backend->EndSprites();
     );
 
-    // Bind shader program.
-    glUseProgram(m_shader->GetHandle());
-
-    SCOPE_GUARD
-    (
-        glUseProgram(0);
-    );
+    // Draw the whole batch at once.
+    m_backend->SetSpriteState(info);
 
-    glUniformMatrix4fv(m_shader->GetUniform("viewTransform"), 1, GL_FALSE, glm::value_ptr(transform));
+    if(m_backend->DrawStaticBatch(batch))
+    {
+        // Update drawing statistics.
+        m_statistics.drawCalls += 1;
+        m_statistics.spritesDrawn += batch.GetCount();
+        m_statistics.largestBatch = std::max(m_statistics.largestBatch, batch.GetCount());
+    }
+}
 
-    // Current transparency state.
-    bool currentTransparent = false;
+void BasicRenderer::DrawBatches(const Sprite::Info* spriteInfo, const Sprite::Data* spriteData, int spriteCount, const glm::mat4& transform)
+{
+    // Begin drawing sprites.
+    m_backend->BeginSprites(transform);
 
     SCOPE_GUARD
     (
-        if(currentTransparent)
-        {
-            glDisable(GL_BLEND);
-            glDepthMask(GL_TRUE);
-        }
+        m_backend->EndSprites();
     );
 
-    // Current texture state.
-    const Texture* currentTexture = nullptr;
+    // Determine the maximum batch size.
+    int batchSizeLimit = spriteCount;
 
-    SCOPE_GUARD
-    (
-        if(currentTexture != nullptr)
-        {
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, 0);
-        }
-    );
-
-    glUniform1i(m_shader->GetUniform("textureDiffuse"), 0);
+    if(m_backend->GetBatchSizeLimit() > 0)
+    {
+        batchSizeLimit = std::min(batchSizeLimit, m_backend->GetBatchSizeLimit());
+    }
 
     // Render sprites.
+    const Sprite::Info* currentInfo = nullptr;
     int spritesDrawn = 0;
 
     while(spritesDrawn != spriteCount)
@@ -327,7 +295,7 @@ void BasicRenderer::DrawSprites(const SpriteInfoList& spriteInfo, const SpriteDa
         while(true)
         {
             // Check if we reached the maximum batch size.
-            if(spritesBatched == SpriteBatchSize)
+            if(spritesBatched == batchSizeLimit)
                 break;
 
             // Get the index of the next sprite.
@@ -345,73 +313,23 @@ void BasicRenderer::DrawSprites(const SpriteInfoList& spriteInfo, const SpriteDa
             ++spritesBatched;
         }
 
-        // Update the instance buffer with sprite data.
-        m_instanceBuffer.Update(&spriteData[spritesDrawn], spritesBatched);
-
-        // Set transparency state.
-        if(currentTransparent != info.transparent)
+        // Set sprite state if it differs from the previous batch.
+        if(currentInfo == nullptr || *currentInfo != info)
         {
-            if(info.transparent)
-            {
-                // Enable alpha blending.
-                glEnable(GL_BLEND);
-                glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-                // Disable depth writing.
-                glDepthMask(GL_FALSE);
-            }
-            else
-            {
-                // Disable alpha blending.
-                glDisable(GL_BLEND);
-
-                // Enable depth writing.
-                glDepthMask(GL_TRUE);
-            }
-
-            currentTransparent = info.transparent;
+            m_backend->SetSpriteState(info);
+            currentInfo = &info;
         }
 
-        // Set texture state.
-        if(currentTexture != info.texture)
+        // Draw instanced sprite batch.
+        if(m_backend->DrawSpriteInstances(&spriteData[spritesDrawn], spritesBatched))
         {
-            // Set texture uniform.
-            if(info.texture != nullptr)
-            {
-                // Calculate inversed texture size.
-                glm::vec2 textureInvSize;
-                textureInvSize.x = 1.0f / info.texture->GetWidth();
-                textureInvSize.y = 1.0f / info.texture->GetHeight();
-
-                glUniform2fv(m_shader->GetUniform("textureSizeInv"), 1, glm::value_ptr(textureInvSize));
-
-                // Bind texture unit.
-                glActiveTexture(GL_TEXTURE0);
-                glBindTexture(GL_TEXTURE_2D, info.texture->GetHandle());
-                
-                // Bind texture sampler.
-                if(info.filter)
-                {
-                    glBindSampler(0, m_linearSampler.GetHandle());
-                }
-                else
-                {
-                    glBindSampler(0, m_nearestSampler.GetHandle());
-                }
-            }
-            else
-            {
-                // Disable texture unit.
-                glActiveTexture(GL_TEXTURE0);
-                glBindTexture(GL_TEXTURE_2D, 0);
-            }
-
-            currentTexture = info.texture;
+            // Update drawing statistics.
+            m_statistics.drawCalls += 1;
+            m_statistics.spritesDrawn += spritesBatched;
+            m_statistics.largestBatch = std::max(m_statistics.largestBatch, spritesBatched);
+            m_statistics.uploadedBytes += spritesBatched * sizeof(Sprite::Data);
         }
 
-        // Draw instanced sprite batch.
-        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, spritesBatched);
-
         // Update the counter of drawn sprites.
         spritesDrawn += spritesBatched;
     }
@@ -422,7 +340,7 @@ void BasicRenderer::SetClearColor(const glm::vec4& color)
     if(!m_initialized)
         return;
 
-    glClearColor(color.r, color.g, color.b, color.a);
+    m_backend->SetClearColor(color);
 }
 
 void BasicRenderer::SetClearDepth(float depth)
@@ -430,7 +348,7 @@ void BasicRenderer::SetClearDepth(float depth)
     if(!m_initialized)
         return;
 
-    glClearDepth(depth);
+    m_backend->SetClearDepth(depth);
 }
 
 void BasicRenderer::SetClearStencil(int stencil)
@@ -438,5 +356,36 @@ void BasicRenderer::SetClearStencil(int stencil)
     if(!m_initialized)
         return;
 
-    glClearStencil(stencil);
+    m_backend->SetClearStencil(stencil);
+}
+
+void BasicRenderer::ResetStatistics()
+{
+    m_statistics = Statistics();
+
+    StateCache::ResetStatistics();
+}
+
+BasicRenderer::Statistics BasicRenderer::GetStatistics() const
+{
+    Statistics statistics = m_statistics;
+
+    // Add state changes made through the state cache.
+    if(m_backendType == Backend::OpenGL)
+    {
+        statistics.stateChanges = StateCache::GetStatistics().changes;
+        statistics.redundantStateChanges = StateCache::GetStatistics().redundant;
+    }
+
+    return statistics;
+}
+
+BasicRenderer::Backend::Type BasicRenderer::GetBackendType() const
+{
+    return m_backendType;
+}
+
+RenderBackend* BasicRenderer::GetBackend() const
+{
+    return m_backend.get();
 }
@@ -2,11 +2,7 @@
 
 #include "Precompiled.hpp"
 #include "ScreenSpace.hpp"
-#include "Buffer.hpp"
-#include "VertexInput.hpp"
-#include "Sampler.hpp"
 #include "Texture.hpp"
-#include "Shader.hpp"
 
 // Forward declarations.
 struct Context;
@@ -16,11 +12,58 @@ struct Context;
 //
 //  Handles basic drawing routines.
 //
+//  Consecutive sprites with the same info are drawn in a single batch,
+//  limited only by the batch size limit of the backend.
+//
+//  Batches are executed by a render backend chosen at initialization.
+//  The OpenGL backend draws with the current rendering context, while
+//  the recording backend only records commands (see RecordingBackend).
+//
+//  Sprite instances are 44 bytes and are transformed in the vertex shader.
+//  Position holds the depth in its z component. Rectangle is in texture
+//  pixels and color is packed as RGBA8 (see glm::packUnorm4x8).
+//
+//  Sprites that rarely change can be uploaded once to a static batch
+//  and drawn from it every frame without uploading them again.
+//
+//  Drawing a static batch:
+//      auto batch = basicRenderer.CreateStaticBatch();
+//      basicRenderer.UpdateStaticBatch(*batch, spriteData);
+//
+//      basicRenderer.DrawStaticBatch(info, *batch, transform);
+//
 
 namespace Graphics
 {
     // Forward declarations.
     class Texture;
+    class RenderBackend;
+
+    // Static sprite batch base class.
+    // Created by render backends that hold its instances.
+    class StaticSpriteBatch : private NonCopyable
+    {
+    protected:
+        StaticSpriteBatch() :
+            m_count(0)
+        {
+        }
+
+    public:
+        virtual ~StaticSpriteBatch()
+        {
+        }
+
+        // Gets the number of sprite instances.
+        int GetCount() const
+        {
+            return m_count;
+        }
+
+    protected:
+        // Number of sprite instances.
+        int m_count;
+    };
 
     // Clear flags.
     struct ClearFlags
@@ -58,20 +101,44 @@ namespace Graphics
             {
                 Data();
 
-                glm::mat4 transform;
-                glm::vec4 rectangle;
-                glm::vec4 color;
+                glm::vec3 position;
+                float rotation;
+                glm::vec2 scale;
+                glm::vec2 offset;
+                glm::i16vec4 rectangle;
+                uint32_t color;
             } data;
         };
 
+        // Drawing statistics structure.
+        struct Statistics
+        {
+            Statistics();
+
+            int drawCalls;
+            int spritesDrawn;
+            int largestBatch;
+            std::size_t uploadedBytes;
+            int stateChanges;
+            int redundantStateChanges;
+        };
+
+        // Render backend types.
+        struct Backend
+        {
+            enum Type
+            {
+                OpenGL,
+                Recording,
+            };
+        };
+
         // Type declarations.
-        typedef std::shared_ptr<const Shader> ShaderPtr;
+        typedef std::unique_ptr<RenderBackend> RenderBackendPtr;
+        typedef std::unique_ptr<StaticSpriteBatch> StaticBatchPtr;
         typedef std::vector<Sprite::Info> SpriteInfoList;
         typedef std::vector<Sprite::Data> SpriteDataList;
 
-        // Constant variables.
-        static const int SpriteBatchSize = 128;
-
     public:
         BasicRenderer();
         ~BasicRenderer();
@@ -80,7 +147,10 @@ namespace Graphics
         void Cleanup();
 
         // Initializes the basic renderer instance.
-        bool Initialize(Context& context);
+        bool Initialize(Context& context, Backend::Type backend = Backend::OpenGL);
+
+        // Sets the viewport.
+        void SetViewport(int x, int y, int width, int height);
 
         // Clears the frame buffer.
         void Clear(uint32_t flags = ClearFlags::All);
@@ -91,6 +161,18 @@ namespace Graphics
         // Draws sprites.
         void DrawSprites(const SpriteInfoList& spriteInfo, const SpriteDataList& spriteData, const glm::mat4& transform);
 
+        // Draws sprites that share the same info.
+        void DrawSprites(const Sprite::Info& info, const Sprite::Data* spriteData, int spriteCount, const glm::mat4& transform);
+
+        // Creates an empty static batch.
+        StaticBatchPtr CreateStaticBatch();
+
+        // Uploads sprites to a static batch.
+        bool UpdateStaticBatch(StaticSpriteBatch& batch, const SpriteDataList& spriteData);
+
+        // Draws sprites of a static batch.
+        void DrawStaticBatch(const Sprite::Info& info, const StaticSpriteBatch& batch, const glm::mat4& transform);
+
         // Sets the clear color.
         void SetClearColor(const glm::vec4& color);
 
@@ -100,14 +182,31 @@ namespace Graphics
         // Sets the stencil depth.
         void SetClearStencil(int stencil);
 
+        // Resets drawing statistics.
+        // Also resets statistics of the state cache.
+        void ResetStatistics();
+
+        // Gets drawing statistics since the last reset.
+        // State changes are counted by the state cache of the OpenGL backend.
+        Statistics GetStatistics() const;
+
+        // Gets the render backend type.
+        Backend::Type GetBackendType() const;
+
+        // Gets the render backend.
+        RenderBackend* GetBackend() const;
+
+    private:
+        // Draws batches of sprites.
+        void DrawBatches(const Sprite::Info* spriteInfo, const Sprite::Data* spriteData, int spriteCount, const glm::mat4& transform);
+
     private:
-        // Graphics objects.
-        VertexBuffer   m_vertexBuffer;
-        InstanceBuffer m_instanceBuffer;
-        VertexInput    m_vertexInput;
-        Sampler        m_nearestSampler;
-        Sampler        m_linearSampler;
-        ShaderPtr      m_shader;
+        // Render backend.
+        RenderBackendPtr m_backend;
+        Backend::Type m_backendType;
+
+        // Drawing statistics.
+        Statistics m_statistics;
         
         // Initialization state.
         bool m_initialized;
@@ -1,5 +1,6 @@
 #include "Precompiled.hpp"
 #include "Buffer.hpp"
+#include "StateCache.hpp"
 using namespace Graphics;
 
 namespace
@@ -17,6 +18,13 @@ Buffer::Buffer(GLenum type) :
     m_handle(InvalidHandle),
     m_elementSize(0),
     m_elementCount(0),
+    m_usage(GL_STATIC_DRAW),
+    m_streaming(false),
+    m_mapping(nullptr),
+    m_regionSize(0),
+    m_regionCount(0),
+    m_regionIndex(0),
+    m_regionOffset(0),
     m_initialized(false)
 {
 }
@@ -31,9 +39,23 @@ void Buffer::Cleanup()
     if(!m_initialized)
         return;
 
+    // Release region fences.
+    for(GLsync& fence : m_regionFences)
+    {
+        if(fence != nullptr)
+        {
+            glDeleteSync(fence);
+        }
+    }
+
+    Utility::ClearContainer(m_regionFences);
+
     // Release the buffer handle.
+    // Deleting the buffer also unmaps its memory.
     if(m_handle != InvalidHandle)
     {
+        StateCache::ForgetBuffer(m_handle);
+
         glDeleteBuffers(1, &m_handle);
         m_handle = InvalidHandle;
     }
@@ -41,6 +63,15 @@ void Buffer::Cleanup()
     // Reset buffer parameters.
     m_elementSize = 0;
     m_elementCount = 0;
+    m_usage = GL_STATIC_DRAW;
+
+    // Reset streaming state.
+    m_streaming = false;
+    m_mapping = nullptr;
+    m_regionSize = 0;
+    m_regionCount = 0;
+    m_regionIndex = 0;
+    m_regionOffset = 0;
 
     // Reset initialization state.
     m_initialized = false;
@@ -75,6 +106,7 @@ bool Buffer::Initialize(unsigned int elementSize, unsigned int elementCount, con
 
     m_elementSize = elementSize;
     m_elementCount = elementCount;
+    m_usage = usage;
 
     // Create a buffer.
     glGenBuffers(1, &m_handle);
@@ -88,9 +120,8 @@ bool Buffer::Initialize(unsigned int elementSize, unsigned int elementCount, con
     // Copy data to the buffer.
     unsigned int bufferSize = m_elementSize * m_elementCount;
 
-    glBindBuffer(m_type, m_handle);
+    StateCache::BindBuffer(m_type, m_handle);
     glBufferData(m_type, bufferSize, data, usage);
-    glBindBuffer(m_type, 0);
 
     // Success!
     Log() << "Created " << this->GetName() << " (" << bufferSize << " bytes).";
@@ -98,11 +129,96 @@ bool Buffer::Initialize(unsigned int elementSize, unsigned int elementCount, con
     return m_initialized = true;
 }
 
+bool Buffer::InitializeStreaming(unsigned int elementSize, unsigned int regionSize, unsigned int regionCount)
+{
+    this->Cleanup();
+
+    // Setup a cleanup guard.
+    SCOPE_GUARD
+    (
+        if(!m_initialized)
+        {
+            m_initialized = true;
+            this->Cleanup();
+        }
+    );
+
+    // Validate arguments.
+    if(elementSize == 0)
+    {
+        Log() << LogInitializeError() << "Invalid argument - \"elementSize\" is 0.";
+        return false;
+    }
+
+    if(regionSize == 0)
+    {
+        Log() << LogInitializeError() << "Invalid argument - \"regionSize\" is 0.";
+        return false;
+    }
+
+    if(regionCount < 2)
+    {
+        Log() << LogInitializeError() << "Invalid argument - \"regionCount\" is less than 2.";
+        return false;
+    }
+
+    m_elementSize = elementSize;
+    m_elementCount = regionSize * regionCount;
+    m_usage = GL_STREAM_DRAW;
+
+    m_streaming = true;
+    m_regionSize = regionSize;
+    m_regionCount = regionCount;
+    m_regionFences.resize(regionCount, nullptr);
+
+    // Create a buffer.
+    glGenBuffers(1, &m_handle);
+
+    if(m_handle == InvalidHandle)
+    {
+        Log() << LogInitializeError() << "Couldn't create a buffer.";
+        return false;
+    }
+
+    // Allocate buffer storage.
+    unsigned int bufferSize = m_elementSize * m_elementCount;
+
+    StateCache::BindBuffer(m_type, m_handle);
+
+    if(GLEW_ARB_buffer_storage)
+    {
+        // Map the whole buffer once for its entire lifetime.
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+        glBufferStorage(m_type, bufferSize, nullptr, flags);
+        m_mapping = glMapBufferRange(m_type, 0, bufferSize, flags);
+    }
+    else
+    {
+        glBufferData(m_type, bufferSize, nullptr, m_usage);
+    }
+
+    if(GLEW_ARB_buffer_storage && m_mapping == nullptr)
+    {
+        Log() << LogInitializeError() << "Couldn't map the buffer.";
+        return false;
+    }
+
+    // Success!
+    Log() << "Created " << this->GetName() << " (" << bufferSize << " bytes, " << m_regionCount << " streaming regions).";
+
+    return m_initialized = true;
+}
+
 void Buffer::Update(const void* data, int count)
 {
     if(!m_initialized)
         return;
 
+    // Streaming buffers can only be appended to.
+    if(m_streaming)
+        return;
+
     // Validate arguments.
     if(data == nullptr)
         return;
@@ -117,9 +233,173 @@ void Buffer::Update(const void* data, int count)
     }
 
     // Upload new buffer data.
-    glBindBuffer(m_type, m_handle);
+    StateCache::BindBuffer(m_type, m_handle);
+
+    if((unsigned int)count > m_elementCount)
+    {
+        // Recreate the storage with a bigger size.
+        m_elementCount = count;
+
+        glBufferData(m_type, m_elementSize * m_elementCount, data, m_usage);
+        return;
+    }
+
+    if(m_usage == GL_STREAM_DRAW)
+    {
+        // Orphan the previous storage, so we do not wait for draws that still use it.
+        glBufferData(m_type, m_elementSize * m_elementCount, nullptr, m_usage);
+    }
+
     glBufferSubData(m_type, 0, m_elementSize * count, data);
-    glBindBuffer(m_type, 0);
+}
+
+void* Buffer::Map(int count)
+{
+    if(!m_initialized)
+        return nullptr;
+
+    // Streaming buffers are mapped by regions.
+    if(m_streaming)
+        return nullptr;
+
+    if(count == 0)
+        return nullptr;
+
+    // Check if to map the whole buffer.
+    if(count < 0)
+    {
+        count = m_elementCount;
+    }
+
+    StateCache::BindBuffer(m_type, m_handle);
+
+    if((unsigned int)count > m_elementCount)
+    {
+        // Recreate the storage with a bigger size.
+        m_elementCount = count;
+
+        glBufferData(m_type, m_elementSize * m_elementCount, nullptr, m_usage);
+    }
+
+    // Invalidate the previous storage, so we do not wait for commands that still use it.
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT;
+
+    return glMapBufferRange(m_type, 0, m_elementSize * count, flags);
+}
+
+bool Buffer::Unmap()
+{
+    if(!m_initialized)
+        return false;
+
+    if(m_streaming)
+        return false;
+
+    StateCache::BindBuffer(m_type, m_handle);
+
+    return glUnmapBuffer(m_type) == GL_TRUE;
+}
+
+int Buffer::Stream(const void* data, int count)
+{
+    if(!m_initialized)
+        return -1;
+
+    if(!m_streaming)
+        return -1;
+
+    // Validate arguments.
+    if(data == nullptr)
+        return -1;
+
+    if(count <= 0 || count > (int)m_regionSize)
+        return -1;
+
+    // Move to the next region if the current one is full.
+    if(m_regionOffset + count > m_regionSize)
+    {
+        Assert(m_regionFences[m_regionIndex] == nullptr);
+
+        m_regionFences[m_regionIndex] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+        m_regionIndex = (m_regionIndex + 1) % m_regionCount;
+        m_regionOffset = 0;
+
+        this->WaitRegion(m_regionIndex);
+    }
+
+    // Write data after previously appended elements.
+    unsigned int element = m_regionIndex * m_regionSize + m_regionOffset;
+    unsigned int offset = element * m_elementSize;
+    unsigned int size = count * m_elementSize;
+
+    if(m_mapping != nullptr)
+    {
+        memcpy((char*)m_mapping + offset, data, size);
+    }
+    else
+    {
+        StateCache::BindBuffer(m_type, m_handle);
+
+        // Region is not used by the GPU, so the range can be mapped without synchronization.
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
+
+        void* memory = glMapBufferRange(m_type, offset, size, flags);
+
+        if(memory != nullptr)
+        {
+            memcpy(memory, data, size);
+            glUnmapBuffer(m_type);
+        }
+        else
+        {
+            glBufferSubData(m_type, offset, size, data);
+        }
+    }
+
+    m_regionOffset += count;
+
+    return (int)element;
+}
+
+void Buffer::WaitRegion(unsigned int index)
+{
+    Assert(index < m_regionFences.size());
+
+    GLsync& fence = m_regionFences[index];
+
+    if(fence == nullptr)
+        return;
+
+    if(m_mapping != nullptr)
+    {
+        // Wait for the GPU, as persistently mapped storage cannot be orphaned.
+        while(glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED);
+
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+    else if(glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+    {
+        // Orphan the whole buffer instead of waiting for the GPU.
+        StateCache::BindBuffer(m_type, m_handle);
+        glBufferData(m_type, m_elementSize * m_elementCount, nullptr, m_usage);
+
+        // New storage is not used by any region.
+        for(GLsync& regionFence : m_regionFences)
+        {
+            if(regionFence != nullptr)
+            {
+                glDeleteSync(regionFence);
+                regionFence = nullptr;
+            }
+        }
+    }
+    else
+    {
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
 }
 
 GLenum IndexBuffer::GetElementType() const
@@ -24,6 +24,19 @@
 //      Graphics::VertexBuffer vertexBuffer;
 //      vertexBuffer.Initialize(sizeof(Vertex), boost::size(vertices), &vertices[0]);
 //
+//  Streaming an instance buffer:
+//      Graphics::InstanceBuffer instanceBuffer;
+//      instanceBuffer.InitializeStreaming(sizeof(Instance), 4096, 4);
+//      
+//      int baseInstance = instanceBuffer.Stream(&instances[0], instances.size());
+//      glDrawArraysInstancedBaseInstance(GL_TRIANGLE_STRIP, 0, 4, instances.size(), baseInstance);
+//
+//  Streaming buffers are rings split into regions that are appended to
+//  without synchronizing with the driver. When the current region is full
+//  it gets fenced and the next one is used once the GPU is done with it.
+//  Buffers are persistently mapped if ARB_buffer_storage is supported,
+//  otherwise they are orphaned instead of waiting for the GPU.
+//
 
 namespace Graphics
 {
@@ -41,9 +54,25 @@ namespace Graphics
         // Initializes the buffer instance.
         bool Initialize(unsigned int elementSize, unsigned int elementCount, const void* data, GLenum usage = GL_STATIC_DRAW);
 
+        // Initializes the buffer instance as a streaming ring.
+        bool InitializeStreaming(unsigned int elementSize, unsigned int regionSize, unsigned int regionCount);
+
         // Updates the buffer data.
+        // Buffer grows if more elements than it can hold are uploaded.
         void Update(const void* data, int count = -1);
 
+        // Maps the buffer for writing, discarding its previous data.
+        // Buffer grows if more elements than it can hold are mapped.
+        void* Map(int count = -1);
+
+        // Unmaps the buffer after writing.
+        // Returns false if the written data got lost and has to be uploaded again.
+        bool Unmap();
+
+        // Appends data to a streaming buffer.
+        // Returns the index of the first element or -1 on failure.
+        int Stream(const void* data, int count);
+
         // Checks if the buffer is valid.
         bool IsValid() const
         {
@@ -80,6 +109,18 @@ namespace Graphics
             return GL_INVALID_ENUM;
         }
 
+        // Gets the number of elements in a streaming region.
+        unsigned int GetRegionSize() const
+        {
+            return m_regionSize;
+        }
+
+        // Checks if buffer is streamed.
+        bool IsStreaming() const
+        {
+            return m_streaming;
+        }
+
         // Checks if buffer is instanced.
         virtual bool IsInstanced() const
         {
@@ -89,6 +130,10 @@ namespace Graphics
         // Gets the buffer name.
         virtual const char* GetName() const = 0;
 
+    private:
+        // Waits until a streaming region is no longer used.
+        void WaitRegion(unsigned int index);
+
     protected:
         // Buffer handle.
         GLenum m_type;
@@ -97,6 +142,16 @@ namespace Graphics
         // Buffer parameters.
         unsigned int m_elementSize;
         unsigned int m_elementCount;
+        GLenum m_usage;
+
+        // Streaming state.
+        bool m_streaming;
+        void* m_mapping;
+        unsigned int m_regionSize;
+        unsigned int m_regionCount;
+        unsigned int m_regionIndex;
+        unsigned int m_regionOffset;
+        std::vector<GLsync> m_regionFences;
 
         // Initialization state.
         bool m_initialized;
@@ -172,3 +227,24 @@ namespace Graphics
         }
     };
 }
+
+//
+// Pixel Buffer
+//
+
+namespace Graphics
+{
+    class PixelBuffer : public Buffer
+    {
+    public:
+        PixelBuffer() :
+            Buffer(GL_PIXEL_UNPACK_BUFFER)
+        {
+        }
+
+        const char* GetName() const override
+        {
+            return "a pixel buffer";
+        }
+    };
+}
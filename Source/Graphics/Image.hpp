@@ -0,0 +1,95 @@
+#pragma once
+
+#include "Precompiled.hpp"
+
+//
+// Image
+//
+//  Holds pixels of an image in client memory.
+//  Can decode images from PNG files without making any graphics calls,
+//  so it can be used on worker threads and by offline tools.
+//
+//  Example usage:
+//      Graphics::Image image;
+//      image.Load("Path/To/File.png");
+//
+//      texture.Initialize(image.GetWidth(), image.GetHeight(), image.GetFormat(), image.GetData());
+//
+//  Rows of pixels are tightly packed and start from the top of the image.
+//
+
+namespace Graphics
+{
+    // Image class.
+    class Image
+    {
+    public:
+        Image();
+        ~Image();
+
+        // Restores instance to it's original state.
+        void Cleanup();
+
+        // Loads the image from a PNG file.
+        bool Load(std::string filename);
+
+        // Initializes an empty image.
+        bool Initialize(int width, int height, GLenum format);
+
+        // Gets the number of channels of a pixel format.
+        static int GetChannelCount(GLenum format);
+
+        // Gets the pixel data.
+        uint8_t* GetData()
+        {
+            return m_pixels.data();
+        }
+
+        const uint8_t* GetData() const
+        {
+            return m_pixels.data();
+        }
+
+        // Gets the size of the pixel data in bytes.
+        std::size_t GetSize() const
+        {
+            return m_pixels.size();
+        }
+
+        // Gets the image width.
+        int GetWidth() const
+        {
+            return m_width;
+        }
+
+        // Gets the image height.
+        int GetHeight() const
+        {
+            return m_height;
+        }
+
+        // Gets the pixel format.
+        GLenum GetFormat() const
+        {
+            return m_format;
+        }
+
+        // Checks if instance is valid.
+        bool IsValid() const
+        {
+            return m_initialized;
+        }
+
+    private:
+        // Image parameters.
+        int m_width;
+        int m_height;
+        GLenum m_format;
+
+        // Pixel data.
+        std::vector<uint8_t> m_pixels;
+
+        // Initialization state.
+        bool m_initialized;
+    };
+}
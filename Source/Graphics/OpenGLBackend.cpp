@@ -0,0 +1,415 @@
+#include "Precompiled.hpp"
+#include "OpenGLBackend.hpp"
+#include "System/ResourceManager.hpp"
+#include "Graphics/Texture.hpp"
+#include "Graphics/StateCache.hpp"
+#include "Context.hpp"
+using namespace Graphics;
+
+namespace
+{
+    // Log error messages.
+    #define LogInitializeError() "Failed to initialize the OpenGL backend! "
+
+    // Vertex structure.
+    struct Vertex
+    {
+        glm::vec2 position;
+        glm::vec2 texture;
+    };
+
+    // Static batch class.
+    class OpenGLStaticBatch : public StaticSpriteBatch
+    {
+    public:
+        // Sets the number of sprite instances.
+        void SetCount(int count)
+        {
+            m_count = count;
+        }
+
+    public:
+        // Graphics objects.
+        InstanceBuffer instanceBuffer;
+        VertexInput vertexInput;
+    };
+}
+
+const int OpenGLBackend::SpriteBufferSize;
+const int OpenGLBackend::SpriteRegionSize;
+const int OpenGLBackend::SpriteRegionCount;
+
+OpenGLBackend::OpenGLBackend() :
+    m_initialized(false)
+{
+}
+
+OpenGLBackend::~OpenGLBackend()
+{
+    this->Cleanup();
+}
+
+void OpenGLBackend::Cleanup()
+{
+    if(!m_initialized)
+        return;
+
+    // Cleanup graphics objects.
+    m_vertexBuffer.Cleanup();
+    m_instanceBuffer.Cleanup();
+    m_vertexInput.Cleanup();
+    m_nearestSampler.Cleanup();
+    m_linearSampler.Cleanup();
+
+    m_shader = nullptr;
+
+    m_viewTransform = Shader::UniformHandle<glm::mat4>();
+    m_textureSizeInv = Shader::UniformHandle<glm::vec2>();
+    m_textureDiffuse = Shader::UniformHandle<int>();
+
+    // Reset initialization state.
+    m_initialized = false;
+}
+
+bool OpenGLBackend::Initialize(Context& context)
+{
+    Verify(context.resourceManager != nullptr);
+
+    // Cleanup this instance.
+    this->Cleanup();
+
+    // Setup a cleanup guard.
+    SCOPE_GUARD
+    (
+        if(!m_initialized)
+        {
+            m_initialized = true;
+            this->Cleanup();
+        }
+    );
+
+    // Create a vertex buffer.
+    const Vertex vertices[4] =
+    {
+        // Sprite quad with flipped along y axis texture coordinates.
+        { glm::vec2(0.0f, 0.0f), glm::vec2(0.0f, 1.0f) }, // Bottom-Left
+        { glm::vec2(1.0f, 0.0f), glm::vec2(1.0f, 1.0f) }, // Bottom-Right
+        { glm::vec2(0.0f, 1.0f), glm::vec2(0.0f, 0.0f) }, // Top-Left
+        { glm::vec2(1.0f, 1.0f), glm::vec2(1.0f, 0.0f) }, // Top-Right
+    };
+
+    if(!m_vertexBuffer.Initialize(sizeof(Vertex), Utility::ArraySize(vertices), &vertices[0], GL_STATIC_DRAW))
+    {
+        Log() << LogInitializeError() << "Couldn't create a vertex buffer.";
+        return false;
+    }
+
+    // Create an instance buffer.
+    bool instanceBufferCreated = false;
+
+    if(GLEW_ARB_base_instance)
+    {
+        instanceBufferCreated = m_instanceBuffer.InitializeStreaming(sizeof(BasicRenderer::Sprite::Data), SpriteRegionSize, SpriteRegionCount);
+    }
+    else
+    {
+        instanceBufferCreated = m_instanceBuffer.Initialize(sizeof(BasicRenderer::Sprite::Data), SpriteBufferSize, nullptr, GL_STREAM_DRAW);
+    }
+
+    if(!instanceBufferCreated)
+    {
+        Log() << LogInitializeError() << "Couldn't create an instance buffer.";
+        return false;
+    }
+
+    // Create a vertex input.
+    if(!this->CreateSpriteInput(m_vertexInput, m_instanceBuffer))
+    {
+        Log() << LogInitializeError() << "Couldn't create a vertex input.";
+        return false;
+    }
+
+    // Create samplers.
+    if(!m_nearestSampler.Initialize() || !m_linearSampler.Initialize())
+    {
+        Log() << LogInitializeError() << "Couldn't create samplers.";
+    }
+
+    m_nearestSampler.SetParameter(GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    m_nearestSampler.SetParameter(GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    m_linearSampler.SetParameter(GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    m_linearSampler.SetParameter(GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    // Load the shader.
+    m_shader = context.resourceManager->Load<Shader>("Data/Shaders/Sprite.glsl");
+
+    if(m_shader == nullptr)
+    {
+        Log() << LogInitializeError() << "Couldn't load the shader.";
+        return false;
+    }
+
+    // Resolve shader uniform handles.
+    m_viewTransform = m_shader->GetUniformHandle<glm::mat4>("viewTransform");
+    m_textureSizeInv = m_shader->GetUniformHandle<glm::vec2>("textureSizeInv");
+    m_textureDiffuse = m_shader->GetUniformHandle<int>("textureDiffuse");
+
+    // Make sure we have valid sprite buffer sizes.
+    static_assert(SpriteBufferSize >= 1, "Invalid sprite buffer size.");
+    static_assert(SpriteRegionSize >= 1, "Invalid sprite region size.");
+
+    // Success!
+    return m_initialized = true;
+}
+
+void OpenGLBackend::SetViewport(int x, int y, int width, int height)
+{
+    if(!m_initialized)
+        return;
+
+    glViewport(x, y, width, height);
+}
+
+void OpenGLBackend::SetClearColor(const glm::vec4& color)
+{
+    if(!m_initialized)
+        return;
+
+    glClearColor(color.r, color.g, color.b, color.a);
+}
+
+void OpenGLBackend::SetClearDepth(float depth)
+{
+    if(!m_initialized)
+        return;
+
+    glClearDepth(depth);
+}
+
+void OpenGLBackend::SetClearStencil(int stencil)
+{
+    if(!m_initialized)
+        return;
+
+    glClearStencil(stencil);
+}
+
+void OpenGLBackend::Clear(uint32_t flags)
+{
+    if(!m_initialized)
+        return;
+
+    // Clear the frame buffer.
+    GLbitfield mask = GL_NONE;
+
+    if(flags & ClearFlags::Color)   mask |= GL_COLOR_BUFFER_BIT;
+    if(flags & ClearFlags::Depth)   mask |= GL_DEPTH_BUFFER_BIT;
+    if(flags & ClearFlags::Stencil) mask |= GL_STENCIL_BUFFER_BIT;
+
+    // Depth writing may have been left disabled by transparent sprites.
+    if(flags & ClearFlags::Depth)
+    {
+        StateCache::SetDepthMask(true);
+    }
+
+    glClear(mask);
+}
+
+void OpenGLBackend::BeginSprites(const glm::mat4& transform)
+{
+    if(!m_initialized)
+        return;
+
+    // Bind the vertex input.
+    StateCache::BindVertexArray(m_vertexInput.GetHandle());
+
+    // Bind shader program.
+    StateCache::BindProgram(m_shader->GetHandle());
+
+    m_shader->SetUniform(m_viewTransform, transform);
+    m_shader->SetUniform(m_textureDiffuse, 0);
+}
+
+void OpenGLBackend::SetSpriteState(const BasicRenderer::Sprite::Info& info)
+{
+    if(!m_initialized)
+        return;
+
+    // Set transparency state.
+    if(info.transparent)
+    {
+        // Enable alpha blending.
+        StateCache::SetBlend(true);
+        StateCache::SetBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+        // Disable depth writing.
+        StateCache::SetDepthMask(false);
+    }
+    else
+    {
+        // Disable alpha blending.
+        StateCache::SetBlend(false);
+
+        // Enable depth writing.
+        StateCache::SetDepthMask(true);
+    }
+
+    // Set texture state.
+    if(info.texture != nullptr)
+    {
+        // Calculate inversed texture size.
+        glm::vec2 textureInvSize;
+        textureInvSize.x = 1.0f / info.texture->GetWidth();
+        textureInvSize.y = 1.0f / info.texture->GetHeight();
+
+        m_shader->SetUniform(m_textureSizeInv, textureInvSize);
+
+        // Bind texture unit.
+        StateCache::BindTexture(0, info.texture->GetHandle());
+
+        // Bind texture sampler.
+        if(info.filter)
+        {
+            StateCache::BindSampler(0, m_linearSampler.GetHandle());
+        }
+        else
+        {
+            StateCache::BindSampler(0, m_nearestSampler.GetHandle());
+        }
+    }
+    else
+    {
+        // Disable texture unit.
+        StateCache::BindTexture(0, 0);
+    }
+}
+
+bool OpenGLBackend::DrawSpriteInstances(const BasicRenderer::Sprite::Data* data, int count)
+{
+    if(!m_initialized)
+        return false;
+
+    if(m_instanceBuffer.IsStreaming())
+    {
+        // Append instances to the streaming buffer.
+        int baseInstance = m_instanceBuffer.Stream(data, count);
+
+        if(baseInstance < 0)
+            return false;
+
+        // Draw instances from their offset in the buffer.
+        glDrawArraysInstancedBaseInstance(GL_TRIANGLE_STRIP, 0, 4, count, baseInstance);
+    }
+    else
+    {
+        // Update the instance buffer with sprite data.
+        m_instanceBuffer.Update(data, count);
+
+        // Draw instances from the beginning of the buffer.
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, count);
+    }
+
+    return true;
+}
+
+void OpenGLBackend::EndSprites()
+{
+    if(!m_initialized)
+        return;
+
+    // States are left bound, as the state cache skips
+    // rebinding them when the next sprites are drawn.
+}
+
+BasicRenderer::StaticBatchPtr OpenGLBackend::CreateStaticBatch()
+{
+    if(!m_initialized)
+        return nullptr;
+
+    return std::make_unique<OpenGLStaticBatch>();
+}
+
+bool OpenGLBackend::UpdateStaticBatch(StaticSpriteBatch& batch, const BasicRenderer::Sprite::Data* data, int count)
+{
+    if(!m_initialized)
+        return false;
+
+    OpenGLStaticBatch& staticBatch = static_cast<OpenGLStaticBatch&>(batch);
+
+    // Keep buffers of emptied batches for later updates.
+    if(count == 0)
+    {
+        staticBatch.SetCount(0);
+        return true;
+    }
+
+    if(!staticBatch.instanceBuffer.IsValid())
+    {
+        // Create the instance buffer with initial data.
+        if(!staticBatch.instanceBuffer.Initialize(sizeof(BasicRenderer::Sprite::Data), count, data, GL_STATIC_DRAW))
+            return false;
+
+        // Create a vertex input for the instance buffer.
+        if(!this->CreateSpriteInput(staticBatch.vertexInput, staticBatch.instanceBuffer))
+        {
+            staticBatch.instanceBuffer.Cleanup();
+            return false;
+        }
+    }
+    else
+    {
+        // Upload data to the existing buffer, which grows if needed.
+        staticBatch.instanceBuffer.Update(data, count);
+    }
+
+    staticBatch.SetCount(count);
+
+    return true;
+}
+
+bool OpenGLBackend::DrawStaticBatch(const StaticSpriteBatch& batch)
+{
+    if(!m_initialized)
+        return false;
+
+    const OpenGLStaticBatch& staticBatch = static_cast<const OpenGLStaticBatch&>(batch);
+
+    if(staticBatch.GetCount() == 0)
+        return false;
+
+    // Bind the vertex input of the batch.
+    // Sprite vertex input is bound again when next sprites begin.
+    StateCache::BindVertexArray(staticBatch.vertexInput.GetHandle());
+
+    // Draw all instances of the batch.
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, staticBatch.GetCount());
+
+    return true;
+}
+
+int OpenGLBackend::GetBatchSizeLimit() const
+{
+    // Streamed batches have to fit in a single region.
+    if(m_instanceBuffer.IsStreaming())
+        return (int)m_instanceBuffer.GetRegionSize();
+
+    return 0;
+}
+
+bool OpenGLBackend::CreateSpriteInput(VertexInput& vertexInput, const InstanceBuffer& instanceBuffer) const
+{
+    const VertexAttribute attributes[] =
+    {
+        { &m_vertexBuffer, VertexAttributeTypes::Float2           }, // Position
+        { &m_vertexBuffer, VertexAttributeTypes::Float2           }, // Texture
+        { &instanceBuffer, VertexAttributeTypes::Float3           }, // Position
+        { &instanceBuffer, VertexAttributeTypes::Float1           }, // Rotation
+        { &instanceBuffer, VertexAttributeTypes::Float2           }, // Scale
+        { &instanceBuffer, VertexAttributeTypes::Float2           }, // Offset
+        { &instanceBuffer, VertexAttributeTypes::Short4           }, // Rectangle
+        { &instanceBuffer, VertexAttributeTypes::UByte4Normalized }, // Color
+    };
+
+    return vertexInput.Initialize(Utility::ArraySize(attributes), &attributes[0]);
+}
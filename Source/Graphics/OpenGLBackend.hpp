@@ -0,0 +1,107 @@
+#pragma once
+
+#include "Precompiled.hpp"
+#include "RenderBackend.hpp"
+#include "Buffer.hpp"
+#include "VertexInput.hpp"
+#include "Sampler.hpp"
+#include "Shader.hpp"
+
+//
+// OpenGL Backend
+//
+//  Executes basic renderer commands with OpenGL.
+//  Requires a rendering context to be current on the calling thread.
+//
+//  Sprite instances are streamed into regions of a ring buffer and drawn
+//  with base instance offsets when ARB_base_instance is supported. Otherwise
+//  each batch orphans and uploads an instance buffer that grows as needed.
+//
+//  States are changed through the state cache and stay bound between
+//  frames, so only the states that differ between batches are set.
+//
+//  Static batches have their own instance buffers created with static
+//  usage and vertex inputs that share the sprite quad vertex buffer.
+//
+
+namespace Graphics
+{
+    // OpenGL backend class.
+    class OpenGLBackend : public RenderBackend
+    {
+    public:
+        // Type declarations.
+        typedef std::shared_ptr<const Shader> ShaderPtr;
+
+        // Constant variables.
+        static const int SpriteBufferSize = 1024;
+        static const int SpriteRegionSize = 16384;
+        static const int SpriteRegionCount = 4;
+
+    public:
+        OpenGLBackend();
+        ~OpenGLBackend();
+
+        // Restores instance to it's original state.
+        void Cleanup();
+
+        // Initializes the backend.
+        bool Initialize(Context& context) override;
+
+        // Sets the viewport.
+        void SetViewport(int x, int y, int width, int height) override;
+
+        // Sets clear values.
+        void SetClearColor(const glm::vec4& color) override;
+        void SetClearDepth(float depth) override;
+        void SetClearStencil(int stencil) override;
+
+        // Clears the frame buffer.
+        void Clear(uint32_t flags) override;
+
+        // Begins drawing sprites.
+        void BeginSprites(const glm::mat4& transform) override;
+
+        // Sets the state for following sprite batches.
+        void SetSpriteState(const BasicRenderer::Sprite::Info& info) override;
+
+        // Uploads and draws a batch of sprite instances.
+        bool DrawSpriteInstances(const BasicRenderer::Sprite::Data* data, int count) override;
+
+        // Ends drawing sprites.
+        void EndSprites() override;
+
+        // Creates an empty static batch.
+        BasicRenderer::StaticBatchPtr CreateStaticBatch() override;
+
+        // Uploads sprite instances to a static batch.
+        bool UpdateStaticBatch(StaticSpriteBatch& batch, const BasicRenderer::Sprite::Data* data, int count) override;
+
+        // Draws a static batch.
+        bool DrawStaticBatch(const StaticSpriteBatch& batch) override;
+
+        // Gets the maximum number of sprites in a batch.
+        int GetBatchSizeLimit() const override;
+
+    private:
+        // Creates a vertex input for sprite instances.
+        bool CreateSpriteInput(VertexInput& vertexInput, const InstanceBuffer& instanceBuffer) const;
+
+    private:
+        // Graphics objects.
+        VertexBuffer   m_vertexBuffer;
+        InstanceBuffer m_instanceBuffer;
+        VertexInput    m_vertexInput;
+        Sampler        m_nearestSampler;
+        Sampler        m_linearSampler;
+        ShaderPtr      m_shader;
+
+        // Shader uniform handles.
+        Shader::UniformHandle<glm::mat4> m_viewTransform;
+        Shader::UniformHandle<glm::vec2> m_textureSizeInv;
+        Shader::UniformHandle<int>       m_textureDiffuse;
+
+        // Initialization state.
+        bool m_initialized;
+    };
+}
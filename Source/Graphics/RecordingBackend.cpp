@@ -0,0 +1,301 @@
+#include "Precompiled.hpp"
+#include "RecordingBackend.hpp"
+using namespace Graphics;
+
+namespace
+{
+    // Static batch class.
+    class RecordingStaticBatch : public StaticSpriteBatch
+    {
+    public:
+        // Sets the number of sprite instances.
+        void SetCount(int count)
+        {
+            m_count = count;
+        }
+
+    public:
+        // Copy of sprite instances.
+        BasicRenderer::SpriteDataList instances;
+    };
+}
+
+RecordingBackend::Command::Command() :
+    type(CommandTypes::SetViewport),
+    transform(1.0f),
+    viewport(0, 0, 0, 0),
+    color(0.0f, 0.0f, 0.0f, 0.0f),
+    depth(0.0f),
+    stencil(0),
+    flags(0),
+    first(0),
+    count(0)
+{
+}
+
+RecordingBackend::Counters::Counters() :
+    clears(0),
+    drawCalls(0),
+    stateChanges(0),
+    spritesDrawn(0),
+    uploadedBytes(0)
+{
+}
+
+RecordingBackend::RecordingBackend() :
+    m_batchSizeLimit(0),
+    m_instanceRecording(true),
+    m_initialized(false)
+{
+}
+
+RecordingBackend::~RecordingBackend()
+{
+    this->Cleanup();
+}
+
+void RecordingBackend::Cleanup()
+{
+    if(!m_initialized)
+        return;
+
+    // Clear the recording.
+    Utility::ClearContainer(m_commands);
+    Utility::ClearContainer(m_instances);
+    m_counters = Counters();
+
+    // Reset recording settings.
+    m_batchSizeLimit = 0;
+    m_instanceRecording = true;
+
+    // Reset initialization state.
+    m_initialized = false;
+}
+
+bool RecordingBackend::Initialize(Context&)
+{
+    this->Cleanup();
+
+    // Success!
+    return m_initialized = true;
+}
+
+void RecordingBackend::SetViewport(int x, int y, int width, int height)
+{
+    if(!m_initialized)
+        return;
+
+    Command command;
+    command.type = CommandTypes::SetViewport;
+    command.viewport = glm::ivec4(x, y, width, height);
+
+    m_commands.push_back(command);
+}
+
+void RecordingBackend::SetClearColor(const glm::vec4& color)
+{
+    if(!m_initialized)
+        return;
+
+    Command command;
+    command.type = CommandTypes::SetClearColor;
+    command.color = color;
+
+    m_commands.push_back(command);
+}
+
+void RecordingBackend::SetClearDepth(float depth)
+{
+    if(!m_initialized)
+        return;
+
+    Command command;
+    command.type = CommandTypes::SetClearDepth;
+    command.depth = depth;
+
+    m_commands.push_back(command);
+}
+
+void RecordingBackend::SetClearStencil(int stencil)
+{
+    if(!m_initialized)
+        return;
+
+    Command command;
+    command.type = CommandTypes::SetClearStencil;
+    command.stencil = stencil;
+
+    m_commands.push_back(command);
+}
+
+void RecordingBackend::Clear(uint32_t flags)
+{
+    if(!m_initialized)
+        return;
+
+    Command command;
+    command.type = CommandTypes::Clear;
+    command.flags = flags;
+
+    m_commands.push_back(command);
+
+    m_counters.clears += 1;
+}
+
+void RecordingBackend::BeginSprites(const glm::mat4& transform)
+{
+    if(!m_initialized)
+        return;
+
+    Command command;
+    command.type = CommandTypes::BeginSprites;
+    command.transform = transform;
+
+    m_commands.push_back(command);
+}
+
+void RecordingBackend::SetSpriteState(const BasicRenderer::Sprite::Info& info)
+{
+    if(!m_initialized)
+        return;
+
+    Command command;
+    command.type = CommandTypes::SetSpriteState;
+    command.info = info;
+
+    m_commands.push_back(command);
+
+    m_counters.stateChanges += 1;
+}
+
+bool RecordingBackend::DrawSpriteInstances(const BasicRenderer::Sprite::Data* data, int count)
+{
+    if(!m_initialized)
+        return false;
+
+    Command command;
+    command.type = CommandTypes::DrawSpriteInstances;
+    command.first = (int)m_instances.size();
+    command.count = count;
+
+    m_commands.push_back(command);
+
+    // Copy sprite instances.
+    if(m_instanceRecording)
+    {
+        m_instances.insert(m_instances.end(), data, data + count);
+    }
+
+    // Update counters.
+    m_counters.drawCalls += 1;
+    m_counters.spritesDrawn += count;
+    m_counters.uploadedBytes += count * sizeof(BasicRenderer::Sprite::Data);
+
+    return true;
+}
+
+void RecordingBackend::EndSprites()
+{
+    if(!m_initialized)
+        return;
+
+    Command command;
+    command.type = CommandTypes::EndSprites;
+
+    m_commands.push_back(command);
+}
+
+BasicRenderer::StaticBatchPtr RecordingBackend::CreateStaticBatch()
+{
+    if(!m_initialized)
+        return nullptr;
+
+    return std::make_unique<RecordingStaticBatch>();
+}
+
+bool RecordingBackend::UpdateStaticBatch(StaticSpriteBatch& batch, const BasicRenderer::Sprite::Data* data, int count)
+{
+    if(!m_initialized)
+        return false;
+
+    RecordingStaticBatch& staticBatch = static_cast<RecordingStaticBatch&>(batch);
+
+    Command command;
+    command.type = CommandTypes::UpdateStaticBatch;
+    command.count = count;
+
+    m_commands.push_back(command);
+
+    // Copy sprite instances to the batch.
+    staticBatch.instances.assign(data, data + count);
+    staticBatch.SetCount(count);
+
+    // Update counters.
+    m_counters.uploadedBytes += count * sizeof(BasicRenderer::Sprite::Data);
+
+    return true;
+}
+
+bool RecordingBackend::DrawStaticBatch(const StaticSpriteBatch& batch)
+{
+    if(!m_initialized)
+        return false;
+
+    const RecordingStaticBatch& staticBatch = static_cast<const RecordingStaticBatch&>(batch);
+
+    Command command;
+    command.type = CommandTypes::DrawStaticBatch;
+    command.first = (int)m_instances.size();
+    command.count = staticBatch.GetCount();
+
+    m_commands.push_back(command);
+
+    // Copy sprite instances.
+    if(m_instanceRecording)
+    {
+        m_instances.insert(m_instances.end(), staticBatch.instances.begin(), staticBatch.instances.end());
+    }
+
+    // Update counters.
+    m_counters.drawCalls += 1;
+    m_counters.spritesDrawn += staticBatch.GetCount();
+
+    return true;
+}
+
+int RecordingBackend::GetBatchSizeLimit() const
+{
+    return m_batchSizeLimit;
+}
+
+void RecordingBackend::SetBatchSizeLimit(int limit)
+{
+    m_batchSizeLimit = std::max(limit, 0);
+}
+
+void RecordingBackend::SetInstanceRecording(bool enabled)
+{
+    m_instanceRecording = enabled;
+}
+
+void RecordingBackend::Reset()
+{
+    m_commands.clear();
+    m_instances.clear();
+    m_counters = Counters();
+}
+
+const RecordingBackend::CommandList& RecordingBackend::GetCommands() const
+{
+    return m_commands;
+}
+
+const RecordingBackend::InstanceList& RecordingBackend::GetInstances() const
+{
+    return m_instances;
+}
+
+const RecordingBackend::Counters& RecordingBackend::GetCounters() const
+{
+    return m_counters;
+}
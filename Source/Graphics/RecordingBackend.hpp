@@ -0,0 +1,163 @@
+#pragma once
+
+#include "Precompiled.hpp"
+#include "RenderBackend.hpp"
+
+//
+// Recording Backend
+//
+//  Records basic renderer commands without drawing anything, so whole
+//  frames can be profiled and tested without a window or a rendering context.
+//
+//  Example usage:
+//      Graphics::BasicRenderer basicRenderer;
+//      basicRenderer.Initialize(context, Graphics::BasicRenderer::Backend::Recording);
+//
+//      renderSystem.Draw();
+//
+//      auto recording = static_cast<Graphics::RecordingBackend*>(basicRenderer.GetBackend());
+//      Assert(recording->GetCounters().drawCalls == 1);
+//      recording->Reset();
+//
+//  Commands and sprite instances are kept until the recording is reset.
+//  Recording of instances can be disabled when only counters are needed.
+//  Static batches keep copies of their instances, which are recorded
+//  each time they are drawn, but count as uploaded only when updated.
+//
+
+namespace Graphics
+{
+    // Recording backend class.
+    class RecordingBackend : public RenderBackend
+    {
+    public:
+        // Command types.
+        struct CommandTypes
+        {
+            enum Type
+            {
+                SetViewport,
+                SetClearColor,
+                SetClearDepth,
+                SetClearStencil,
+                Clear,
+                BeginSprites,
+                SetSpriteState,
+                DrawSpriteInstances,
+                EndSprites,
+                UpdateStaticBatch,
+                DrawStaticBatch,
+            };
+        };
+
+        // Command structure.
+        struct Command
+        {
+            Command();
+
+            CommandTypes::Type type;
+            BasicRenderer::Sprite::Info info;
+            glm::mat4 transform;
+            glm::ivec4 viewport;
+            glm::vec4 color;
+            float depth;
+            int stencil;
+            uint32_t flags;
+            int first;
+            int count;
+        };
+
+        // Counters structure.
+        struct Counters
+        {
+            Counters();
+
+            int clears;
+            int drawCalls;
+            int stateChanges;
+            int spritesDrawn;
+            std::size_t uploadedBytes;
+        };
+
+        // Type declarations.
+        typedef std::vector<Command> CommandList;
+        typedef BasicRenderer::SpriteDataList InstanceList;
+
+    public:
+        RecordingBackend();
+        ~RecordingBackend();
+
+        // Restores instance to it's original state.
+        void Cleanup();
+
+        // Initializes the backend.
+        bool Initialize(Context& context) override;
+
+        // Records the viewport.
+        void SetViewport(int x, int y, int width, int height) override;
+
+        // Records clear values.
+        void SetClearColor(const glm::vec4& color) override;
+        void SetClearDepth(float depth) override;
+        void SetClearStencil(int stencil) override;
+
+        // Records a frame buffer clear.
+        void Clear(uint32_t flags) override;
+
+        // Records the beginning of sprite drawing with its transform.
+        void BeginSprites(const glm::mat4& transform) override;
+
+        // Records a sprite state change.
+        void SetSpriteState(const BasicRenderer::Sprite::Info& info) override;
+
+        // Records a batch of sprite instances.
+        bool DrawSpriteInstances(const BasicRenderer::Sprite::Data* data, int count) override;
+
+        // Records the end of sprite drawing.
+        void EndSprites() override;
+
+        // Creates an empty static batch.
+        BasicRenderer::StaticBatchPtr CreateStaticBatch() override;
+
+        // Records an upload of static batch instances.
+        bool UpdateStaticBatch(StaticSpriteBatch& batch, const BasicRenderer::Sprite::Data* data, int count) override;
+
+        // Records a static batch draw.
+        bool DrawStaticBatch(const StaticSpriteBatch& batch) override;
+
+        // Gets the maximum number of sprites in a batch.
+        int GetBatchSizeLimit() const override;
+
+        // Sets the maximum number of sprites in a batch.
+        // Zero means no limit. Useful for matching limits of other backends.
+        void SetBatchSizeLimit(int limit);
+
+        // Sets whether sprite instances are recorded.
+        void SetInstanceRecording(bool enabled);
+
+        // Clears recorded commands, instances and counters.
+        void Reset();
+
+        // Gets recorded commands.
+        const CommandList& GetCommands() const;
+
+        // Gets recorded sprite instances.
+        const InstanceList& GetInstances() const;
+
+        // Gets counters since the last reset.
+        const Counters& GetCounters() const;
+
+    private:
+        // Recorded commands.
+        CommandList m_commands;
+        InstanceList m_instances;
+        Counters m_counters;
+
+        // Recording settings.
+        int m_batchSizeLimit;
+        bool m_instanceRecording;
+
+        // Initialization state.
+        bool m_initialized;
+    };
+}
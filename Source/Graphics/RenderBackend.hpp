@@ -0,0 +1,90 @@
+#pragma once
+
+#include "Precompiled.hpp"
+#include "BasicRenderer.hpp"
+
+// Forward declarations.
+struct Context;
+
+//
+// Render Backend
+//
+//  Interface that executes drawing commands of the basic renderer.
+//  The basic renderer batches sprites and calls its backend to change
+//  states and draw batches. See BasicRenderer::Backend for available types.
+//
+//  Sprite drawing calls are made in the following order:
+//      backend->BeginSprites(transform);
+//
+//      backend->SetSpriteState(info);
+//      backend->DrawSpriteInstances(&data[0], count);
+//      /* ... */
+//
+//      backend->EndSprites();
+//
+//  State is set only when sprite info changes between batches.
+//
+//  Static batches are created and updated by the backend that draws them.
+//  They are drawn in place of uploaded instances:
+//      backend->BeginSprites(transform);
+//      backend->SetSpriteState(info);
+//      backend->DrawStaticBatch(*batch);
+//      backend->EndSprites();
+//
+
+namespace Graphics
+{
+    // Render backend interface class.
+    class RenderBackend
+    {
+    protected:
+        RenderBackend()
+        {
+        }
+
+    public:
+        virtual ~RenderBackend()
+        {
+        }
+
+        // Initializes the backend.
+        virtual bool Initialize(Context& context) = 0;
+
+        // Sets the viewport rectangle.
+        virtual void SetViewport(int x, int y, int width, int height) = 0;
+
+        // Sets values that buffers are cleared with.
+        virtual void SetClearColor(const glm::vec4& color) = 0;
+        virtual void SetClearDepth(float depth) = 0;
+        virtual void SetClearStencil(int stencil) = 0;
+
+        // Clears frame buffers selected by clear flags.
+        virtual void Clear(uint32_t flags) = 0;
+
+        // Begins drawing sprites with a view transform.
+        virtual void BeginSprites(const glm::mat4& transform) = 0;
+
+        // Sets the state of following sprite batches.
+        virtual void SetSpriteState(const BasicRenderer::Sprite::Info& info) = 0;
+
+        // Uploads and draws a batch of sprite instances.
+        // Count never exceeds the batch size limit if there is one.
+        virtual bool DrawSpriteInstances(const BasicRenderer::Sprite::Data* data, int count) = 0;
+
+        // Ends drawing sprites and restores states changed by it.
+        virtual void EndSprites() = 0;
+
+        // Creates an empty static batch owned by the backend.
+        virtual BasicRenderer::StaticBatchPtr CreateStaticBatch() = 0;
+
+        // Replaces sprite instances of a static batch.
+        virtual bool UpdateStaticBatch(StaticSpriteBatch& batch, const BasicRenderer::Sprite::Data* data, int count) = 0;
+
+        // Draws sprite instances of a static batch.
+        virtual bool DrawStaticBatch(const StaticSpriteBatch& batch) = 0;
+
+        // Gets the maximum number of sprites in a batch.
+        // Zero means there is no limit.
+        virtual int GetBatchSizeLimit() const = 0;
+    };
+}
@@ -0,0 +1,383 @@
+#include "Precompiled.hpp"
+#include "RenderQueue.hpp"
+#include "Context.hpp"
+#include "System/JobSystem.hpp"
+using namespace Graphics;
+
+namespace
+{
+    // Log error messages.
+    #define LogInitializeError() "Failed to initialize the render queue! "
+
+    // Bits of sort keys.
+    const uint64_t TextureMask = 0x7FFF;
+    const uint64_t FilterBit = (uint64_t)1 << 15;
+
+    // Minimum number of commands sorted on a single worker.
+    const std::size_t CommandSortGrain = 16384;
+
+    // Gets the sort key of a command.
+    uint64_t GetCommandKey(const RenderQueue::CommandSort& sort)
+    {
+        return sort.key;
+    }
+
+    // Converts a float to an integer that keeps the order of values.
+    uint32_t FloatToSortable(float value)
+    {
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+
+        return (bits & 0x80000000) ? ~bits : bits | 0x80000000;
+    }
+}
+
+RenderQueue::RenderQueue() :
+    m_basicRenderer(nullptr),
+    m_jobSystem(nullptr),
+    m_lastTexture(nullptr),
+    m_lastTextureId(0),
+    m_initialized(false)
+{
+    for(glm::mat4& transform : m_transforms)
+    {
+        transform = glm::mat4(1.0f);
+    }
+}
+
+RenderQueue::~RenderQueue()
+{
+    this->Cleanup();
+}
+
+void RenderQueue::Cleanup()
+{
+    if(!m_initialized)
+        return;
+
+    // Reset context references.
+    m_basicRenderer = nullptr;
+    m_jobSystem = nullptr;
+
+    // Clear command lists.
+    Utility::ClearContainer(m_commandInfo);
+    Utility::ClearContainer(m_commandData);
+    Utility::ClearContainer(m_commandSort);
+    Utility::ClearContainer(m_commandSortBuffer);
+    Utility::ClearContainer(m_staticBatches);
+    Utility::ClearContainer(m_instanceRuns);
+
+    Utility::ClearContainer(m_spriteInfo);
+    Utility::ClearContainer(m_spriteData);
+
+    // Reset layer transforms.
+    for(glm::mat4& transform : m_transforms)
+    {
+        transform = glm::mat4(1.0f);
+    }
+
+    // Clear texture identifiers.
+    Utility::ClearContainer(m_textureIds);
+    m_lastTexture = nullptr;
+    m_lastTextureId = 0;
+
+    // Reset initialization state.
+    m_initialized = false;
+}
+
+bool RenderQueue::Initialize(Context& context)
+{
+    Assert(context.basicRenderer != nullptr);
+    Assert(context.renderQueue == nullptr);
+
+    // Cleanup this instance.
+    this->Cleanup();
+
+    // Get required context instances.
+    m_basicRenderer = context.basicRenderer;
+
+    // Sort commands on workers if there are any.
+    m_jobSystem = context.jobSystem;
+
+    // Make sure layers fit in sort keys.
+    static_assert(Layers::Count <= 16, "Too many render layers.");
+
+    // Set context instance.
+    context.renderQueue = this;
+
+    // Success!
+    return m_initialized = true;
+}
+
+uint64_t RenderQueue::CalculateKey(Layers::Type layer, const BasicRenderer::Sprite::Info& info, const BasicRenderer::Sprite::Data& data) const
+{
+    Assert(layer >= 0 && layer < Layers::Count);
+
+    // Get sortable depth and vertical position of the sprite origin.
+    uint32_t depth = FloatToSortable(data.position.z);
+    uint32_t position = FloatToSortable(data.position.y + data.offset.y * data.scale.y);
+
+    if(info.transparent)
+    {
+        // Sort transparent by depth (back to front) and by the y position (top to bottom).
+        position = ~position;
+    }
+    else
+    {
+        // Sort opaque by depth (front to back) and only then by state.
+        depth = ~depth;
+        position = 0;
+    }
+
+    // Pack the sort key.
+    // Texture bits are added when the command is pushed.
+    uint64_t key = 0;
+    key |= (uint64_t)(layer & 0xF) << 60;
+    key |= (uint64_t)(info.transparent ? 1 : 0) << 59;
+    key |= (uint64_t)(depth >> 12) << 39;
+    key |= (uint64_t)(position >> 9) << 16;
+    key |= info.filter ? FilterBit : 0;
+
+    return key;
+}
+
+uint64_t RenderQueue::CalculateOrderKey(Layers::Type layer, uint32_t order, const BasicRenderer::Sprite::Info& info) const
+{
+    Assert(layer >= 0 && layer < Layers::Count);
+
+    // Pack the sort key.
+    uint64_t key = 0;
+    key |= (uint64_t)(layer & 0xF) << 60;
+    key |= (uint64_t)order << 16;
+    key |= info.filter ? FilterBit : 0;
+
+    return key;
+}
+
+void RenderQueue::Push(uint64_t key, const BasicRenderer::Sprite::Info& info, const BasicRenderer::Sprite::Data& data)
+{
+    Assert((key >> 60) < Layers::Count, "Invalid layer in the sort key.");
+
+    if(!m_initialized)
+        return;
+
+    // Add the command.
+    CommandSort sort;
+    sort.key = this->AddTextureId(key, info.texture);
+    sort.index = (uint32_t)m_commandInfo.size();
+    sort.type = CommandTypes::Sprite;
+
+    m_commandSort.push_back(sort);
+    m_commandInfo.push_back(info);
+    m_commandData.push_back(data);
+}
+
+void RenderQueue::PushStaticBatch(uint64_t key, const BasicRenderer::Sprite::Info& info, const StaticSpriteBatch& batch)
+{
+    Assert((key >> 60) < Layers::Count, "Invalid layer in the sort key.");
+
+    if(!m_initialized)
+        return;
+
+    // Add the command.
+    CommandSort sort;
+    sort.key = this->AddTextureId(key, info.texture);
+    sort.index = (uint32_t)m_staticBatches.size();
+    sort.type = CommandTypes::StaticBatch;
+
+    StaticBatchCommand command;
+    command.info = info;
+    command.batch = &batch;
+
+    m_commandSort.push_back(sort);
+    m_staticBatches.push_back(command);
+}
+
+uint64_t RenderQueue::AddTextureId(uint64_t key, const Texture* texture)
+{
+    // Assign identifiers in order of appearance.
+    // Consecutive commands often share textures, so the last one is remembered.
+    if(texture != m_lastTexture || m_textureIds.empty())
+    {
+        auto result = m_textureIds.emplace(texture, (uint32_t)m_textureIds.size());
+
+        m_lastTexture = texture;
+        m_lastTextureId = result.first->second;
+    }
+
+    return (key & ~TextureMask) | (m_lastTextureId & TextureMask);
+}
+
+void RenderQueue::PushInstances(uint64_t key, const BasicRenderer::Sprite::Info& info, const BasicRenderer::Sprite::Data* data, int count)
+{
+    Assert((key >> 60) < Layers::Count, "Invalid layer in the sort key.");
+
+    if(!m_initialized)
+        return;
+
+    if(data == nullptr || count <= 0)
+        return;
+
+    // Add the command.
+    CommandSort sort;
+    sort.key = this->AddTextureId(key, info.texture);
+    sort.index = (uint32_t)m_instanceRuns.size();
+    sort.type = CommandTypes::InstanceRun;
+
+    InstanceRun run;
+    run.info = info;
+    run.data = data;
+    run.count = count;
+
+    m_commandSort.push_back(sort);
+    m_instanceRuns.push_back(run);
+}
+
+void RenderQueue::SetTransform(Layers::Type layer, const glm::mat4& transform)
+{
+    Assert(layer >= 0 && layer < Layers::Count);
+
+    m_transforms[layer] = transform;
+}
+
+void RenderQueue::Submit()
+{
+    if(!m_initialized)
+        return;
+
+    // Sort commands by their keys.
+    this->SortCommands();
+
+    // Draw layers in order.
+    std::size_t commandCount = m_commandSort.size();
+    std::size_t command = 0;
+
+    for(int layer = 0; layer < Layers::Count; ++layer)
+    {
+        // Draw sorted commands of the layer.
+        for(; command != commandCount && (int)(m_commandSort[command].key >> 60) == layer; ++command)
+        {
+            const CommandSort& sort = m_commandSort[command];
+
+            if(sort.type == CommandTypes::Sprite)
+            {
+                // Gather sprites that can be drawn together.
+                m_spriteInfo.push_back(m_commandInfo[sort.index]);
+                m_spriteData.push_back(m_commandData[sort.index]);
+            }
+            else if(sort.type == CommandTypes::StaticBatch)
+            {
+                // Draw gathered sprites before the static batch.
+                this->DrawSprites(layer);
+
+                const StaticBatchCommand& staticBatch = m_staticBatches[sort.index];
+                m_basicRenderer->DrawStaticBatch(staticBatch.info, *staticBatch.batch, m_transforms[layer]);
+            }
+            else
+            {
+                // Draw gathered sprites before the instance run.
+                this->DrawSprites(layer);
+
+                const InstanceRun& run = m_instanceRuns[sort.index];
+                m_basicRenderer->DrawSprites(run.info, run.data, run.count, m_transforms[layer]);
+            }
+        }
+
+        this->DrawSprites(layer);
+    }
+
+    // Clear submitted commands.
+    this->Clear();
+}
+
+void RenderQueue::DrawSprites(int layer)
+{
+    if(m_spriteInfo.empty())
+        return;
+
+    m_basicRenderer->DrawSprites(m_spriteInfo, m_spriteData, m_transforms[layer]);
+
+    m_spriteInfo.clear();
+    m_spriteData.clear();
+}
+
+void RenderQueue::SortCommands()
+{
+    std::size_t commandCount = m_commandSort.size();
+    m_commandSortBuffer.resize(commandCount);
+
+    // Split commands into parts for workers.
+    std::size_t partCount = 1;
+
+    if(m_jobSystem != nullptr)
+    {
+        partCount = std::min<std::size_t>(m_jobSystem->GetWorkerCount(), commandCount / CommandSortGrain);
+    }
+
+    if(partCount <= 1)
+    {
+        Utility::RadixSort(m_commandSort, m_commandSortBuffer, GetCommandKey);
+        return;
+    }
+
+    std::size_t partSize = (commandCount + partCount - 1) / partCount;
+
+    // Sort parts in parallel.
+    m_jobSystem->ParallelFor(partCount, 1, [&](std::size_t begin, std::size_t end)
+    {
+        for(std::size_t part = begin; part < end; ++part)
+        {
+            std::size_t first = part * partSize;
+            std::size_t last = std::min(first + partSize, commandCount);
+
+            if(first >= last)
+                continue;
+
+            Utility::RadixSort(&m_commandSort[first], &m_commandSortBuffer[first], last - first, GetCommandKey);
+        }
+    });
+
+    // Merge pairs of sorted parts until a single one is left.
+    // Merging is stable, so commands with equal keys keep their order.
+    for(std::size_t mergedSize = partSize; mergedSize < commandCount; mergedSize *= 2)
+    {
+        std::size_t pairCount = (commandCount + mergedSize * 2 - 1) / (mergedSize * 2);
+
+        m_jobSystem->ParallelFor(pairCount, 1, [&](std::size_t begin, std::size_t end)
+        {
+            for(std::size_t pair = begin; pair < end; ++pair)
+            {
+                std::size_t first = pair * mergedSize * 2;
+                std::size_t middle = std::min(first + mergedSize, commandCount);
+                std::size_t last = std::min(middle + mergedSize, commandCount);
+
+                std::merge(m_commandSort.begin() + first, m_commandSort.begin() + middle,
+                    m_commandSort.begin() + middle, m_commandSort.begin() + last,
+                    m_commandSortBuffer.begin() + first, [](const CommandSort& a, const CommandSort& b)
+                    {
+                        return a.key < b.key;
+                    });
+            }
+        });
+
+        m_commandSort.swap(m_commandSortBuffer);
+    }
+}
+
+void RenderQueue::Clear()
+{
+    m_commandInfo.clear();
+    m_commandData.clear();
+    m_commandSort.clear();
+    m_staticBatches.clear();
+    m_instanceRuns.clear();
+
+    // Assign new texture identifiers in the next frame.
+    m_textureIds.clear();
+    m_lastTexture = nullptr;
+}
+
+std::size_t RenderQueue::GetCommandCount() const
+{
+    return m_commandSort.size();
+}
@@ -0,0 +1,192 @@
+#pragma once
+
+#include "Precompiled.hpp"
+#include "BasicRenderer.hpp"
+
+// Forward declarations.
+struct Context;
+
+namespace System
+{
+    class JobSystem;
+}
+
+//
+// Render Queue
+//
+//  Collects sprites from different producers and draws them together,
+//  so world sprites, debug drawing and interface share batches and
+//  change states only when sort keys change.
+//
+//  Example usage:
+//      uint64_t key = renderQueue.CalculateKey(Graphics::RenderQueue::Layers::Interface, info, data);
+//      renderQueue.Push(key, info, data);
+//
+//      renderQueue.SetTransform(Graphics::RenderQueue::Layers::Interface, transform);
+//      renderQueue.Submit();
+//
+//  Bits of a sort key from the most significant ones are: layer (4),
+//  transparency (1), depth (20), vertical position (23), filter (1) and
+//  texture (15). Blending and depth writes depend only on transparency and
+//  there is a single sprite shader, so keys do not hold a program. Layers
+//  are drawn in order, each with its own transform.
+//
+//  Texture bits are filled when commands are pushed, with identifiers that
+//  are assigned in order of appearance and reset after every submit, so
+//  cached sort keys stay valid. Beyond 32768 textures in a frame their
+//  identifiers wrap around, which only costs additional state changes.
+//
+//  Static batches are queued with keys that keep the order they are given
+//  in, between the layer and filter bits. Tile maps are drawn this way in
+//  the background layer. Queued batches have to stay valid until submitted.
+//
+//  Queued commands are sorted once with a radix sort and drawn in runs
+//  of the same layer. Large numbers of commands are split into parts that
+//  are sorted on workers of the job system and merged in pairs, which
+//  gives the same order as a single sort. The queue is cleared after
+//  submitting. Producers running as scheduled systems should declare
+//  write access to the queue.
+//
+//  Large numbers of sprites that share the same info can be pushed as
+//  instance runs, which are sorted with other commands by a single key,
+//  but sprites within a run are drawn in the order they are given in.
+//  Instance data is not copied and has to stay valid until the queue is
+//  submitted or cleared.
+//
+
+namespace Graphics
+{
+    // Render queue class.
+    class RenderQueue
+    {
+    public:
+        // Render layers.
+        struct Layers
+        {
+            enum Type
+            {
+                Background,
+                World,
+                Debug,
+                Interface,
+
+                Count,
+            };
+        };
+
+        // Command types.
+        struct CommandTypes
+        {
+            enum Type
+            {
+                Sprite,
+                StaticBatch,
+                InstanceRun,
+            };
+        };
+
+        // Command sort structure.
+        struct CommandSort
+        {
+            uint64_t key;
+            uint32_t index;
+            uint32_t type;
+        };
+
+        // Static batch command structure.
+        struct StaticBatchCommand
+        {
+            BasicRenderer::Sprite::Info info;
+            const StaticSpriteBatch* batch;
+        };
+
+        // Instance run structure.
+        struct InstanceRun
+        {
+            BasicRenderer::Sprite::Info info;
+            const BasicRenderer::Sprite::Data* data;
+            int count;
+        };
+
+        // Type declarations.
+        typedef std::vector<CommandSort> CommandSortList;
+        typedef std::vector<StaticBatchCommand> StaticBatchCommandList;
+        typedef std::vector<InstanceRun> InstanceRunList;
+        typedef std::unordered_map<const Texture*, uint32_t> TextureIdList;
+
+    public:
+        RenderQueue();
+        ~RenderQueue();
+
+        // Restores instance to it's original state.
+        void Cleanup();
+
+        // Initializes the render queue.
+        bool Initialize(Context& context);
+
+        // Calculates the sort key of a sprite.
+        uint64_t CalculateKey(Layers::Type layer, const BasicRenderer::Sprite::Info& info, const BasicRenderer::Sprite::Data& data) const;
+
+        // Calculates a sort key that draws commands of a layer in the given order.
+        uint64_t CalculateOrderKey(Layers::Type layer, uint32_t order, const BasicRenderer::Sprite::Info& info) const;
+
+        // Adds a sprite command.
+        void Push(uint64_t key, const BasicRenderer::Sprite::Info& info, const BasicRenderer::Sprite::Data& data);
+
+        // Adds a static batch command.
+        void PushStaticBatch(uint64_t key, const BasicRenderer::Sprite::Info& info, const StaticSpriteBatch& batch);
+
+        // Adds a run of sprite instances that share the same info.
+        void PushInstances(uint64_t key, const BasicRenderer::Sprite::Info& info, const BasicRenderer::Sprite::Data* data, int count);
+
+        // Sets the view transform of a layer.
+        void SetTransform(Layers::Type layer, const glm::mat4& transform);
+
+        // Sorts and draws queued commands.
+        void Submit();
+
+        // Removes queued commands.
+        void Clear();
+
+        // Gets the number of queued commands.
+        std::size_t GetCommandCount() const;
+
+    private:
+        // Adds the texture identifier to a sort key.
+        uint64_t AddTextureId(uint64_t key, const Texture* texture);
+
+        // Sorts commands by their keys.
+        void SortCommands();
+
+        // Draws gathered sprites of a layer.
+        void DrawSprites(int layer);
+
+    private:
+        // Context references.
+        BasicRenderer*     m_basicRenderer;
+        System::JobSystem* m_jobSystem;
+
+        // Queued commands.
+        BasicRenderer::SpriteInfoList m_commandInfo;
+        BasicRenderer::SpriteDataList m_commandData;
+        CommandSortList m_commandSort;
+        CommandSortList m_commandSortBuffer;
+        StaticBatchCommandList m_staticBatches;
+        InstanceRunList m_instanceRuns;
+
+        // Sorted sprite lists of a layer.
+        BasicRenderer::SpriteInfoList m_spriteInfo;
+        BasicRenderer::SpriteDataList m_spriteData;
+
+        // Layer transforms.
+        glm::mat4 m_transforms[Layers::Count];
+
+        // Texture identifiers used in sort keys of this frame.
+        TextureIdList m_textureIds;
+        const Texture* m_lastTexture;
+        uint32_t m_lastTextureId;
+
+        // Initialization state.
+        bool m_initialized;
+    };
+}
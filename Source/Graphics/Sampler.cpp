@@ -1,5 +1,6 @@
 #include "Precompiled.hpp"
 #include "Sampler.hpp"
+#include "StateCache.hpp"
 using namespace Graphics;
 
 namespace
@@ -30,6 +31,8 @@ void Sampler::Cleanup()
     // Delete sampler handle.
     if(m_handle != InvalidHandle)
     {
+        StateCache::ForgetSampler(m_handle);
+
         glDeleteSamplers(1, &m_handle);
         m_handle = InvalidHandle;
     }
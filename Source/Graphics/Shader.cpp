@@ -1,5 +1,6 @@
 #include "Precompiled.hpp"
 #include "Graphics/Shader.hpp"
+#include "Graphics/StateCache.hpp"
 using namespace Graphics;
 
 namespace
@@ -27,6 +28,48 @@ namespace
         { "GEOMETRY_SHADER", GL_GEOMETRY_SHADER },
         { "FRAGMENT_SHADER", GL_FRAGMENT_SHADER },
     };
+
+    // Gets the size of a cached uniform value.
+    std::size_t GetUniformValueSize(GLenum type, bool& floating)
+    {
+        floating = true;
+
+        switch(type)
+        {
+        case GL_FLOAT:      return sizeof(float);
+        case GL_FLOAT_VEC2: return sizeof(glm::vec2);
+        case GL_FLOAT_VEC3: return sizeof(glm::vec3);
+        case GL_FLOAT_VEC4: return sizeof(glm::vec4);
+        case GL_FLOAT_MAT4: return sizeof(glm::mat4);
+        }
+
+        floating = false;
+
+        switch(type)
+        {
+        case GL_INT:
+        case GL_BOOL:
+        case GL_SAMPLER_1D:
+        case GL_SAMPLER_2D:
+        case GL_SAMPLER_3D:
+        case GL_SAMPLER_CUBE:
+        case GL_SAMPLER_2D_ARRAY:
+            return sizeof(int);
+        }
+
+        return 0;
+    }
+
+    // Removes an array subscript from an active input name.
+    void RemoveArraySubscript(std::string& name)
+    {
+        std::size_t subscript = name.find('[');
+
+        if(subscript != std::string::npos)
+        {
+            name.erase(subscript);
+        }
+    }
 }
 
 Shader::Shader(System::ResourceManager* resourceManager) :
@@ -49,10 +92,18 @@ void Shader::Cleanup()
     // Release the program handle.
     if(m_handle != InvalidHandle)
     {
+        StateCache::ForgetProgram(m_handle);
+
         glDeleteProgram(m_handle);
         m_handle = InvalidHandle;
     }
 
+    // Clear active program inputs.
+    Utility::ClearContainer(m_attributes);
+    Utility::ClearContainer(m_uniformNames);
+    Utility::ClearContainer(m_uniforms);
+    Utility::ClearContainer(m_uniformValues);
+
     // Reset initialization state.
     m_initialized = false;
 }
@@ -207,6 +258,8 @@ bool Shader::Initialize(std::string shaderCode)
     (
         if(!m_initialized)
         {
+            StateCache::ForgetProgram(m_handle);
+
             glDeleteProgram(m_handle);
             m_handle = InvalidHandle;
         }
@@ -259,34 +312,113 @@ bool Shader::Initialize(std::string shaderCode)
         return false;
     }
 
+    // Find active program inputs.
+    this->FindProgramInputs();
+
     // Success!
     return m_initialized = true;
 }
 
-GLint Shader::GetAttribute(std::string name) const
+void Shader::FindProgramInputs()
+{
+    // Find active attributes.
+    GLint attributeCount = 0;
+    glGetProgramiv(m_handle, GL_ACTIVE_ATTRIBUTES, &attributeCount);
+
+    GLint attributeNameLength = 0;
+    glGetProgramiv(m_handle, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &attributeNameLength);
+
+    std::vector<char> nameBuffer(std::max(attributeNameLength, 1));
+
+    for(GLint i = 0; i < attributeCount; ++i)
+    {
+        GLint size = 0;
+        GLenum type = GL_NONE;
+        glGetActiveAttrib(m_handle, i, (GLsizei)nameBuffer.size(), nullptr, &size, &type, &nameBuffer[0]);
+
+        GLint location = glGetAttribLocation(m_handle, &nameBuffer[0]);
+
+        if(location == InvalidAttribute)
+            continue;
+
+        std::string name(&nameBuffer[0]);
+        RemoveArraySubscript(name);
+
+        m_attributes.emplace(name, location);
+    }
+
+    // Find active uniforms.
+    GLint uniformCount = 0;
+    glGetProgramiv(m_handle, GL_ACTIVE_UNIFORMS, &uniformCount);
+
+    GLint uniformNameLength = 0;
+    glGetProgramiv(m_handle, GL_ACTIVE_UNIFORM_MAX_LENGTH, &uniformNameLength);
+
+    nameBuffer.resize(std::max(uniformNameLength, 1));
+
+    for(GLint i = 0; i < uniformCount; ++i)
+    {
+        Uniform uniform;
+        glGetActiveUniform(m_handle, i, (GLsizei)nameBuffer.size(), nullptr, &uniform.size, &uniform.type, &nameBuffer[0]);
+
+        // Skip uniforms in uniform blocks.
+        uniform.location = glGetUniformLocation(m_handle, &nameBuffer[0]);
+
+        if(uniform.location == InvalidUniform)
+            continue;
+
+        // Reserve space for the cached value.
+        bool floating = false;
+
+        uniform.offset = m_uniformValues.size();
+        uniform.cachedSize = GetUniformValueSize(uniform.type, floating);
+
+        m_uniformValues.resize(uniform.offset + uniform.cachedSize);
+
+        // Start with the current value, which may be set by an initializer.
+        if(uniform.cachedSize != 0)
+        {
+            if(floating)
+            {
+                glGetUniformfv(m_handle, uniform.location, (GLfloat*)&m_uniformValues[uniform.offset]);
+            }
+            else
+            {
+                glGetUniformiv(m_handle, uniform.location, (GLint*)&m_uniformValues[uniform.offset]);
+            }
+        }
+
+        // Add the uniform.
+        std::string name(&nameBuffer[0]);
+        RemoveArraySubscript(name);
+
+        m_uniformNames.emplace(name, (int)m_uniforms.size());
+        m_uniforms.push_back(uniform);
+    }
+}
+
+GLint Shader::GetAttribute(const std::string& name) const
 {
     if(!m_initialized)
         return InvalidAttribute;
 
-    if(m_handle == InvalidHandle)
-        return InvalidAttribute;
+    auto it = m_attributes.find(name);
 
-    if(name.empty())
+    if(it == m_attributes.end())
         return InvalidAttribute;
 
-    return glGetAttribLocation(m_handle, name.c_str());
+    return it->second;
 }
 
-GLint Shader::GetUniform(std::string name) const
+GLint Shader::GetUniform(const std::string& name) const
 {
     if(!m_initialized)
         return InvalidUniform;
 
-    if(m_handle == InvalidHandle)
-        return InvalidUniform;
+    auto it = m_uniformNames.find(name);
 
-    if(name.empty())
+    if(it == m_uniformNames.end())
         return InvalidUniform;
 
-    return glGetUniformLocation(m_handle, name.c_str());
+    return m_uniforms[it->second].location;
 }
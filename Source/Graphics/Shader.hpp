@@ -38,12 +38,62 @@
 //      glUseProgram(shader.GetHandle());
 //      glUniformMatrix4fv(shader.GetUniform("vertexTransform"), 1, GL_FALSE, glm::value_ptr(transform));
 //
+//  Using uniform handles:
+//      auto vertexTransform = shader.GetUniformHandle<glm::mat4>("vertexTransform");
+//      
+//      glUseProgram(shader.GetHandle());
+//      shader.SetUniform(vertexTransform, transform);
+//
+//  Active uniforms and attributes are looked up once after linking and
+//  kept in hashed tables. Handles are resolved once and checked against
+//  the uniform type. Values set through handles are cached, so setting
+//  the same value again does not call OpenGL. Setting a value requires
+//  the program to be in use. Arrays are set through their first element.
+//  Uniforms set through handles should not be also set directly.
+//
 
 namespace Graphics
 {
+    // Uniform traits structure.
+    template<typename Type>
+    struct ShaderUniformTraits;
+
     // Shader class.
     class Shader : public System::Resource
     {
+    public:
+        // Uniform handle structure.
+        template<typename Type>
+        struct UniformHandle
+        {
+            UniformHandle() :
+                index(-1)
+            {
+            }
+
+            bool IsValid() const
+            {
+                return index >= 0;
+            }
+
+            int index;
+        };
+
+        // Uniform structure.
+        struct Uniform
+        {
+            GLint location;
+            GLenum type;
+            GLint size;
+            std::size_t offset;
+            std::size_t cachedSize;
+        };
+
+        // Type declarations.
+        typedef std::unordered_map<std::string, GLint> AttributeList;
+        typedef std::unordered_map<std::string, int> UniformNameList;
+        typedef std::vector<Uniform> UniformList;
+
     public:
         Shader(System::ResourceManager* resourceManager = nullptr);
         ~Shader();
@@ -58,10 +108,18 @@ namespace Graphics
         bool Initialize(std::string shaderCode);
 
         // Gets a shader attribute index.
-        GLint GetAttribute(std::string name) const;
+        GLint GetAttribute(const std::string& name) const;
 
         // Gets a shader uniform index.
-        GLint GetUniform(std::string name) const;
+        GLint GetUniform(const std::string& name) const;
+
+        // Gets a uniform handle of a given type.
+        template<typename Type>
+        UniformHandle<Type> GetUniformHandle(const std::string& name) const;
+
+        // Sets a uniform value if it differs from the cached one.
+        template<typename Type>
+        void SetUniform(UniformHandle<Type> handle, const Type& value) const;
 
         // Gets the shader's program handle.
         GLuint GetHandle() const
@@ -75,11 +133,165 @@ namespace Graphics
             return m_initialized;
         }
 
+    private:
+        // Finds active attributes and uniforms of the linked program.
+        void FindProgramInputs();
+
     private:
         // Linked program handle.
         GLuint m_handle;
 
+        // Active program attributes.
+        AttributeList m_attributes;
+
+        // Active program uniforms.
+        UniformNameList m_uniformNames;
+        UniformList m_uniforms;
+
+        // Uniform values set through handles.
+        // Values are state of the program, which is not
+        // a part of the shader's constness.
+        mutable std::vector<uint8_t> m_uniformValues;
+
         // Initialization state.
         bool m_initialized;
     };
+
+    // Uniform traits specializations.
+    template<>
+    struct ShaderUniformTraits<int>
+    {
+        static bool IsCompatible(GLenum type)
+        {
+            return type == GL_INT || type == GL_BOOL || type == GL_SAMPLER_1D || type == GL_SAMPLER_2D ||
+                type == GL_SAMPLER_3D || type == GL_SAMPLER_CUBE || type == GL_SAMPLER_2D_ARRAY;
+        }
+
+        static void Upload(GLint location, const int& value)
+        {
+            glUniform1i(location, value);
+        }
+    };
+
+    template<>
+    struct ShaderUniformTraits<float>
+    {
+        static bool IsCompatible(GLenum type)
+        {
+            return type == GL_FLOAT;
+        }
+
+        static void Upload(GLint location, const float& value)
+        {
+            glUniform1f(location, value);
+        }
+    };
+
+    template<>
+    struct ShaderUniformTraits<glm::vec2>
+    {
+        static bool IsCompatible(GLenum type)
+        {
+            return type == GL_FLOAT_VEC2;
+        }
+
+        static void Upload(GLint location, const glm::vec2& value)
+        {
+            glUniform2fv(location, 1, glm::value_ptr(value));
+        }
+    };
+
+    template<>
+    struct ShaderUniformTraits<glm::vec3>
+    {
+        static bool IsCompatible(GLenum type)
+        {
+            return type == GL_FLOAT_VEC3;
+        }
+
+        static void Upload(GLint location, const glm::vec3& value)
+        {
+            glUniform3fv(location, 1, glm::value_ptr(value));
+        }
+    };
+
+    template<>
+    struct ShaderUniformTraits<glm::vec4>
+    {
+        static bool IsCompatible(GLenum type)
+        {
+            return type == GL_FLOAT_VEC4;
+        }
+
+        static void Upload(GLint location, const glm::vec4& value)
+        {
+            glUniform4fv(location, 1, glm::value_ptr(value));
+        }
+    };
+
+    template<>
+    struct ShaderUniformTraits<glm::mat4>
+    {
+        static bool IsCompatible(GLenum type)
+        {
+            return type == GL_FLOAT_MAT4;
+        }
+
+        static void Upload(GLint location, const glm::mat4& value)
+        {
+            glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(value));
+        }
+    };
+
+    // Template definitions.
+    template<typename Type>
+    Shader::UniformHandle<Type> Shader::GetUniformHandle(const std::string& name) const
+    {
+        UniformHandle<Type> handle;
+
+        if(!m_initialized)
+            return handle;
+
+        // Find the uniform by its name.
+        auto it = m_uniformNames.find(name);
+
+        if(it == m_uniformNames.end())
+            return handle;
+
+        // Check if the uniform has a compatible type.
+        const Uniform& uniform = m_uniforms[it->second];
+
+        if(!ShaderUniformTraits<Type>::IsCompatible(uniform.type))
+        {
+            Log() << "Uniform \"" << name << "\" has a different type than requested.";
+            return handle;
+        }
+
+        handle.index = it->second;
+
+        return handle;
+    }
+
+    template<typename Type>
+    void Shader::SetUniform(UniformHandle<Type> handle, const Type& value) const
+    {
+        if(!handle.IsValid())
+            return;
+
+        Assert(handle.index < (int)m_uniforms.size());
+
+        // Check if the value is already set.
+        const Uniform& uniform = m_uniforms[handle.index];
+        uint8_t* cachedValue = &m_uniformValues[uniform.offset];
+
+        Assert(sizeof(Type) <= uniform.cachedSize);
+
+        if(memcmp(cachedValue, &value, sizeof(Type)) == 0)
+            return;
+
+        // Upload and cache the value.
+        ShaderUniformTraits<Type>::Upload(uniform.location, value);
+
+        memcpy(cachedValue, &value, sizeof(Type));
+    }
 }
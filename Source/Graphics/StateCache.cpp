@@ -0,0 +1,303 @@
+#include "Precompiled.hpp"
+#include "StateCache.hpp"
+using namespace Graphics;
+
+namespace
+{
+    // Value of states that are not known.
+    const GLuint UnknownHandle = ~0u;
+    const int UnknownState = -1;
+
+    // Buffer targets that are cached.
+    const int BufferTargetCount = 5;
+    const GLenum BufferTargets[BufferTargetCount] =
+    {
+        GL_ARRAY_BUFFER,
+        GL_PIXEL_PACK_BUFFER,
+        GL_PIXEL_UNPACK_BUFFER,
+        GL_COPY_READ_BUFFER,
+        GL_COPY_WRITE_BUFFER,
+    };
+
+    // Framebuffer targets that are cached.
+    const int FramebufferTargetCount = 2;
+
+    // Cached states.
+    struct State
+    {
+        GLuint program;
+        GLuint vertexArray;
+        GLuint buffers[BufferTargetCount];
+        GLuint textures[StateCache::TextureUnitCount];
+        GLuint samplers[StateCache::TextureUnitCount];
+        GLuint framebuffers[FramebufferTargetCount];
+        int activeTexture;
+        int blend;
+        GLenum blendSource;
+        GLenum blendDestination;
+        int depthMask;
+    };
+
+    State state;
+    StateCache::Statistics statistics;
+
+    // Gets the index of a cached buffer target.
+    int GetBufferTargetIndex(GLenum target)
+    {
+        for(int i = 0; i < BufferTargetCount; ++i)
+        {
+            if(BufferTargets[i] == target)
+                return i;
+        }
+
+        return -1;
+    }
+
+    // Updates a cached value and returns true if it has changed.
+    template<typename Type>
+    bool UpdateState(Type& cached, Type value)
+    {
+        if(cached == value)
+        {
+            statistics.redundant += 1;
+            return false;
+        }
+
+        statistics.changes += 1;
+
+        cached = value;
+        return true;
+    }
+
+    // Forgets cached values equal to a handle.
+    template<std::size_t Size>
+    void ForgetHandle(GLuint (&cached)[Size], GLuint handle)
+    {
+        for(GLuint& value : cached)
+        {
+            if(value == handle)
+            {
+                value = UnknownHandle;
+            }
+        }
+    }
+
+    void ForgetHandle(GLuint& cached, GLuint handle)
+    {
+        if(cached == handle)
+        {
+            cached = UnknownHandle;
+        }
+    }
+
+    // Sets the active texture unit.
+    void SetActiveTexture(int unit)
+    {
+        if(UpdateState(state.activeTexture, unit))
+        {
+            glActiveTexture(GL_TEXTURE0 + unit);
+        }
+    }
+}
+
+StateCache::Statistics::Statistics() :
+    changes(0),
+    redundant(0)
+{
+}
+
+void StateCache::Reset()
+{
+    state.program = UnknownHandle;
+    state.vertexArray = UnknownHandle;
+
+    for(GLuint& buffer : state.buffers)
+    {
+        buffer = UnknownHandle;
+    }
+
+    for(int i = 0; i < TextureUnitCount; ++i)
+    {
+        state.textures[i] = UnknownHandle;
+        state.samplers[i] = UnknownHandle;
+    }
+
+    for(GLuint& framebuffer : state.framebuffers)
+    {
+        framebuffer = UnknownHandle;
+    }
+
+    state.activeTexture = UnknownState;
+    state.blend = UnknownState;
+    state.blendSource = GL_NONE;
+    state.blendDestination = GL_NONE;
+    state.depthMask = UnknownState;
+}
+
+void StateCache::BindProgram(GLuint handle)
+{
+    if(UpdateState(state.program, handle))
+    {
+        glUseProgram(handle);
+    }
+}
+
+void StateCache::BindVertexArray(GLuint handle)
+{
+    if(UpdateState(state.vertexArray, handle))
+    {
+        glBindVertexArray(handle);
+    }
+}
+
+void StateCache::BindBuffer(GLenum target, GLuint handle)
+{
+    // Bind element array buffers without any vertex array.
+    if(target == GL_ELEMENT_ARRAY_BUFFER)
+    {
+        BindVertexArray(0);
+    }
+
+    // Bind buffers of targets that are not cached every time.
+    int index = GetBufferTargetIndex(target);
+
+    if(index < 0)
+    {
+        statistics.changes += 1;
+
+        glBindBuffer(target, handle);
+        return;
+    }
+
+    if(UpdateState(state.buffers[index], handle))
+    {
+        glBindBuffer(target, handle);
+    }
+}
+
+void StateCache::BindTexture(int unit, GLuint handle)
+{
+    Assert(unit >= 0 && unit < TextureUnitCount);
+
+    if(state.textures[unit] == handle)
+    {
+        statistics.redundant += 1;
+        return;
+    }
+
+    SetActiveTexture(unit);
+
+    if(UpdateState(state.textures[unit], handle))
+    {
+        glBindTexture(GL_TEXTURE_2D, handle);
+    }
+}
+
+void StateCache::BindSampler(int unit, GLuint handle)
+{
+    Assert(unit >= 0 && unit < TextureUnitCount);
+
+    if(UpdateState(state.samplers[unit], handle))
+    {
+        glBindSampler(unit, handle);
+    }
+}
+
+void StateCache::BindFramebuffer(GLenum target, GLuint handle)
+{
+    // Binding both targets at once changes each of them.
+    if(target == GL_FRAMEBUFFER)
+    {
+        BindFramebuffer(GL_READ_FRAMEBUFFER, handle);
+        BindFramebuffer(GL_DRAW_FRAMEBUFFER, handle);
+        return;
+    }
+
+    Assert(target == GL_READ_FRAMEBUFFER || target == GL_DRAW_FRAMEBUFFER);
+
+    int index = target == GL_READ_FRAMEBUFFER ? 0 : 1;
+
+    if(UpdateState(state.framebuffers[index], handle))
+    {
+        glBindFramebuffer(target, handle);
+    }
+}
+
+void StateCache::SetBlend(bool enabled)
+{
+    if(UpdateState(state.blend, enabled ? 1 : 0))
+    {
+        if(enabled)
+        {
+            glEnable(GL_BLEND);
+        }
+        else
+        {
+            glDisable(GL_BLEND);
+        }
+    }
+}
+
+void StateCache::SetBlendFunc(GLenum source, GLenum destination)
+{
+    if(state.blendSource == source && state.blendDestination == destination)
+    {
+        statistics.redundant += 1;
+        return;
+    }
+
+    statistics.changes += 1;
+
+    state.blendSource = source;
+    state.blendDestination = destination;
+
+    glBlendFunc(source, destination);
+}
+
+void StateCache::SetDepthMask(bool enabled)
+{
+    if(UpdateState(state.depthMask, enabled ? 1 : 0))
+    {
+        glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+    }
+}
+
+void StateCache::ForgetProgram(GLuint handle)
+{
+    ForgetHandle(state.program, handle);
+}
+
+void StateCache::ForgetVertexArray(GLuint handle)
+{
+    ForgetHandle(state.vertexArray, handle);
+}
+
+void StateCache::ForgetBuffer(GLuint handle)
+{
+    ForgetHandle(state.buffers, handle);
+}
+
+void StateCache::ForgetTexture(GLuint handle)
+{
+    ForgetHandle(state.textures, handle);
+}
+
+void StateCache::ForgetSampler(GLuint handle)
+{
+    ForgetHandle(state.samplers, handle);
+}
+
+void StateCache::ForgetFramebuffer(GLuint handle)
+{
+    ForgetHandle(state.framebuffers, handle);
+}
+
+void StateCache::ResetStatistics()
+{
+    statistics = Statistics();
+}
+
+const StateCache::Statistics& StateCache::GetStatistics()
+{
+    return statistics;
+}
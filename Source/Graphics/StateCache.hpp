@@ -0,0 +1,89 @@
+#pragma once
+
+#include "Precompiled.hpp"
+
+//
+// State Cache
+//
+//  Tracks bound OpenGL objects and fixed function states, so redundant
+//  calls are filtered out. Graphics classes change states through it,
+//  which lets consecutive draws leave their states bound for the next ones.
+//
+//  Example usage:
+//      Graphics::StateCache::BindProgram(shader.GetHandle());
+//      Graphics::StateCache::BindVertexArray(vertexInput.GetHandle());
+//      Graphics::StateCache::BindTexture(0, texture.GetHandle());
+//      Graphics::StateCache::SetBlend(true);
+//
+//      glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+//
+//  All states start unknown and are always set on their first change.
+//  Deleted objects have to be forgotten, as their names can be reused.
+//  Calls made directly to OpenGL are not seen by the cache, so Reset()
+//  has to be called after such calls or when a context is created.
+//
+//  Element array buffer binding is a part of the vertex array state.
+//  It is never cached and binding it unbinds the current vertex array.
+//
+
+namespace Graphics
+{
+    namespace StateCache
+    {
+        // Statistics structure.
+        struct Statistics
+        {
+            Statistics();
+
+            int changes;
+            int redundant;
+        };
+
+        // Maximum number of tracked texture units.
+        const int TextureUnitCount = 16;
+
+        // Forgets all cached states.
+        void Reset();
+
+        // Binds a shader program.
+        void BindProgram(GLuint handle);
+
+        // Binds a vertex array.
+        void BindVertexArray(GLuint handle);
+
+        // Binds a buffer to a target.
+        void BindBuffer(GLenum target, GLuint handle);
+
+        // Binds a 2D texture to a texture unit.
+        void BindTexture(int unit, GLuint handle);
+
+        // Binds a sampler to a texture unit.
+        void BindSampler(int unit, GLuint handle);
+
+        // Binds a framebuffer to a target.
+        void BindFramebuffer(GLenum target, GLuint handle);
+
+        // Sets alpha blending.
+        void SetBlend(bool enabled);
+
+        // Sets the blending function.
+        void SetBlendFunc(GLenum source, GLenum destination);
+
+        // Sets depth writing.
+        void SetDepthMask(bool enabled);
+
+        // Forgets bindings of deleted objects.
+        void ForgetProgram(GLuint handle);
+        void ForgetVertexArray(GLuint handle);
+        void ForgetBuffer(GLuint handle);
+        void ForgetTexture(GLuint handle);
+        void ForgetSampler(GLuint handle);
+        void ForgetFramebuffer(GLuint handle);
+
+        // Resets state change statistics.
+        void ResetStatistics();
+
+        // Gets state change statistics since the last reset.
+        const Statistics& GetStatistics();
+    }
+}
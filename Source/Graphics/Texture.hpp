@@ -3,11 +3,19 @@
 #include "Precompiled.hpp"
 #include "System/Resource.hpp"
 
+// Forward declarations.
+namespace Graphics
+{
+    class TextureContainer;
+    class TextureLoader;
+    struct TextureRequest;
+}
+
 //
 // Texture
 //
 //  Encapsulates an OpenGL texture surface.
-//  Can also load images from PNG files.
+//  Can also load images from PNG files and cooked texture containers.
 //
 //  Example usage:
 //      Graphics::Texture texture;
@@ -15,6 +23,14 @@
 //      
 //      GLuint texture = texture.GetHandle();
 //
+//  Textures loaded by a resource manager with a texture loader in its
+//  context are decoded on worker threads and uploaded later. Such textures
+//  are pending and not valid until the upload is done. See TextureLoader.
+//
+//  When a cooked texture container exists next to the PNG file (with the
+//  same name and a .tex extension), it is mapped and uploaded instead of
+//  decoding the PNG file. See TextureContainer.
+//
 
 namespace Graphics
 {
@@ -34,6 +50,9 @@ namespace Graphics
         // Initializes the texture instance.
         bool Initialize(int width, int height, GLenum format, const void* data);
 
+        // Initializes the texture with mipmap levels of a texture container.
+        bool Initialize(const TextureContainer& container);
+
         // Updates the texture data.
         void Update(const void* data);
 
@@ -61,6 +80,12 @@ namespace Graphics
             return m_initialized;
         }
 
+        // Checks if the texture waits for an asynchronous upload.
+        bool IsPending() const
+        {
+            return m_request != nullptr;
+        }
+
     private:
         // Texture handle.
         GLuint m_handle;
@@ -70,7 +95,13 @@ namespace Graphics
         int m_height;
         GLenum m_format;
 
+        // Pending load request.
+        std::shared_ptr<TextureRequest> m_request;
+
         // Initialization state.
         bool m_initialized;
+
+        // Allow the texture loader to finish pending loads.
+        friend class TextureLoader;
     };
 }
@@ -0,0 +1,364 @@
+#include "Precompiled.hpp"
+#include "TextureAtlas.hpp"
+#include "Texture.hpp"
+#include "StateCache.hpp"
+using namespace Graphics;
+
+namespace
+{
+    // Log error messages.
+    #define LogInitializeError() "Failed to initialize a texture atlas! "
+
+    // Constant definitions.
+    const GLuint InvalidHandle = 0;
+}
+
+const int TextureAtlas::PageSize;
+const int TextureAtlas::Padding;
+
+TextureAtlas::TextureAtlas() :
+    m_pageSize(0),
+    m_initialized(false)
+{
+    m_framebuffers[0] = InvalidHandle;
+    m_framebuffers[1] = InvalidHandle;
+}
+
+TextureAtlas::~TextureAtlas()
+{
+    this->Cleanup();
+}
+
+void TextureAtlas::Cleanup()
+{
+    if(!m_initialized)
+        return;
+
+    // Release copy framebuffers.
+    if(m_framebuffers[0] != InvalidHandle)
+    {
+        StateCache::ForgetFramebuffer(m_framebuffers[0]);
+        StateCache::ForgetFramebuffer(m_framebuffers[1]);
+
+        glDeleteFramebuffers(2, &m_framebuffers[0]);
+
+        m_framebuffers[0] = InvalidHandle;
+        m_framebuffers[1] = InvalidHandle;
+    }
+
+    // Release atlas pages and regions.
+    Utility::ClearContainer(m_pages);
+    Utility::ClearContainer(m_regions);
+
+    m_pageSize = 0;
+
+    // Reset initialization state.
+    m_initialized = false;
+}
+
+bool TextureAtlas::Initialize(int pageSize)
+{
+    this->Cleanup();
+
+    // Setup a cleanup guard.
+    SCOPE_GUARD
+    (
+        if(!m_initialized)
+        {
+            m_initialized = true;
+            this->Cleanup();
+        }
+    );
+
+    // Validate arguments.
+    if(pageSize <= Padding * 2)
+    {
+        Log() << LogInitializeError() << "Invalid argument - \"pageSize\" is invalid.";
+        return false;
+    }
+
+    m_pageSize = pageSize;
+
+    // Create copy framebuffers.
+    glGenFramebuffers(2, &m_framebuffers[0]);
+
+    if(m_framebuffers[0] == InvalidHandle || m_framebuffers[1] == InvalidHandle)
+    {
+        Log() << LogInitializeError() << "Couldn't create framebuffers.";
+        return false;
+    }
+
+    // Success!
+    return m_initialized = true;
+}
+
+const TextureAtlas::Entry& TextureAtlas::Add(TexturePtr texture)
+{
+    Assert(texture != nullptr);
+
+    // Check if the texture has already been added.
+    auto it = m_regions.find(texture.get());
+
+    if(it != m_regions.end())
+    {
+        if(!it->second.source.expired())
+            return it->second.entry;
+
+        // Address of a released texture has been reused.
+        this->Release(it->second);
+        m_regions.erase(it);
+    }
+
+    // Keep the original texture by default.
+    Region region;
+    region.source = texture;
+    region.entry.texture = texture.get();
+    region.entry.offset = glm::vec2(0.0f, 0.0f);
+    region.rectangle = glm::ivec4(0, 0, 0, 0);
+    region.page = -1;
+
+    // Pack the texture with its padding into one of the pages.
+    if(m_initialized && texture->IsValid())
+    {
+        int width = texture->GetWidth() + Padding * 2;
+        int height = texture->GetHeight() + Padding * 2;
+
+        int page = 0;
+        int x = 0;
+        int y = 0;
+
+        if(this->Pack(width, height, page, x, y))
+        {
+            region.rectangle = glm::ivec4(x, y, width, height);
+            region.page = page;
+
+            if(this->Copy(*texture, *m_pages[page].texture, x + Padding, y + Padding))
+            {
+                region.entry.texture = m_pages[page].texture.get();
+                region.entry.offset = glm::vec2(x + Padding, y + Padding);
+            }
+
+            m_pages[page].entryCount += 1;
+        }
+    }
+
+    // Add the region without keeping the texture alive.
+    return m_regions.emplace(texture.get(), region).first->second.entry;
+}
+
+void TextureAtlas::ReleaseUnused()
+{
+    // Reclaim regions of released textures.
+    for(auto it = m_regions.begin(); it != m_regions.end();)
+    {
+        if(it->second.source.expired())
+        {
+            this->Release(it->second);
+            it = m_regions.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+void TextureAtlas::Release(const Region& region)
+{
+    // Textures left as they are have no region.
+    if(region.page < 0)
+        return;
+
+    Page& page = m_pages[region.page];
+
+    Assert(page.entryCount > 0);
+    page.entryCount -= 1;
+
+    // Rebuild the page from scratch once it is empty.
+    if(page.entryCount == 0)
+    {
+        page.shelves.clear();
+        page.freeRegions.clear();
+        page.height = 0;
+        return;
+    }
+
+    page.freeRegions.push_back(region.rectangle);
+}
+
+int TextureAtlas::GetPageCount() const
+{
+    return (int)m_pages.size();
+}
+
+bool TextureAtlas::Pack(int width, int height, int& page, int& x, int& y)
+{
+    // Check if the rectangle fits in a page at all.
+    if(width > m_pageSize || height > m_pageSize)
+        return false;
+
+    // Find a page with a place for the rectangle.
+    for(std::size_t i = 0; i <= m_pages.size(); ++i)
+    {
+        // Create a new page if none of existing ones has space left.
+        if(i == m_pages.size())
+        {
+            Page newPage;
+            newPage.texture = std::make_unique<Texture>();
+            newPage.entryCount = 0;
+            newPage.height = 0;
+
+            if(!newPage.texture->Initialize(m_pageSize, m_pageSize, GL_RGBA, nullptr))
+            {
+                Log() << "Couldn't create a texture atlas page.";
+                return false;
+            }
+
+            m_pages.push_back(std::move(newPage));
+
+            Log() << "Created a texture atlas page (" << m_pageSize << "x" << m_pageSize << ").";
+        }
+
+        Page& current = m_pages[i];
+
+        // Reuse regions of released textures first.
+        if(this->PackFree(current, width, height, x, y))
+        {
+            page = (int)i;
+            return true;
+        }
+
+        // Find the shelf that wastes the least space.
+        Shelf* bestShelf = nullptr;
+
+        for(Shelf& shelf : current.shelves)
+        {
+            if(shelf.height < height || m_pageSize - shelf.width < width)
+                continue;
+
+            if(bestShelf == nullptr || shelf.height < bestShelf->height)
+            {
+                bestShelf = &shelf;
+            }
+        }
+
+        // Open a new shelf if there is space left.
+        if(bestShelf == nullptr && m_pageSize - current.height >= height)
+        {
+            Shelf shelf;
+            shelf.y = current.height;
+            shelf.width = 0;
+            shelf.height = height;
+
+            current.shelves.push_back(shelf);
+            current.height += height;
+
+            bestShelf = &current.shelves.back();
+        }
+
+        // Place the rectangle on the shelf.
+        if(bestShelf != nullptr)
+        {
+            page = (int)i;
+            x = bestShelf->width;
+            y = bestShelf->y;
+
+            bestShelf->width += width;
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool TextureAtlas::PackFree(Page& page, int width, int height, int& x, int& y)
+{
+    // Find the smallest free region that fits the rectangle.
+    auto best = page.freeRegions.end();
+
+    for(auto it = page.freeRegions.begin(); it != page.freeRegions.end(); ++it)
+    {
+        if(it->z < width || it->w < height)
+            continue;
+
+        if(best == page.freeRegions.end() || it->z * it->w < best->z * best->w)
+        {
+            best = it;
+        }
+    }
+
+    if(best == page.freeRegions.end())
+        return false;
+
+    // Place the rectangle in the corner of the region.
+    glm::ivec4 region = *best;
+    page.freeRegions.erase(best);
+
+    x = region.x;
+    y = region.y;
+
+    // Split the space left into regions on the right and above.
+    if(region.z > width)
+    {
+        page.freeRegions.push_back(glm::ivec4(region.x + width, region.y, region.z - width, height));
+    }
+
+    if(region.w > height)
+    {
+        page.freeRegions.push_back(glm::ivec4(region.x, region.y + height, region.z, region.w - height));
+    }
+
+    return true;
+}
+
+bool TextureAtlas::Copy(const Texture& texture, const Texture& page, int x, int y)
+{
+    // Restore framebuffer bindings after we are done.
+    SCOPE_GUARD
+    (
+        StateCache::BindFramebuffer(GL_FRAMEBUFFER, 0);
+    );
+
+    // Attach textures to copy framebuffers.
+    StateCache::BindFramebuffer(GL_READ_FRAMEBUFFER, m_framebuffers[0]);
+    glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture.GetHandle(), 0);
+
+    StateCache::BindFramebuffer(GL_DRAW_FRAMEBUFFER, m_framebuffers[1]);
+    glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, page.GetHandle(), 0);
+
+    if(glCheckFramebufferStatus(GL_READ_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE ||
+       glCheckFramebufferStatus(GL_DRAW_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+        Log() << "Couldn't copy a texture to a texture atlas page.";
+        return false;
+    }
+
+    // Copy the texture, then stretch its edge texels over the padding.
+    int width = texture.GetWidth();
+    int height = texture.GetHeight();
+
+    const glm::ivec4 columns[3] =
+    {
+        glm::ivec4(0, 1, x - Padding, x),
+        glm::ivec4(0, width, x, x + width),
+        glm::ivec4(width - 1, width, x + width, x + width + Padding),
+    };
+
+    const glm::ivec4 rows[3] =
+    {
+        glm::ivec4(0, 1, y - Padding, y),
+        glm::ivec4(0, height, y, y + height),
+        glm::ivec4(height - 1, height, y + height, y + height + Padding),
+    };
+
+    for(const glm::ivec4& row : rows)
+    {
+        for(const glm::ivec4& column : columns)
+        {
+            glBlitFramebuffer(column.x, row.x, column.y, row.y, column.z, row.z, column.w, row.w, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include "Precompiled.hpp"
+
+// Forward declarations.
+namespace Graphics
+{
+    class Texture;
+}
+
+//
+// Texture Atlas
+//
+//  Packs textures into shared atlas pages, so sprites using different
+//  textures can be drawn in a single batch.
+//
+//  Example usage:
+//      Graphics::TextureAtlas textureAtlas;
+//      textureAtlas.Initialize();
+//
+//      const auto& entry = textureAtlas.Add(texture);
+//
+//      info.texture = entry.texture;
+//      data.rectangle.x += entry.offset.x;
+//      data.rectangle.y += entry.offset.y;
+//
+//  Textures are packed on shelves of pages and copied on the GPU. Edge
+//  texels of each texture are extruded into the padding around it, so
+//  filtering near edges does not sample neighbouring textures. Textures
+//  that do not fit in a page are left as they are.
+//
+//  Added textures are referenced weakly. Regions of released textures are
+//  reclaimed by ReleaseUnused() and reused by textures that fit in them.
+//  Pages without any textures left are rebuilt from scratch. Entries of
+//  released textures must not be used after their regions are reclaimed.
+//
+
+namespace Graphics
+{
+    // Texture atlas class.
+    class TextureAtlas
+    {
+    public:
+        // Type declarations.
+        typedef std::shared_ptr<const Texture> TexturePtr;
+
+        // Atlas entry structure.
+        struct Entry
+        {
+            const Texture* texture;
+            glm::vec2 offset;
+        };
+
+        // Constant variables.
+        static const int PageSize = 2048;
+        static const int Padding = 2;
+
+    public:
+        TextureAtlas();
+        ~TextureAtlas();
+
+        // Restores instance to it's original state.
+        void Cleanup();
+
+        // Initializes the texture atlas.
+        bool Initialize(int pageSize = PageSize);
+
+        // Adds a texture to the atlas.
+        // Returns the original texture if it cannot be packed.
+        const Entry& Add(TexturePtr texture);
+
+        // Reclaims regions of released textures.
+        void ReleaseUnused();
+
+        // Gets the number of atlas pages.
+        int GetPageCount() const;
+
+    private:
+        // Shelf structure.
+        struct Shelf
+        {
+            int y;
+            int width;
+            int height;
+        };
+
+        // Page structure.
+        struct Page
+        {
+            std::unique_ptr<Texture> texture;
+            std::vector<Shelf> shelves;
+            std::vector<glm::ivec4> freeRegions;
+            int entryCount;
+            int height;
+        };
+
+        // Region structure.
+        struct Region
+        {
+            std::weak_ptr<const Texture> source;
+            Entry entry;
+            glm::ivec4 rectangle;
+            int page;
+        };
+
+        // Finds a place for a rectangle of a given size.
+        bool Pack(int width, int height, int& page, int& x, int& y);
+
+        // Finds a place for a rectangle in reclaimed regions of a page.
+        bool PackFree(Page& page, int width, int height, int& x, int& y);
+
+        // Returns a region of a released texture to its page.
+        void Release(const Region& region);
+
+        // Copies a texture to a page and extrudes its edges.
+        bool Copy(const Texture& texture, const Texture& page, int x, int y);
+
+    private:
+        // Atlas pages.
+        std::vector<Page> m_pages;
+        int m_pageSize;
+
+        // Atlas regions of added textures.
+        std::unordered_map<const Texture*, Region> m_regions;
+
+        // Copy framebuffers.
+        GLuint m_framebuffers[2];
+
+        // Initialization state.
+        bool m_initialized;
+    };
+}
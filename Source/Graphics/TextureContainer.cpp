@@ -0,0 +1,417 @@
+#include "Precompiled.hpp"
+#include "TextureContainer.hpp"
+#include "Image.hpp"
+using namespace Graphics;
+
+#ifndef WIN32
+    #include <sys/stat.h>
+#endif
+
+namespace
+{
+    // Log error messages.
+    #define LogLoadError(filename) "Failed to load a texture container from \"" << filename << "\" file! "
+    #define LogCookError(filename) "Failed to cook a texture container to \"" << filename << "\" file! "
+
+    // Rounds a value up to a multiple of an alignment.
+    uint32_t AlignUp(uint32_t value, uint32_t alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    // Calculates the size of a padded row of pixels.
+    uint32_t CalculateRowSize(int width, int channels)
+    {
+        return AlignUp(width * channels, TextureContainer::RowAlignment);
+    }
+
+    // Gets the modification time and the size of a file.
+    bool GetFileStamp(std::string filename, uint64_t& time, uint64_t& size)
+    {
+        std::string path = Build::GetWorkingDir() + filename;
+
+        #ifdef WIN32
+            WIN32_FILE_ATTRIBUTE_DATA attributes;
+
+            if(!GetFileAttributesExA(path.c_str(), GetFileExInfoStandard, &attributes))
+                return false;
+
+            time = ((uint64_t)attributes.ftLastWriteTime.dwHighDateTime << 32) | attributes.ftLastWriteTime.dwLowDateTime;
+            size = ((uint64_t)attributes.nFileSizeHigh << 32) | attributes.nFileSizeLow;
+        #else
+            struct stat status;
+
+            if(stat(path.c_str(), &status) != 0)
+                return false;
+
+            time = (uint64_t)status.st_mtime;
+            size = (uint64_t)status.st_size;
+        #endif
+
+        return true;
+    }
+
+    // Downsamples an image to half of its size by averaging blocks of pixels.
+    void Downsample(const Image& source, Image& target)
+    {
+        int width = std::max(source.GetWidth() / 2, 1);
+        int height = std::max(source.GetHeight() / 2, 1);
+        int channels = Image::GetChannelCount(source.GetFormat());
+
+        target.Initialize(width, height, source.GetFormat());
+
+        const uint8_t* input = source.GetData();
+        uint8_t* output = target.GetData();
+
+        for(int y = 0; y < height; ++y)
+        {
+            int y0 = std::min(y * 2, source.GetHeight() - 1);
+            int y1 = std::min(y * 2 + 1, source.GetHeight() - 1);
+
+            for(int x = 0; x < width; ++x)
+            {
+                int x0 = std::min(x * 2, source.GetWidth() - 1);
+                int x1 = std::min(x * 2 + 1, source.GetWidth() - 1);
+
+                for(int c = 0; c < channels; ++c)
+                {
+                    int sum = 0;
+                    sum += input[(y0 * source.GetWidth() + x0) * channels + c];
+                    sum += input[(y0 * source.GetWidth() + x1) * channels + c];
+                    sum += input[(y1 * source.GetWidth() + x0) * channels + c];
+                    sum += input[(y1 * source.GetWidth() + x1) * channels + c];
+
+                    output[(y * width + x) * channels + c] = (uint8_t)((sum + 2) / 4);
+                }
+            }
+        }
+    }
+}
+
+const uint32_t TextureContainer::Magic;
+const uint32_t TextureContainer::Version;
+const int TextureContainer::MaximumLevelCount;
+const int TextureContainer::RowAlignment;
+const int TextureContainer::DataAlignment;
+
+TextureContainer::TextureContainer() :
+    m_header(nullptr),
+    m_levels(nullptr),
+    m_initialized(false)
+{
+}
+
+TextureContainer::~TextureContainer()
+{
+    this->Cleanup();
+}
+
+void TextureContainer::Cleanup()
+{
+    if(!m_initialized)
+        return;
+
+    // Unmap the file.
+    m_file.Cleanup();
+
+    m_header = nullptr;
+    m_levels = nullptr;
+
+    // Reset initialization state.
+    m_initialized = false;
+}
+
+bool TextureContainer::Load(std::string filename, std::string sourceFilename)
+{
+    this->Cleanup();
+
+    // Setup a cleanup guard.
+    SCOPE_GUARD
+    (
+        if(!m_initialized)
+        {
+            m_initialized = true;
+            this->Cleanup();
+        }
+    );
+
+    // Map the file.
+    if(!m_file.Open(filename))
+        return false;
+
+    const uint8_t* data = m_file.GetData();
+    std::size_t size = m_file.GetSize();
+
+    // Validate the header.
+    if(size < sizeof(Header))
+    {
+        Log() << LogLoadError(filename) << "File is too small.";
+        return false;
+    }
+
+    m_header = (const Header*)data;
+
+    if(m_header->magic != Magic)
+    {
+        Log() << LogLoadError(filename) << "Not a valid texture container.";
+        return false;
+    }
+
+    if(m_header->version != Version)
+    {
+        Log() << LogLoadError(filename) << "Unsupported version.";
+        return false;
+    }
+
+    if(m_header->flags != 0)
+    {
+        Log() << LogLoadError(filename) << "Unsupported flags.";
+        return false;
+    }
+
+    if(m_header->width == 0 || m_header->height == 0)
+    {
+        Log() << LogLoadError(filename) << "Invalid texture size.";
+        return false;
+    }
+
+    if(m_header->levelCount == 0 || m_header->levelCount > MaximumLevelCount)
+    {
+        Log() << LogLoadError(filename) << "Invalid number of mipmap levels.";
+        return false;
+    }
+
+    // Reject the container if its source file has changed since cooking.
+    // Container is loaded without its source file if there is none.
+    uint64_t sourceTime = 0;
+    uint64_t sourceSize = 0;
+
+    if(!sourceFilename.empty() && GetFileStamp(sourceFilename, sourceTime, sourceSize))
+    {
+        if(m_header->sourceTime != sourceTime || m_header->sourceSize != sourceSize)
+        {
+            Log() << LogLoadError(filename) << "Source file has changed since cooking.";
+            return false;
+        }
+    }
+
+    // Validate mipmap levels.
+    if(size < sizeof(Header) + sizeof(Level) * m_header->levelCount)
+    {
+        Log() << LogLoadError(filename) << "File is too small.";
+        return false;
+    }
+
+    m_levels = (const Level*)(data + sizeof(Header));
+
+    int channels = Image::GetChannelCount(m_header->format);
+
+    if(channels == 0)
+    {
+        Log() << LogLoadError(filename) << "Unsupported pixel format.";
+        return false;
+    }
+
+    for(uint32_t i = 0; i < m_header->levelCount; ++i)
+    {
+        const Level& level = m_levels[i];
+
+        // Each level halves the size of the previous one.
+        if(level.width != std::max(m_header->width >> i, 1u) || level.height != std::max(m_header->height >> i, 1u))
+        {
+            Log() << LogLoadError(filename) << "Invalid mipmap level dimensions.";
+            return false;
+        }
+
+        if(level.offset % DataAlignment != 0 || (uint64_t)level.offset + level.size > size)
+        {
+            Log() << LogLoadError(filename) << "Invalid mipmap level data.";
+            return false;
+        }
+
+        if(level.size != CalculateRowSize(level.width, channels) * level.height)
+        {
+            Log() << LogLoadError(filename) << "Invalid mipmap level size.";
+            return false;
+        }
+    }
+
+    // Success!
+    return m_initialized = true;
+}
+
+bool TextureContainer::Cook(const Image& image, std::string filename, std::string sourceFilename)
+{
+    // Validate arguments.
+    if(!image.IsValid())
+    {
+        Log() << LogCookError(filename) << "Invalid argument - \"image\" is invalid.";
+        return false;
+    }
+
+    int channels = Image::GetChannelCount(image.GetFormat());
+
+    if(channels == 0)
+    {
+        Log() << LogCookError(filename) << "Unsupported pixel format.";
+        return false;
+    }
+
+    // Get the stamp of the source file.
+    uint64_t sourceTime = 0;
+    uint64_t sourceSize = 0;
+
+    if(!GetFileStamp(sourceFilename, sourceTime, sourceSize))
+    {
+        Log() << LogCookError(filename) << "Couldn't get the modification time of the source file.";
+        return false;
+    }
+
+    // Create the mipmap chain.
+    std::vector<Image> images;
+    images.reserve(MaximumLevelCount);
+
+    images.emplace_back();
+    images[0].Initialize(image.GetWidth(), image.GetHeight(), image.GetFormat());
+    memcpy(images[0].GetData(), image.GetData(), image.GetSize());
+
+    while((images.back().GetWidth() > 1 || images.back().GetHeight() > 1) && (int)images.size() < MaximumLevelCount)
+    {
+        images.emplace_back();
+        Downsample(images[images.size() - 2], images.back());
+    }
+
+    // Fill the header.
+    Header header;
+    header.magic = Magic;
+    header.version = Version;
+    header.width = image.GetWidth();
+    header.height = image.GetHeight();
+    header.format = image.GetFormat();
+    header.flags = 0;
+    header.levelCount = (uint32_t)images.size();
+    header.reserved = 0;
+    header.sourceTime = sourceTime;
+    header.sourceSize = sourceSize;
+
+    // Lay out mipmap levels after the header.
+    std::vector<Level> levels(images.size());
+
+    uint32_t offset = sizeof(Header) + sizeof(Level) * header.levelCount;
+
+    for(std::size_t i = 0; i < images.size(); ++i)
+    {
+        offset = AlignUp(offset, DataAlignment);
+
+        levels[i].width = images[i].GetWidth();
+        levels[i].height = images[i].GetHeight();
+        levels[i].offset = offset;
+        levels[i].size = CalculateRowSize(levels[i].width, channels) * levels[i].height;
+
+        offset += levels[i].size;
+    }
+
+    // Write the file.
+    std::ofstream file(Build::GetWorkingDir() + filename, std::ios::binary | std::ios::trunc);
+
+    if(!file.is_open())
+    {
+        Log() << LogCookError(filename) << "Couldn't open the file.";
+        return false;
+    }
+
+    file.write((const char*)&header, sizeof(Header));
+    file.write((const char*)levels.data(), sizeof(Level) * levels.size());
+
+    const char padding[DataAlignment] = { 0 };
+
+    for(std::size_t i = 0; i < images.size(); ++i)
+    {
+        // Pad to the start of the level.
+        std::size_t position = (std::size_t)file.tellp();
+        file.write(padding, levels[i].offset - position);
+
+        // Write padded rows.
+        uint32_t rowSize = levels[i].width * channels;
+        uint32_t paddedSize = CalculateRowSize(levels[i].width, channels);
+
+        for(uint32_t y = 0; y < levels[i].height; ++y)
+        {
+            file.write((const char*)images[i].GetData() + y * rowSize, rowSize);
+            file.write(padding, paddedSize - rowSize);
+        }
+    }
+
+    if(!file.good())
+    {
+        Log() << LogCookError(filename) << "Couldn't write the file.";
+        return false;
+    }
+
+    // Success!
+    Log() << "Cooked a texture container to \"" << filename << "\" file (" << header.levelCount << " levels).";
+
+    return true;
+}
+
+std::string TextureContainer::GetCookedFilename(std::string filename)
+{
+    // Replace the file extension.
+    std::size_t separator = filename.find_last_of("/\\");
+    std::size_t dot = filename.find_last_of('.');
+
+    if(dot != std::string::npos && (separator == std::string::npos || dot > separator))
+    {
+        filename.erase(dot);
+    }
+
+    return filename + ".tex";
+}
+
+int TextureContainer::GetWidth() const
+{
+    if(!m_initialized)
+        return 0;
+
+    return m_header->width;
+}
+
+int TextureContainer::GetHeight() const
+{
+    if(!m_initialized)
+        return 0;
+
+    return m_header->height;
+}
+
+GLenum TextureContainer::GetFormat() const
+{
+    if(!m_initialized)
+        return GL_NONE;
+
+    return m_header->format;
+}
+
+int TextureContainer::GetLevelCount() const
+{
+    if(!m_initialized)
+        return 0;
+
+    return m_header->levelCount;
+}
+
+const TextureContainer::Level& TextureContainer::GetLevel(int index) const
+{
+    Assert(m_initialized);
+    Assert(index >= 0 && index < (int)m_header->levelCount);
+
+    return m_levels[index];
+}
+
+const void* TextureContainer::GetLevelData(int index) const
+{
+    Assert(m_initialized);
+    Assert(index >= 0 && index < (int)m_header->levelCount);
+
+    return m_file.GetData() + m_levels[index].offset;
+}
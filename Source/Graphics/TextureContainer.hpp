@@ -0,0 +1,133 @@
+#pragma once
+
+#include "Precompiled.hpp"
+#include "System/MappedFile.hpp"
+
+// Forward declarations.
+namespace Graphics
+{
+    class Image;
+}
+
+//
+// Texture Container
+//
+//  Engine native texture file that is cooked offline from source images,
+//  so textures can be uploaded straight from a memory mapped file without
+//  decoding or converting anything at run time.
+//
+//  Cooking a texture:
+//      Graphics::Image image;
+//      image.Load("Data/Textures/Texture.png");
+//
+//      Graphics::TextureContainer::Cook(image, "Data/Textures/Texture.tex", "Data/Textures/Texture.png");
+//
+//  Loading a texture:
+//      Graphics::TextureContainer container;
+//      container.Load("Data/Textures/Texture.tex", "Data/Textures/Texture.png");
+//
+//      texture.Initialize(container);
+//
+//  File starts with a header followed by a table of mipmap levels and
+//  their pixel data. Each level starts at an aligned offset and its rows
+//  are padded to the default unpack alignment of OpenGL. Levels are
+//  uncompressed and form a full mipmap chain.
+//
+//  Header stores the modification time and the size of the source file.
+//  Containers whose source file has changed since cooking are rejected,
+//  so the source file is loaded instead until it is cooked again.
+//
+//  Values are stored in the little endian byte order.
+//
+
+namespace Graphics
+{
+    // Texture container class.
+    class TextureContainer
+    {
+    public:
+        // File header structure.
+        struct Header
+        {
+            uint32_t magic;
+            uint32_t version;
+            uint32_t width;
+            uint32_t height;
+            uint32_t format;
+            uint32_t flags;
+            uint32_t levelCount;
+            uint32_t reserved;
+            uint64_t sourceTime;
+            uint64_t sourceSize;
+        };
+
+        // Mipmap level structure.
+        struct Level
+        {
+            uint32_t width;
+            uint32_t height;
+            uint32_t offset;
+            uint32_t size;
+        };
+
+        // Constant variables.
+        static const uint32_t Magic = 0x43584554; // "TEXC"
+        static const uint32_t Version = 2;
+        static const int MaximumLevelCount = 16;
+        static const int RowAlignment = 4;
+        static const int DataAlignment = 16;
+
+    public:
+        TextureContainer();
+        ~TextureContainer();
+
+        // Restores instance to it's original state.
+        void Cleanup();
+
+        // Loads the container by mapping its file.
+        // Returns false without logging if the file does not exist.
+        // Returns false if the source file has changed since cooking.
+        bool Load(std::string filename, std::string sourceFilename);
+
+        // Cooks an image loaded from a source file into a container file.
+        static bool Cook(const Image& image, std::string filename, std::string sourceFilename);
+
+        // Gets the filename of the cooked version of a source file.
+        static std::string GetCookedFilename(std::string filename);
+
+        // Gets the texture width.
+        int GetWidth() const;
+
+        // Gets the texture height.
+        int GetHeight() const;
+
+        // Gets the pixel format.
+        GLenum GetFormat() const;
+
+        // Gets the number of mipmap levels.
+        int GetLevelCount() const;
+
+        // Gets a mipmap level.
+        const Level& GetLevel(int index) const;
+
+        // Gets pixel data of a mipmap level.
+        const void* GetLevelData(int index) const;
+
+        // Checks if instance is valid.
+        bool IsValid() const
+        {
+            return m_initialized;
+        }
+
+    private:
+        // Mapped file.
+        System::MappedFile m_file;
+
+        // Header and levels in the mapped file.
+        const Header* m_header;
+        const Level* m_levels;
+
+        // Initialization state.
+        bool m_initialized;
+    };
+}
@@ -0,0 +1,362 @@
+#include "Precompiled.hpp"
+#include "TextureLoader.hpp"
+#include "StateCache.hpp"
+#include "System/ResourceManager.hpp"
+#include "Context.hpp"
+using namespace Graphics;
+
+namespace
+{
+    // Log error messages.
+    #define LogInitializeError() "Failed to initialize the texture loader! "
+    #define LogLoadError(filename) "Failed to load a texture from \"" << filename << "\" file! "
+
+    // Size of memory pages touched when reading mapped files.
+    const std::size_t PageSize = 4096;
+
+    // Gets the number of bytes uploaded for a request.
+    std::size_t GetUploadSize(const TextureRequest& request)
+    {
+        if(request.container.IsValid())
+        {
+            std::size_t size = 0;
+
+            for(int i = 0; i < request.container.GetLevelCount(); ++i)
+            {
+                size += request.container.GetLevel(i).size;
+            }
+
+            return size;
+        }
+
+        return request.image.GetSize();
+    }
+}
+
+const int TextureLoader::DefaultUploadBudget;
+
+TextureLoader::TextureLoader() :
+    m_jobSystem(nullptr),
+    m_resourceManager(nullptr),
+    m_uploadBudget(DefaultUploadBudget),
+    m_initialized(false)
+{
+}
+
+TextureLoader::~TextureLoader()
+{
+    this->Cleanup();
+}
+
+void TextureLoader::Cleanup()
+{
+    if(!m_initialized)
+        return;
+
+    // Cancel queued requests.
+    // Running jobs keep their requests alive until they finish.
+    for(RequestPtr& request : m_requests)
+    {
+        if(request->texture != nullptr)
+        {
+            request->texture->m_request = nullptr;
+            request->texture = nullptr;
+        }
+
+        request->job = nullptr;
+    }
+
+    Utility::ClearContainer(m_requests);
+
+    // Cleanup the staging buffer.
+    m_pixelBuffer.Cleanup();
+
+    // Reset context references.
+    m_jobSystem = nullptr;
+    m_resourceManager = nullptr;
+
+    // Reset the upload budget.
+    m_uploadBudget = DefaultUploadBudget;
+
+    // Reset initialization state.
+    m_initialized = false;
+}
+
+bool TextureLoader::Initialize(Context& context)
+{
+    Assert(context.jobSystem != nullptr);
+    Assert(context.textureLoader == nullptr);
+
+    // Cleanup this instance.
+    this->Cleanup();
+
+    // Setup a cleanup guard.
+    SCOPE_GUARD
+    (
+        if(!m_initialized)
+        {
+            m_initialized = true;
+            this->Cleanup();
+        }
+    );
+
+    // Get required context instances.
+    m_jobSystem = context.jobSystem;
+
+    // Get optional context instances.
+    m_resourceManager = context.resourceManager;
+
+    // Create the staging buffer.
+    if(!m_pixelBuffer.Initialize(1, DefaultUploadBudget, nullptr, GL_STREAM_DRAW))
+    {
+        Log() << LogInitializeError() << "Couldn't create a pixel buffer.";
+        return false;
+    }
+
+    // Unbind the pixel buffer, so other uploads read from client memory.
+    StateCache::BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    // Set context instance.
+    context.textureLoader = this;
+
+    // Success!
+    return m_initialized = true;
+}
+
+bool TextureLoader::Queue(Texture& texture, std::string filename)
+{
+    if(!m_initialized)
+        return false;
+
+    Assert(texture.m_request == nullptr);
+
+    // Create a request.
+    RequestPtr request = std::make_shared<TextureRequest>();
+    request->texture = &texture;
+    request->filename = filename;
+
+    texture.m_request = request;
+
+    // Schedule a job that loads the cooked container or decodes the image.
+    // Job holds the request until it is removed from the queue.
+    request->job = m_jobSystem->Schedule([request]()
+    {
+        if(request->container.Load(TextureContainer::GetCookedFilename(request->filename), request->filename))
+        {
+            // Touch pages of the mapped file, so they are read here instead of during the upload.
+            int levelCount = request->container.GetLevelCount();
+
+            const TextureContainer::Level& first = request->container.GetLevel(0);
+            const TextureContainer::Level& last = request->container.GetLevel(levelCount - 1);
+
+            const volatile uint8_t* data = (const uint8_t*)request->container.GetLevelData(0);
+            std::size_t size = last.offset + last.size - first.offset;
+
+            for(std::size_t offset = 0; offset < size; offset += PageSize)
+            {
+                data[offset];
+            }
+
+            request->success = true;
+        }
+        else
+        {
+            request->success = request->image.Load(request->filename);
+        }
+
+        request->finished = true;
+    });
+
+    // Add the request to the queue.
+    m_requests.push_back(std::move(request));
+
+    return true;
+}
+
+void TextureLoader::Update()
+{
+    if(!m_initialized)
+        return;
+
+    // Decode the oldest image on this thread if there are no worker threads.
+    if(!m_requests.empty() && m_jobSystem->GetWorkerCount() == 1)
+    {
+        const RequestPtr& request = m_requests.front();
+
+        if(request->texture != nullptr && request->job != nullptr)
+        {
+            m_jobSystem->Wait(request->job);
+        }
+    }
+
+    // Upload textures as they finish decoding, oldest requests first.
+    int uploadedBytes = 0;
+    int uploadedCount = 0;
+
+    auto it = m_requests.begin();
+
+    while(it != m_requests.end())
+    {
+        TextureRequest& request = **it;
+
+        // Skip requests that are still being decoded.
+        if(request.texture != nullptr && !request.finished)
+        {
+            ++it;
+            continue;
+        }
+
+        // Stop when the upload budget is spent.
+        if(request.texture != nullptr)
+        {
+            int size = (int)GetUploadSize(request);
+
+            if(uploadedCount != 0 && uploadedBytes + size > m_uploadBudget)
+                break;
+
+            this->Upload(request);
+
+            uploadedBytes += size;
+            uploadedCount += 1;
+        }
+
+        // Remove the finished or canceled request.
+        request.job = nullptr;
+
+        it = m_requests.erase(it);
+    }
+
+    // Unbind the pixel buffer, so other uploads read from client memory.
+    if(uploadedCount != 0)
+    {
+        StateCache::BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+}
+
+void TextureLoader::Flush()
+{
+    if(!m_initialized)
+        return;
+
+    // Wait for all decoding jobs.
+    for(RequestPtr& request : m_requests)
+    {
+        if(request->job != nullptr)
+        {
+            m_jobSystem->Wait(request->job);
+        }
+    }
+
+    // Upload all textures regardless of the budget.
+    int uploadBudget = m_uploadBudget;
+    m_uploadBudget = std::numeric_limits<int>::max();
+
+    this->Update();
+
+    m_uploadBudget = uploadBudget;
+}
+
+bool TextureLoader::Upload(TextureRequest& request)
+{
+    Assert(request.finished);
+    Assert(request.texture != nullptr);
+
+    // Detach the request from the texture.
+    Texture* texture = request.texture;
+    texture->m_request = nullptr;
+
+    request.texture = nullptr;
+
+    // Fill textures that failed to decode with the default texture.
+    if(!request.success)
+    {
+        Log() << LogLoadError(request.filename) << "Couldn't decode the image.";
+        return this->UploadDefault(*texture);
+    }
+
+    // Upload the cooked container straight from the mapped file.
+    if(request.container.IsValid())
+    {
+        std::string cookedFilename = TextureContainer::GetCookedFilename(request.filename);
+
+        StateCache::BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+        if(!texture->Initialize(request.container))
+        {
+            Log() << LogLoadError(cookedFilename) << "Initialization failed.";
+            return false;
+        }
+
+        Log() << "Loaded a texture from \"" << cookedFilename << "\" file.";
+
+        return true;
+    }
+
+    // Copy pixels to the mapped staging buffer.
+    const Image& image = request.image;
+    const void* data = nullptr;
+
+    void* mapping = m_pixelBuffer.Map((int)image.GetSize());
+
+    if(mapping != nullptr)
+    {
+        memcpy(mapping, image.GetData(), image.GetSize());
+    }
+
+    // Upload from client memory if the staging buffer could not be written.
+    if(mapping == nullptr || !m_pixelBuffer.Unmap())
+    {
+        StateCache::BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        data = image.GetData();
+    }
+
+    // Create the texture from the bound pixel buffer.
+    if(!texture->Initialize(image.GetWidth(), image.GetHeight(), image.GetFormat(), data))
+    {
+        Log() << LogLoadError(request.filename) << "Initialization failed.";
+        return false;
+    }
+
+    // Success!
+    Log() << "Loaded a texture from \"" << request.filename << "\" file.";
+
+    return true;
+}
+
+bool TextureLoader::UploadDefault(Texture& texture)
+{
+    // Get the default texture.
+    if(m_resourceManager == nullptr)
+        return false;
+
+    std::shared_ptr<const Texture> defaultTexture = m_resourceManager->GetPool<Texture>()->GetDefault();
+
+    if(defaultTexture == nullptr || !defaultTexture->IsValid())
+        return false;
+
+    // Read pixels of the default texture.
+    int width = defaultTexture->GetWidth();
+    int height = defaultTexture->GetHeight();
+
+    std::vector<uint8_t> pixels(width * height * 4);
+
+    StateCache::BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    StateCache::BindTexture(0, defaultTexture->GetHandle());
+
+    glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+
+    // Create the texture from client memory.
+    StateCache::BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    return texture.Initialize(width, height, GL_RGBA, pixels.data());
+}
+
+void TextureLoader::SetUploadBudget(int bytes)
+{
+    m_uploadBudget = std::max(bytes, 0);
+}
+
+std::size_t TextureLoader::GetPendingCount() const
+{
+    return m_requests.size();
+}
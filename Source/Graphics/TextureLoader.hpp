@@ -0,0 +1,139 @@
+#pragma once
+
+#include "Precompiled.hpp"
+#include "System/JobSystem.hpp"
+#include "Texture.hpp"
+#include "TextureContainer.hpp"
+#include "Image.hpp"
+#include "Buffer.hpp"
+
+// Forward declarations.
+struct Context;
+
+namespace System
+{
+    class ResourceManager;
+}
+
+//
+// Texture Loader
+//
+//  Loads textures without stalling the main thread. Images are read
+//  and decoded by jobs on worker threads into staging memory, then
+//  uploaded on the main thread through a pixel buffer within a budget
+//  of bytes per update, so loading many textures is spread over frames.
+//  Textures are uploaded as soon as they are decoded, so a slow image
+//  does not hold back the ones queued after it.
+//
+//  Cooked texture containers are mapped and read by worker threads
+//  instead, then uploaded straight from the mapped file.
+//
+//  Example usage:
+//      Graphics::TextureLoader textureLoader;
+//      textureLoader.Initialize(context);
+//
+//      auto texture = resourceManager.Load<Graphics::Texture>("Data/Texture.png");
+//
+//      // Once per frame.
+//      textureLoader.Update();
+//
+//  Textures loaded by the resource manager are queued here once the loader
+//  is in the context. They are returned right away, but stay pending and
+//  invalid until uploaded, so the renderer draws them with the default
+//  texture of the resource pool. Pending textures have no size yet, so
+//  rectangles of render components set from them follow their size later.
+//
+//  Textures released before their upload cancel their requests.
+//  Textures that failed to decode are filled with the default texture.
+//
+
+namespace Graphics
+{
+    // Texture request structure.
+    struct TextureRequest
+    {
+        TextureRequest() :
+            texture(nullptr),
+            success(false),
+            finished(false)
+        {
+        }
+
+        // Requested texture, accessed only on the main thread.
+        Texture* texture;
+        std::string filename;
+
+        // Decoding job.
+        System::JobSystem::JobHandle job;
+
+        // Loaded data, accessed by the main thread once finished.
+        TextureContainer container;
+        Image image;
+        bool success;
+
+        // Decoding state.
+        std::atomic<bool> finished;
+    };
+
+    // Texture loader class.
+    class TextureLoader
+    {
+    public:
+        // Type declarations.
+        typedef std::shared_ptr<TextureRequest> RequestPtr;
+        typedef std::deque<RequestPtr>          RequestQueue;
+
+        // Constant variables.
+        static const int DefaultUploadBudget = 4 * 1024 * 1024;
+
+    public:
+        TextureLoader();
+        ~TextureLoader();
+
+        // Restores instance to it's original state.
+        void Cleanup();
+
+        // Initializes the texture loader.
+        bool Initialize(Context& context);
+
+        // Queues a texture to be decoded and uploaded.
+        bool Queue(Texture& texture, std::string filename);
+
+        // Uploads textures that finished decoding within the budget.
+        void Update();
+
+        // Waits for all queued textures and uploads them.
+        void Flush();
+
+        // Sets the number of bytes uploaded in a single update.
+        // At least one texture is always uploaded.
+        void SetUploadBudget(int bytes);
+
+        // Gets the number of queued textures.
+        std::size_t GetPendingCount() const;
+
+    private:
+        // Uploads a decoded texture.
+        bool Upload(TextureRequest& request);
+
+        // Fills a texture with the default texture.
+        bool UploadDefault(Texture& texture);
+
+    private:
+        // Context references.
+        System::JobSystem* m_jobSystem;
+        System::ResourceManager* m_resourceManager;
+
+        // Queued requests.
+        RequestQueue m_requests;
+
+        // Staging buffer for uploads.
+        PixelBuffer m_pixelBuffer;
+
+        // Bytes uploaded in a single update.
+        int m_uploadBudget;
+
+        // Initialization state.
+        bool m_initialized;
+    };
+}
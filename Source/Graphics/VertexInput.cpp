@@ -1,6 +1,7 @@
 #include "Precompiled.hpp"
 #include "VertexInput.hpp"
 #include "Buffer.hpp"
+#include "StateCache.hpp"
 using namespace Graphics;
 
 namespace
@@ -28,6 +29,10 @@ namespace
             case VertexAttributeTypes::Float4x4:
                 return 4;
 
+            case VertexAttributeTypes::Short4:
+            case VertexAttributeTypes::UByte4Normalized:
+                return 4;
+
             default:
                 Assert(false, "Unknown attribute type.");
         }
@@ -44,6 +49,8 @@ namespace
             case VertexAttributeTypes::Float2:
             case VertexAttributeTypes::Float3:
             case VertexAttributeTypes::Float4:
+            case VertexAttributeTypes::Short4:
+            case VertexAttributeTypes::UByte4Normalized:
                 return 1;
 
             case VertexAttributeTypes::Float4x4:
@@ -76,6 +83,12 @@ namespace
             case VertexAttributeTypes::Float4x4:
                 return sizeof(float) * 4;
 
+            case VertexAttributeTypes::Short4:
+                return sizeof(int16_t) * 4;
+
+            case VertexAttributeTypes::UByte4Normalized:
+                return sizeof(uint8_t) * 4;
+
             default:
                 Assert(false, "Unknown attribute type.");
         }
@@ -95,6 +108,12 @@ namespace
             case VertexAttributeTypes::Float4x4:
                 return GL_FLOAT;
 
+            case VertexAttributeTypes::Short4:
+                return GL_SHORT;
+
+            case VertexAttributeTypes::UByte4Normalized:
+                return GL_UNSIGNED_BYTE;
+
             default:
                 Assert(false, "Unknown attribute type.");
         }
@@ -102,6 +121,19 @@ namespace
         return GL_INVALID_ENUM;
     }
 
+    // Checks if the vertex attribute type is normalized.
+    GLboolean IsVertexAttributeTypeNormalized(VertexAttributeTypes type)
+    {
+        switch(type)
+        {
+            case VertexAttributeTypes::UByte4Normalized:
+                return GL_TRUE;
+
+            default:
+                return GL_FALSE;
+        }
+    }
+
     // Constant definitions.
     const GLuint InvalidHandle = 0;
 }
@@ -125,6 +157,8 @@ void VertexInput::Cleanup()
     // Release the vertex array handle.
     if(m_handle != InvalidHandle)
     {
+        StateCache::ForgetVertexArray(m_handle);
+
         glDeleteVertexArrays(1, &m_handle);
         m_handle = InvalidHandle;
     }
@@ -198,15 +232,8 @@ bool VertexInput::Initialize(int attributeCount, const VertexAttribute* attribut
         return false;
     }
 
-    // Cleanup state after we are done.
-    SCOPE_GUARD
-    (
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glBindVertexArray(0);
-    );
-
     // Bind the vertex array.
-    glBindVertexArray(m_handle);
+    StateCache::BindVertexArray(m_handle);
 
     // Set the vertex array state.
     const Buffer* currentBuffer = nullptr;
@@ -221,7 +248,7 @@ bool VertexInput::Initialize(int attributeCount, const VertexAttribute* attribut
         // Bind the vertex buffer.
         if(currentBuffer != attribute.buffer)
         {
-            glBindBuffer(GL_ARRAY_BUFFER, attribute.buffer->GetHandle());
+            StateCache::BindBuffer(GL_ARRAY_BUFFER, attribute.buffer->GetHandle());
 
             currentBuffer = attribute.buffer;
             currentOffset = 0;
@@ -238,7 +265,7 @@ bool VertexInput::Initialize(int attributeCount, const VertexAttribute* attribut
                 currentLocation,
                 GetVertexAttributeTypeRowSize(attribute.type),
                 GetVertexAttributeTypeEnum(attribute.type),
-                GL_FALSE,
+                IsVertexAttributeTypeNormalized(attribute.type),
                 attribute.buffer->GetElementSize(),
                 (void*)currentOffset
             );
@@ -38,6 +38,9 @@ namespace Graphics
 
         Float4x4,
 
+        Short4,
+        UByte4Normalized,
+
         Count,
     };
 
@@ -42,5 +42,8 @@ namespace Logger
     private:
         // List of outputs.
         OutputList m_outputs;
+
+        // Guards writes from multiple threads.
+        std::mutex m_mutex;
     };
 }
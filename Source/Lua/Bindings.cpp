@@ -19,6 +19,8 @@ bool Bindings::Register(Lua::State& state, Context& context)
     KeyboardKeys::Register(state, context);
     EntityHandle::Register(state, context);
     TransformComponent::Register(state, context);
+    RenderComponent::Register(state, context);
+    ScriptComponent::Register(state, context);
     ComponentSystem::Register(state, context);
 
     return true;
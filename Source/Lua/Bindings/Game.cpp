@@ -7,6 +7,8 @@ using namespace Bindings;
 #include "Game/EntityHandle.hpp"
 #include "Game/ComponentSystem.hpp"
 #include "Game/Components/Transform.hpp"
+#include "Game/Components/Render.hpp"
+#include "Game/Components/Script.hpp"
 
 //
 // Entity Handle
@@ -135,6 +137,64 @@ void EntityHandle::Register(Lua::State& state, Context& context)
 // Component System
 //
 
+namespace
+{
+    // Component type that can be viewed from scripts.
+    struct ViewableComponent
+    {
+        const char* name;
+        Game::ComponentMask (*getMask)();
+        void (*push)(lua_State* state, Game::ComponentSystem* componentSystem, const Game::EntityHandle& entity);
+    };
+
+    const ViewableComponent ViewableComponents[] =
+    {
+        {
+            "Transform",
+
+            &Game::GetComponentTypeMask<Game::Components::Transform>,
+
+            [](lua_State* state, Game::ComponentSystem* componentSystem, const Game::EntityHandle& entity)
+            {
+                TransformComponent::Push(state, componentSystem->Lookup<Game::Components::Transform>(entity));
+            },
+        },
+
+        {
+            "Render",
+
+            &Game::GetComponentTypeMask<Game::Components::Render>,
+
+            [](lua_State* state, Game::ComponentSystem* componentSystem, const Game::EntityHandle& entity)
+            {
+                RenderComponent::Push(state, componentSystem->Lookup<Game::Components::Render>(entity));
+            },
+        },
+
+        {
+            "Script",
+
+            &Game::GetComponentTypeMask<Game::Components::Script>,
+
+            [](lua_State* state, Game::ComponentSystem* componentSystem, const Game::EntityHandle& entity)
+            {
+                ScriptComponent::Push(state, componentSystem->Lookup<Game::Components::Script>(entity));
+            },
+        },
+    };
+
+    // Component view iteration state.
+    const int MaximumViewComponents = 8;
+
+    struct ComponentViewState
+    {
+        Game::ComponentSystem* componentSystem;
+        const ViewableComponent* components[MaximumViewComponents];
+        std::size_t count;
+        Game::ComponentSystem::EntityQuery query;
+    };
+}
+
 Game::ComponentSystem* ComponentSystem::Check(lua_State* state, int index)
 {
     Assert(state != nullptr);
@@ -164,6 +224,90 @@ int ComponentSystem::GetTransform(lua_State* state)
     return 1;
 }
 
+int ComponentSystem::View(lua_State* state)
+{
+    Assert(state != nullptr);
+
+    // Get arguments from the stack.
+    auto* componentSystem = ComponentSystem::Check(state, 1);
+
+    // Component type names follow the component system argument.
+    const int firstNameIndex = 2;
+
+    int componentCount = lua_gettop(state) - firstNameIndex + 1;
+    luaL_argcheck(state, componentCount >= 1, firstNameIndex, "expected a component type name");
+
+    // Report the first name that does not fit in the view.
+    luaL_argcheck(state, componentCount <= MaximumViewComponents, firstNameIndex + MaximumViewComponents, "too many component types");
+
+    // Create the iteration state.
+    void* memory = lua_newuserdata(state, sizeof(ComponentViewState));
+    auto* view = new (memory) ComponentViewState();
+
+    Assert(memory != nullptr);
+    Assert(view != nullptr);
+
+    view->componentSystem = componentSystem;
+    view->count = componentCount;
+
+    // Resolve component types.
+    Game::ComponentMask mask = 0;
+
+    for(int i = 0; i < componentCount; ++i)
+    {
+        std::string name = luaL_checkstring(state, firstNameIndex + i);
+
+        auto it = std::find_if(std::begin(ViewableComponents), std::end(ViewableComponents),
+            [&name](const ViewableComponent& component)
+            {
+                return name == component.name;
+            }
+        );
+
+        if(it == std::end(ViewableComponents))
+        {
+            luaL_argerror(state, firstNameIndex + i, "unknown component type");
+        }
+
+        view->components[i] = &(*it);
+        mask |= it->getMask();
+    }
+
+    // Start the entity query.
+    view->query = componentSystem->BeginQuery(mask);
+
+    // Push the iterator function.
+    lua_pushcclosure(state, ComponentSystem::ViewIterator, 1);
+
+    return 1;
+}
+
+int ComponentSystem::ViewIterator(lua_State* state)
+{
+    Assert(state != nullptr);
+
+    // Get the iteration state.
+    void* memory = lua_touserdata(state, lua_upvalueindex(1));
+    auto* view = reinterpret_cast<ComponentViewState*>(memory);
+    Assert(view != nullptr);
+
+    // Find the next entity that has all components.
+    Game::EntityHandle entity;
+
+    if(!view->componentSystem->NextQuery(view->query, entity))
+        return 0;
+
+    // Push the entity and its components.
+    *EntityHandle::Push(state) = entity;
+
+    for(std::size_t i = 0; i < view->count; ++i)
+    {
+        view->components[i]->push(state, view->componentSystem, entity);
+    }
+
+    return 1 + (int)view->count;
+}
+
 void ComponentSystem::Register(Lua::State& state, Context& context)
 {
     Assert(state.IsValid());
@@ -184,6 +328,9 @@ void ComponentSystem::Register(Lua::State& state, Context& context)
     lua_pushcfunction(state, ComponentSystem::GetTransform);
     lua_setfield(state, -2, "GetTransform");
 
+    lua_pushcfunction(state, ComponentSystem::View);
+    lua_setfield(state, -2, "View");
+
     lua_setmetatable(state, -2);
 
     // Register as a global variable.
@@ -275,3 +422,222 @@ void TransformComponent::Register(Lua::State& state, Context& context)
     // Register as a global variable.
     lua_setfield(state, LUA_GLOBALSINDEX, "TransformComponent");
 }
+
+//
+// Render Component
+//
+
+Game::Components::Render* RenderComponent::Push(lua_State* state, Game::Components::Render* render)
+{
+    Assert(state != nullptr);
+
+    // Create an userdata pointer.
+    void* memory = lua_newuserdata(state, sizeof(Game::Components::Render*));
+    auto** pointer = reinterpret_cast<Game::Components::Render**>(memory);
+    *pointer = render;
+
+    Assert(memory != nullptr);
+    Assert(pointer != nullptr);
+
+    // Set the metatable.
+    luaL_getmetatable(state, "RenderComponent");
+    lua_setmetatable(state, -2);
+
+    return *pointer;
+}
+
+Game::Components::Render* RenderComponent::Check(lua_State* state, int index)
+{
+    Assert(state != nullptr);
+
+    // Get the userdata pointer.
+    void* memory = luaL_checkudata(state, index, "RenderComponent");
+    auto* object = *reinterpret_cast<Game::Components::Render**>(memory);
+    Assert(memory != nullptr && object != nullptr);
+
+    return object;
+}
+
+int RenderComponent::SetOffset(lua_State* state)
+{
+    Assert(state != nullptr);
+
+    // Get arguments from the stack.
+    auto* render = RenderComponent::Check(state, 1);
+    glm::vec2* offset = Vec2::Check(state, 2);
+
+    // Call the method.
+    render->SetOffset(*offset);
+
+    return 0;
+}
+
+int RenderComponent::GetOffset(lua_State* state)
+{
+    Assert(state != nullptr);
+
+    // Get arguments from the stack.
+    auto* render = RenderComponent::Check(state, 1);
+
+    // Call the method.
+    glm::vec2 offset = render->GetOffset();
+
+    // Push the result.
+    *Vec2::Push(state) = offset;
+
+    return 1;
+}
+
+int RenderComponent::SetEmissivePower(lua_State* state)
+{
+    Assert(state != nullptr);
+
+    // Get arguments from the stack.
+    auto* render = RenderComponent::Check(state, 1);
+    float power = (float)luaL_checknumber(state, 2);
+
+    // Call the method.
+    render->SetEmissivePower(power);
+
+    return 0;
+}
+
+int RenderComponent::GetEmissivePower(lua_State* state)
+{
+    Assert(state != nullptr);
+
+    // Get arguments from the stack.
+    auto* render = RenderComponent::Check(state, 1);
+
+    // Push the result.
+    lua_pushnumber(state, render->GetEmissivePower());
+
+    return 1;
+}
+
+int RenderComponent::SetTransparent(lua_State* state)
+{
+    Assert(state != nullptr);
+
+    // Get arguments from the stack.
+    auto* render = RenderComponent::Check(state, 1);
+    bool transparent = lua_toboolean(state, 2) != 0;
+
+    // Call the method.
+    render->SetTransparent(transparent);
+
+    return 0;
+}
+
+int RenderComponent::IsTransparent(lua_State* state)
+{
+    Assert(state != nullptr);
+
+    // Get arguments from the stack.
+    auto* render = RenderComponent::Check(state, 1);
+
+    // Push the result.
+    lua_pushboolean(state, render->IsTransparent());
+
+    return 1;
+}
+
+void RenderComponent::Register(Lua::State& state, Context& context)
+{
+    Assert(state.IsValid());
+
+    // Create a class metatable.
+    luaL_newmetatable(state, "RenderComponent");
+
+    lua_pushliteral(state, "__index");
+    lua_pushvalue(state, -2);
+    lua_rawset(state, -3);
+
+    lua_pushcfunction(state, RenderComponent::SetOffset);
+    lua_setfield(state, -2, "SetOffset");
+
+    lua_pushcfunction(state, RenderComponent::GetOffset);
+    lua_setfield(state, -2, "GetOffset");
+
+    lua_pushcfunction(state, RenderComponent::SetEmissivePower);
+    lua_setfield(state, -2, "SetEmissivePower");
+
+    lua_pushcfunction(state, RenderComponent::GetEmissivePower);
+    lua_setfield(state, -2, "GetEmissivePower");
+
+    lua_pushcfunction(state, RenderComponent::SetTransparent);
+    lua_setfield(state, -2, "SetTransparent");
+
+    lua_pushcfunction(state, RenderComponent::IsTransparent);
+    lua_setfield(state, -2, "IsTransparent");
+
+    // Register as a global variable.
+    lua_setfield(state, LUA_GLOBALSINDEX, "RenderComponent");
+}
+
+//
+// Script Component
+//
+
+Game::Components::Script* ScriptComponent::Push(lua_State* state, Game::Components::Script* script)
+{
+    Assert(state != nullptr);
+
+    // Create an userdata pointer.
+    void* memory = lua_newuserdata(state, sizeof(Game::Components::Script*));
+    auto** pointer = reinterpret_cast<Game::Components::Script**>(memory);
+    *pointer = script;
+
+    Assert(memory != nullptr);
+    Assert(pointer != nullptr);
+
+    // Set the metatable.
+    luaL_getmetatable(state, "ScriptComponent");
+    lua_setmetatable(state, -2);
+
+    return *pointer;
+}
+
+Game::Components::Script* ScriptComponent::Check(lua_State* state, int index)
+{
+    Assert(state != nullptr);
+
+    // Get the userdata pointer.
+    void* memory = luaL_checkudata(state, index, "ScriptComponent");
+    auto* object = *reinterpret_cast<Game::Components::Script**>(memory);
+    Assert(memory != nullptr && object != nullptr);
+
+    return object;
+}
+
+int ScriptComponent::Call(lua_State* state)
+{
+    Assert(state != nullptr);
+
+    // Get arguments from the stack.
+    auto* script = ScriptComponent::Check(state, 1);
+    std::string method = luaL_checkstring(state, 2);
+
+    // Call the method of every added script.
+    script->Call(method);
+
+    return 0;
+}
+
+void ScriptComponent::Register(Lua::State& state, Context& context)
+{
+    Assert(state.IsValid());
+
+    // Create a class metatable.
+    luaL_newmetatable(state, "ScriptComponent");
+
+    lua_pushliteral(state, "__index");
+    lua_pushvalue(state, -2);
+    lua_rawset(state, -3);
+
+    lua_pushcfunction(state, ScriptComponent::Call);
+    lua_setfield(state, -2, "Call");
+
+    // Register as a global variable.
+    lua_setfield(state, LUA_GLOBALSINDEX, "ScriptComponent");
+}
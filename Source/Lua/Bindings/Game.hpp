@@ -13,6 +13,8 @@ namespace Game
     namespace Components
     {
         class Transform;
+        class Render;
+        class Script;
     }
 }
 
@@ -56,6 +58,8 @@ namespace Lua
 
             // Class methods.
             int GetTransform(lua_State* state);
+            int View(lua_State* state);
+            int ViewIterator(lua_State* state);
 
             // Registers Lua bindings.
             void Register(Lua::State& state, Context& context);
@@ -86,3 +90,54 @@ namespace Lua
         }
     }
 }
+
+//
+// Render Component
+//
+
+namespace Lua
+{
+    namespace Bindings
+    {
+        namespace RenderComponent
+        {
+            // Helper functions.
+            Game::Components::Render* Push(lua_State* state, Game::Components::Render* render);
+            Game::Components::Render* Check(lua_State* state, int index);
+
+            // Class methods.
+            int SetOffset(lua_State* state);
+            int GetOffset(lua_State* state);
+            int SetEmissivePower(lua_State* state);
+            int GetEmissivePower(lua_State* state);
+            int SetTransparent(lua_State* state);
+            int IsTransparent(lua_State* state);
+
+            // Registers Lua bindings.
+            void Register(Lua::State& state, Context& context);
+        }
+    }
+}
+
+//
+// Script Component
+//
+
+namespace Lua
+{
+    namespace Bindings
+    {
+        namespace ScriptComponent
+        {
+            // Helper functions.
+            Game::Components::Script* Push(lua_State* state, Game::Components::Script* script);
+            Game::Components::Script* Check(lua_State* state, int index);
+
+            // Class methods.
+            int Call(lua_State* state);
+
+            // Registers Lua bindings.
+            void Register(Lua::State& state, Context& context);
+        }
+    }
+}
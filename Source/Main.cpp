@@ -3,21 +3,28 @@
 
 #include "System/Config.hpp"
 #include "System/Timer.hpp"
+#include "System/JobSystem.hpp"
 #include "System/Window.hpp"
 #include "System/InputState.hpp"
 #include "System/ResourceManager.hpp"
+#include "Graphics/TextureLoader.hpp"
 #include "Graphics/BasicRenderer.hpp"
+#include "Graphics/RenderQueue.hpp"
+#include "Game/SystemScheduler.hpp"
 #include "Game/EntitySystem.hpp"
 #include "Game/ComponentSystem.hpp"
 #include "Game/IdentitySystem.hpp"
 #include "Game/ScriptSystem.hpp"
 #include "Game/RenderSystem.hpp"
+#include "Game/ParticleSystem.hpp"
 
 #include "Lua/Reference.hpp"
 #include "Graphics/SpriteSheet.hpp"
 #include "Game/Components/Transform.hpp"
 #include "Game/Components/Script.hpp"
 #include "Game/Components/Render.hpp"
+#include "Game/Components/TileMap.hpp"
+#include "Game/Components/ParticleEmitter.hpp"
 
 //
 // Main
@@ -45,6 +52,11 @@ int main(int argc, char* argv[])
 
     context.timer = &timer;
 
+    // Initialize the job system.
+    System::JobSystem jobSystem;
+    if(!jobSystem.Initialize(context))
+        return -1;
+
     // Initialize the window.
     System::Window window;
     if(!window.Initialize(context))
@@ -60,19 +72,41 @@ int main(int argc, char* argv[])
     if(!resourceManager.Initialize(context))
         return -1;
 
+    // Initialize the texture loader.
+    Graphics::TextureLoader textureLoader;
+    if(!textureLoader.Initialize(context))
+        return -1;
+
     // Initialize the basic renderer.
     Graphics::BasicRenderer basicRenderer;
     if(!basicRenderer.Initialize(context))
         return -1;
 
+    // Initialize the render queue.
+    Graphics::RenderQueue renderQueue;
+    if(!renderQueue.Initialize(context))
+        return -1;
+
+    // Initialize the system scheduler.
+    Game::SystemScheduler systemScheduler;
+    if(!systemScheduler.Initialize(context))
+        return -1;
+
     // Initialize the entity system.
     Game::EntitySystem entitySystem;
     if(!entitySystem.Initialize(context))
         return -1;
 
     // Initialize the component system.
+    auto componentStorage = Game::ComponentSystem::ComponentStorage::Pools;
+
+    if(config.Get<std::string>("Game.ComponentStorage", "Pools") == "Archetypes")
+    {
+        componentStorage = Game::ComponentSystem::ComponentStorage::Archetypes;
+    }
+
     Game::ComponentSystem componentSystem;
-    if(!componentSystem.Initialize(context))
+    if(!componentSystem.Initialize(context, componentStorage))
         return -1;
 
     // Initialize the identity system.
@@ -90,6 +124,67 @@ int main(int argc, char* argv[])
     if(!renderSystem.Initialize(context))
         return -1;
 
+    // Initialize the particle system.
+    Game::ParticleSystem particleSystem;
+    if(!particleSystem.Initialize(context))
+        return -1;
+
+    // Add systems to the scheduler.
+    {
+        Game::SystemScheduler::SystemInfo info;
+        info.name = "Resources";
+        info.writes = Game::SystemScheduler::Access<System::ResourceManager, Graphics::TextureLoader>();
+        info.mainThread = true;
+        info.function = [&](float)
+        {
+            resourceManager.ReleaseUnused();
+            textureLoader.Update();
+        };
+
+        systemScheduler.AddSystem(info);
+    }
+
+    {
+        Game::SystemScheduler::SystemInfo info;
+        info.name = "Scripts";
+        info.reads = Game::SystemScheduler::Access<System::ResourceManager>();
+        info.writes = Game::SystemScheduler::Access<Game::Components::Script, Game::Components::Transform>();
+        info.function = [&](float timeDelta)
+        {
+            scriptSystem.Update(timeDelta);
+        };
+
+        systemScheduler.AddSystem(info);
+    }
+
+    {
+        Game::SystemScheduler::SystemInfo info;
+        info.name = "Particles";
+        info.reads = Game::SystemScheduler::Access<System::ResourceManager, Game::Components::Transform, Game::Components::ParticleEmitter>();
+        info.writes = Game::SystemScheduler::Access<Graphics::RenderQueue>();
+        info.function = [&](float timeDelta)
+        {
+            particleSystem.Update(timeDelta);
+            particleSystem.Draw();
+        };
+
+        systemScheduler.AddSystem(info);
+    }
+
+    {
+        Game::SystemScheduler::SystemInfo info;
+        info.name = "Render";
+        info.reads = Game::SystemScheduler::Access<System::ResourceManager, Game::Components::Transform, Game::Components::Render, Game::Components::TileMap>();
+        info.writes = Game::SystemScheduler::Access<Graphics::RenderQueue>();
+        info.mainThread = true;
+        info.function = [&](float)
+        {
+            renderSystem.Draw();
+        };
+
+        systemScheduler.AddSystem(info);
+    }
+
     // Create entities.
     {
         auto playerScript = resourceManager.Load<Lua::ManagedReference>("Data/Scripts/Player.lua");
@@ -176,9 +271,6 @@ int main(int argc, char* argv[])
         // Get elapsed time since the last frame.
         float timeDelta = timer.GetDelta();
 
-        // Release unused resources.
-        resourceManager.ReleaseUnused();
-
         // Update input state before processing events.
         inputState.Update();
 
@@ -188,11 +280,8 @@ int main(int argc, char* argv[])
         // Process entity commands.
         entitySystem.ProcessCommands();
 
-        // Update script system.
-        scriptSystem.Update(timeDelta);
-
-        // Draw the scene.
-        renderSystem.Draw();
+        // Run scheduled systems.
+        systemScheduler.Execute(timeDelta);
 
         // Present the backbuffer to the window.
         window.Present();
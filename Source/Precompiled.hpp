@@ -16,9 +16,17 @@
 #include <fstream>
 #include <string>
 #include <vector>
+#include <deque>
 #include <queue>
 #include <map>
 #include <unordered_map>
+#include <limits>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <random>
 
 //
 // External
@@ -35,6 +43,8 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_precision.hpp>
+#include <glm/gtc/packing.hpp>
 #include <glm/gtx/vector_angle.hpp>
 
 // GLEW
@@ -61,6 +71,7 @@
 #include "Common/Build.hpp"
 #include "Common/Utility.hpp"
 #include "Common/NonCopyable.hpp"
+#include "Common/Span.hpp"
 #include "Common/ScopeGuard.hpp"
 #include "Common/Delegate.hpp"
 #include "Common/Dispatcher.hpp"
@@ -0,0 +1,406 @@
+#include "Precompiled.hpp"
+#include "JobSystem.hpp"
+#include "Config.hpp"
+#include "Context.hpp"
+using namespace System;
+
+namespace
+{
+    // Log error messages.
+    #define LogInitializeError() "Failed to initialize the job system! "
+
+    // Worker of the current thread.
+    thread_local JobSystem* CurrentSystem = nullptr;
+    thread_local int CurrentWorker = -1;
+
+    // Index of the main thread worker.
+    const int MainWorker = 0;
+}
+
+JobSystem::JobSystem() :
+    m_queuedJobs(0),
+    m_exit(false),
+    m_initialized(false)
+{
+}
+
+JobSystem::~JobSystem()
+{
+    this->Cleanup();
+}
+
+void JobSystem::Cleanup()
+{
+    if(!m_initialized)
+        return;
+
+    // Wake up and join worker threads.
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_exit = true;
+    }
+
+    m_sleepCondition.notify_all();
+
+    for(auto& worker : m_workers)
+    {
+        if(worker->thread.joinable())
+        {
+            worker->thread.join();
+        }
+    }
+
+    // Detach the main thread.
+    if(CurrentSystem == this)
+    {
+        CurrentSystem = nullptr;
+        CurrentWorker = -1;
+    }
+
+    // Release jobs remaining in worker queues.
+    for(auto& worker : m_workers)
+    {
+        while(Job* job = worker->queue.Take())
+        {
+            job->queued = nullptr;
+        }
+    }
+
+    // Remove workers and remaining jobs.
+    Utility::ClearContainer(m_workers);
+    Utility::ClearContainer(m_mainQueue);
+    Utility::ClearContainer(m_sharedQueue);
+
+    // Reset worker state.
+    m_queuedJobs = 0;
+    m_exit = false;
+
+    // Reset initialization state.
+    m_initialized = false;
+}
+
+bool JobSystem::Initialize(Context& context)
+{
+    Assert(context.jobSystem == nullptr);
+
+    // Cleanup this instance.
+    this->Cleanup();
+
+    // Setup a cleanup guard.
+    SCOPE_GUARD
+    (
+        if(!m_initialized)
+        {
+            m_initialized = true;
+            this->Cleanup();
+        }
+    );
+
+    // Check if this thread already runs jobs.
+    if(CurrentSystem != nullptr)
+    {
+        Log() << LogInitializeError() << "Another job system is attached to this thread.";
+        return false;
+    }
+
+    // Determine the number of workers.
+    int workerCount = 0;
+
+    if(context.config != nullptr)
+    {
+        workerCount = context.config->Get<int>("Jobs.Workers", 0);
+    }
+
+    if(workerCount <= 0)
+    {
+        workerCount = std::max(1, (int)std::thread::hardware_concurrency());
+    }
+
+    // Create worker queues.
+    m_workers.reserve(workerCount);
+
+    for(int i = 0; i < workerCount; ++i)
+    {
+        m_workers.push_back(std::make_unique<Worker>());
+    }
+
+    // Attach the main thread as the first worker.
+    CurrentSystem = this;
+    CurrentWorker = MainWorker;
+
+    // Start worker threads.
+    for(int i = MainWorker + 1; i < workerCount; ++i)
+    {
+        m_workers[i]->thread = std::thread(&JobSystem::WorkerMain, this, i);
+    }
+
+    // Set context instance.
+    context.jobSystem = this;
+
+    // Success!
+    return m_initialized = true;
+}
+
+JobSystem::JobHandle JobSystem::Schedule(JobFunction function, const JobList& dependencies, bool mainThread)
+{
+    if(!m_initialized)
+        return nullptr;
+
+    // Create a job.
+    auto job = std::make_shared<Job>();
+    job->function = std::move(function);
+    job->mainThread = mainThread;
+
+    // Register the job with unfinished dependencies.
+    // Hold an extra count so the job is not queued before we are done.
+    job->dependencies = 1;
+
+    for(const auto& dependency : dependencies)
+    {
+        if(dependency == nullptr)
+            continue;
+
+        std::lock_guard<std::mutex> lock(dependency->mutex);
+
+        if(!dependency->finished)
+        {
+            ++job->dependencies;
+            dependency->continuations.push_back(job);
+        }
+    }
+
+    // Queue the job if it does not have to wait.
+    if(--job->dependencies == 0)
+    {
+        this->Enqueue(job);
+    }
+
+    return job;
+}
+
+void JobSystem::ParallelFor(std::size_t count, std::size_t grain, RangeFunction function)
+{
+    if(count == 0)
+        return;
+
+    grain = std::max<std::size_t>(grain, 1);
+
+    // Process the range on this thread if it cannot be split.
+    if(!m_initialized || m_workers.size() == 1 || count <= grain)
+    {
+        function(0, count);
+        return;
+    }
+
+    // Create a parent job that finishes with all of its chunks.
+    auto parent = std::make_shared<Job>();
+
+    // Queue a job for each chunk of the range.
+    for(std::size_t begin = 0; begin < count; begin += grain)
+    {
+        std::size_t end = std::min(begin + grain, count);
+
+        auto job = std::make_shared<Job>();
+        job->function = [&function, begin, end]()
+        {
+            function(begin, end);
+        };
+
+        job->parent = parent;
+        ++parent->unfinished;
+
+        this->Enqueue(job);
+    }
+
+    // Release the parent and wait for chunks.
+    this->Finish(parent);
+    this->Wait(parent);
+}
+
+void JobSystem::Wait(const JobHandle& job)
+{
+    if(job == nullptr)
+        return;
+
+    // Run other jobs until this one finishes.
+    int index = CurrentSystem == this ? CurrentWorker : -1;
+
+    while(!job->finished)
+    {
+        if(index < 0 || !this->RunJob(index))
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+int JobSystem::GetWorkerCount() const
+{
+    return (int)m_workers.size();
+}
+
+void JobSystem::WorkerMain(int index)
+{
+    // Attach this thread to the worker.
+    CurrentSystem = this;
+    CurrentWorker = index;
+
+    // Run jobs until exit is requested.
+    while(true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_sleepMutex);
+            m_sleepCondition.wait(lock, [this]()
+            {
+                return m_queuedJobs > 0 || m_exit;
+            });
+        }
+
+        if(m_exit)
+            break;
+
+        this->RunJob(index);
+    }
+
+    // Detach this thread from the worker.
+    CurrentSystem = nullptr;
+    CurrentWorker = -1;
+}
+
+void JobSystem::Enqueue(JobHandle job)
+{
+    Assert(job != nullptr);
+
+    // Add a main thread job.
+    if(job->mainThread)
+    {
+        std::lock_guard<std::mutex> lock(m_mainMutex);
+        m_mainQueue.push_back(std::move(job));
+        return;
+    }
+
+    // Add a job to the queue of the current worker.
+    // Only the owner thread can push to a worker queue.
+    if(CurrentSystem == this)
+    {
+        Job* queued = job.get();
+        queued->queued = std::move(job);
+
+        m_workers[CurrentWorker]->queue.Push(queued);
+    }
+    else
+    {
+        std::lock_guard<std::mutex> lock(m_sharedMutex);
+        m_sharedQueue.push_back(std::move(job));
+    }
+
+    // Wake up a sleeping worker.
+    ++m_queuedJobs;
+
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+    }
+
+    m_sleepCondition.notify_one();
+}
+
+bool JobSystem::RunJob(int index)
+{
+    Assert(index >= 0 && index < (int)m_workers.size());
+
+    JobHandle job;
+
+    // Take a job with main thread affinity.
+    if(index == MainWorker)
+    {
+        std::lock_guard<std::mutex> lock(m_mainMutex);
+
+        if(!m_mainQueue.empty())
+        {
+            job = std::move(m_mainQueue.front());
+            m_mainQueue.pop_front();
+        }
+    }
+
+    // Take the most recent job from our own queue.
+    Job* queued = nullptr;
+
+    if(job == nullptr)
+    {
+        queued = m_workers[index]->queue.Take();
+    }
+
+    // Take the oldest job scheduled from outside of workers.
+    if(job == nullptr && queued == nullptr)
+    {
+        std::lock_guard<std::mutex> lock(m_sharedMutex);
+
+        if(!m_sharedQueue.empty())
+        {
+            job = std::move(m_sharedQueue.front());
+            m_sharedQueue.pop_front();
+            --m_queuedJobs;
+        }
+    }
+
+    // Steal the oldest job from other queues.
+    for(std::size_t i = 1; job == nullptr && queued == nullptr && i < m_workers.size(); ++i)
+    {
+        queued = m_workers[(index + i) % m_workers.size()]->queue.Steal();
+    }
+
+    // Release the queue reference of a taken job.
+    if(queued != nullptr)
+    {
+        job = std::move(queued->queued);
+        --m_queuedJobs;
+    }
+
+    if(job == nullptr)
+        return false;
+
+    // Run the job.
+    if(job->function)
+    {
+        job->function();
+    }
+
+    this->Finish(std::move(job));
+
+    return true;
+}
+
+void JobSystem::Finish(JobHandle job)
+{
+    Assert(job != nullptr);
+
+    // Wait for all children to finish.
+    if(--job->unfinished > 0)
+        return;
+
+    // Mark the job as finished.
+    JobList continuations;
+
+    {
+        std::lock_guard<std::mutex> lock(job->mutex);
+
+        job->finished = true;
+        continuations.swap(job->continuations);
+    }
+
+    // Queue jobs that no longer wait for dependencies.
+    for(auto& continuation : continuations)
+    {
+        if(--continuation->dependencies == 0)
+        {
+            this->Enqueue(std::move(continuation));
+        }
+    }
+
+    // Notify the parent job.
+    if(job->parent != nullptr)
+    {
+        JobHandle parent = std::move(job->parent);
+        this->Finish(std::move(parent));
+    }
+}
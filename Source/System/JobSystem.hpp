@@ -0,0 +1,157 @@
+#pragma once
+
+#include "Precompiled.hpp"
+#include "Common/WorkStealingQueue.hpp"
+
+// Forward declarations.
+struct Context;
+
+//
+// Job System
+//
+//  Runs jobs on a pool of worker threads, one for each processor core.
+//  Every worker owns a queue of jobs and steals jobs from queues of other
+//  workers when it runs out of its own. The thread that initialized the
+//  job system is also a worker, but it only runs jobs while it waits.
+//
+//  Worker queues are lock-free work stealing queues, which only their
+//  owners can push to. Jobs scheduled from threads that are not workers
+//  are added to a shared queue guarded by a mutex instead.
+//
+//  Scheduling a job and waiting for it:
+//      auto job = jobSystem.Schedule([]() { /* ... */ });
+//      jobSystem.Wait(job);
+//
+//  Scheduling a job that runs after other jobs finish:
+//      auto first = jobSystem.Schedule([]() { /* ... */ });
+//      auto second = jobSystem.Schedule([]() { /* ... */ }, { first });
+//
+//  Processing a range in chunks on all workers:
+//      jobSystem.ParallelFor(count, 64, [&](std::size_t begin, std::size_t end)
+//      {
+//          for(std::size_t i = begin; i < end; ++i)
+//          {
+//              /* ... */
+//          }
+//      });
+//
+//  Jobs scheduled with the main thread flag (e.g. making graphics calls)
+//  are only run by the main thread, in the order they become ready.
+//
+
+namespace System
+{
+    // Job structure.
+    struct Job : private NonCopyable
+    {
+        Job() :
+            parent(nullptr),
+            mainThread(false),
+            unfinished(1),
+            dependencies(0),
+            finished(false)
+        {
+        }
+
+        // Job function.
+        std::function<void()> function;
+
+        // Parent job that waits for this job.
+        std::shared_ptr<Job> parent;
+
+        // Main thread affinity.
+        bool mainThread;
+
+        // Number of unfinished children including itself.
+        std::atomic<int> unfinished;
+
+        // Number of unfinished dependencies.
+        std::atomic<int> dependencies;
+
+        // Jobs waiting for this job to finish.
+        std::mutex mutex;
+        std::vector<std::shared_ptr<Job>> continuations;
+        std::atomic<bool> finished;
+
+        // Reference held while the job is in a worker queue.
+        std::shared_ptr<Job> queued;
+    };
+
+    // Job system class.
+    class JobSystem
+    {
+    public:
+        // Type declarations.
+        typedef std::function<void()>                         JobFunction;
+        typedef std::function<void(std::size_t, std::size_t)> RangeFunction;
+        typedef std::shared_ptr<Job>                          JobHandle;
+        typedef std::vector<JobHandle>                        JobList;
+        typedef std::deque<JobHandle>                         JobQueue;
+        typedef WorkStealingQueue<Job*>                       WorkerQueue;
+
+        // Worker structure.
+        struct Worker
+        {
+            std::thread thread;
+            WorkerQueue queue;
+        };
+
+        typedef std::vector<std::unique_ptr<Worker>> WorkerList;
+
+    public:
+        JobSystem();
+        ~JobSystem();
+
+        // Restores instance to it's original state.
+        void Cleanup();
+
+        // Initializes the job system.
+        bool Initialize(Context& context);
+
+        // Schedules a job.
+        JobHandle Schedule(JobFunction function, const JobList& dependencies = JobList(), bool mainThread = false);
+
+        // Processes a range in parallel and waits for it to finish.
+        void ParallelFor(std::size_t count, std::size_t grain, RangeFunction function);
+
+        // Waits for a job to finish while running other jobs.
+        void Wait(const JobHandle& job);
+
+        // Gets the number of workers including the main thread.
+        int GetWorkerCount() const;
+
+    private:
+        // Worker thread entry.
+        void WorkerMain(int index);
+
+        // Adds a job to a queue.
+        void Enqueue(JobHandle job);
+
+        // Runs a single job if one is available.
+        bool RunJob(int index);
+
+        // Finishes a job and releases jobs that wait for it.
+        void Finish(JobHandle job);
+
+    private:
+        // Worker threads.
+        WorkerList m_workers;
+
+        // Jobs with main thread affinity.
+        std::mutex m_mainMutex;
+        JobQueue m_mainQueue;
+
+        // Jobs scheduled from threads that are not workers.
+        std::mutex m_sharedMutex;
+        JobQueue m_sharedQueue;
+
+        // Sleep state of worker threads.
+        std::mutex m_sleepMutex;
+        std::condition_variable m_sleepCondition;
+        std::atomic<int> m_queuedJobs;
+        std::atomic<bool> m_exit;
+
+        // Initialization state.
+        bool m_initialized;
+    };
+}
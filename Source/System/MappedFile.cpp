@@ -0,0 +1,177 @@
+#include "Precompiled.hpp"
+#include "MappedFile.hpp"
+using namespace System;
+
+#ifndef WIN32
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+namespace
+{
+    // Log error messages.
+    #define LogOpenError(filename) "Failed to map a file from \"" << filename << "\" path! "
+}
+
+MappedFile::MappedFile() :
+    m_data(nullptr),
+    m_size(0),
+    #ifdef WIN32
+        m_file(INVALID_HANDLE_VALUE),
+        m_mapping(nullptr),
+    #else
+        m_file(-1),
+    #endif
+    m_initialized(false)
+{
+}
+
+MappedFile::~MappedFile()
+{
+    this->Cleanup();
+}
+
+void MappedFile::Cleanup()
+{
+    if(!m_initialized)
+        return;
+
+    // Unmap the data and close platform handles.
+    #ifdef WIN32
+        if(m_data != nullptr)
+        {
+            UnmapViewOfFile(m_data);
+        }
+
+        if(m_mapping != nullptr)
+        {
+            CloseHandle(m_mapping);
+            m_mapping = nullptr;
+        }
+
+        if(m_file != INVALID_HANDLE_VALUE)
+        {
+            CloseHandle(m_file);
+            m_file = INVALID_HANDLE_VALUE;
+        }
+    #else
+        if(m_data != nullptr)
+        {
+            munmap((void*)m_data, m_size);
+        }
+
+        if(m_file != -1)
+        {
+            close(m_file);
+            m_file = -1;
+        }
+    #endif
+
+    m_data = nullptr;
+    m_size = 0;
+
+    // Reset initialization state.
+    m_initialized = false;
+}
+
+bool MappedFile::Open(std::string filename)
+{
+    this->Cleanup();
+
+    // Setup a cleanup guard.
+    SCOPE_GUARD
+    (
+        if(!m_initialized)
+        {
+            m_initialized = true;
+            this->Cleanup();
+        }
+    );
+
+    // Validate arguments.
+    if(filename.empty())
+    {
+        Log() << LogOpenError(filename) << "Invalid argument - \"filename\" is empty.";
+        return false;
+    }
+
+    std::string path = Build::GetWorkingDir() + filename;
+
+    #ifdef WIN32
+        // Open the file.
+        m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+        if(m_file == INVALID_HANDLE_VALUE)
+            return false;
+
+        // Get the file size.
+        LARGE_INTEGER size;
+
+        if(!GetFileSizeEx(m_file, &size))
+        {
+            Log() << LogOpenError(filename) << "Couldn't get the file size.";
+            return false;
+        }
+
+        m_size = (std::size_t)size.QuadPart;
+    #else
+        // Open the file.
+        m_file = open(path.c_str(), O_RDONLY);
+
+        if(m_file == -1)
+            return false;
+
+        // Get the file size.
+        struct stat status;
+
+        if(fstat(m_file, &status) != 0)
+        {
+            Log() << LogOpenError(filename) << "Couldn't get the file size.";
+            return false;
+        }
+
+        m_size = (std::size_t)status.st_size;
+    #endif
+
+    // Empty files cannot be mapped.
+    if(m_size == 0)
+    {
+        Log() << LogOpenError(filename) << "File is empty.";
+        return false;
+    }
+
+    #ifdef WIN32
+        // Map the file.
+        m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+        if(m_mapping == nullptr)
+        {
+            Log() << LogOpenError(filename) << "Couldn't create a file mapping.";
+            return false;
+        }
+
+        m_data = (const uint8_t*)MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+
+        if(m_data == nullptr)
+        {
+            Log() << LogOpenError(filename) << "Couldn't map a view of the file.";
+            return false;
+        }
+    #else
+        // Map the file.
+        void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_file, 0);
+
+        if(data == MAP_FAILED)
+        {
+            Log() << LogOpenError(filename) << "Couldn't map the file.";
+            return false;
+        }
+
+        m_data = (const uint8_t*)data;
+    #endif
+
+    // Success!
+    return m_initialized = true;
+}
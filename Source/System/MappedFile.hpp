@@ -0,0 +1,73 @@
+#pragma once
+
+#include "Precompiled.hpp"
+
+//
+// Mapped File
+//
+//  Maps a whole file into memory for reading.
+//  Pages are loaded by the operating system when they are first accessed,
+//  so data can be used in place without reading it into a buffer.
+//
+//  Example usage:
+//      System::MappedFile file;
+//      if(file.Open("Path/To/File"))
+//      {
+//          const uint8_t* data = file.GetData();
+//          std::size_t size = file.GetSize();
+//      }
+//
+//  Opening a file that does not exist is not an error and is not logged,
+//  so callers can check for optional files.
+//
+
+namespace System
+{
+    // Mapped file class.
+    class MappedFile : private NonCopyable
+    {
+    public:
+        MappedFile();
+        ~MappedFile();
+
+        // Restores instance to it's original state.
+        void Cleanup();
+
+        // Opens and maps a file.
+        bool Open(std::string filename);
+
+        // Gets the mapped data.
+        const uint8_t* GetData() const
+        {
+            return m_data;
+        }
+
+        // Gets the size of the mapped data.
+        std::size_t GetSize() const
+        {
+            return m_size;
+        }
+
+        // Checks if instance is valid.
+        bool IsValid() const
+        {
+            return m_initialized;
+        }
+
+    private:
+        // Mapped data.
+        const uint8_t* m_data;
+        std::size_t m_size;
+
+        // Platform handles.
+        #ifdef WIN32
+            HANDLE m_file;
+            HANDLE m_mapping;
+        #else
+            int m_file;
+        #endif
+
+        // Initialization state.
+        bool m_initialized;
+    };
+}
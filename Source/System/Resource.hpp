@@ -6,6 +6,9 @@
 namespace System
 {
     class ResourceManager;
+
+    template<typename Type>
+    class ResourcePool;
 }
 
 //
@@ -39,8 +42,22 @@ namespace System
             return m_resourceManager;
         }
 
+        // Gets the filename the resource was loaded from.
+        // Empty for resources not loaded by a resource manager.
+        const std::string& GetFilename() const
+        {
+            return m_filename;
+        }
+
     private:
         // Resource manager that owns this resource.
         ResourceManager* m_resourceManager;
+
+        // Filename the resource was loaded from.
+        std::string m_filename;
+
+        // Allow resource pools to set filenames.
+        template<typename Type>
+        friend class ResourcePool;
     };
 }
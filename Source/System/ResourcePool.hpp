@@ -112,6 +112,8 @@ namespace System
         if(!resource->Load(filename))
             return m_default;
 
+        resource->m_filename = filename;
+
         // Add resource to the list.
         auto result = m_resources.emplace(filename, std::move(resource));
 
@@ -2,6 +2,7 @@
 #include "Window.hpp"
 #include "Context.hpp"
 #include "Config.hpp"
+#include "Graphics/StateCache.hpp"
 using namespace System;
 
 namespace
@@ -354,6 +355,9 @@ bool Window::Initialize(Context& context)
 
     Log() << "Created OpenGL " << glMajor << "." << glMinor << " context.";
 
+    // Forget states cached for a previous context.
+    Graphics::StateCache::Reset();
+
     // Set context instance.
     context.window = this;
 
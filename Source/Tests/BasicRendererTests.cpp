@@ -0,0 +1,80 @@
+#include "Precompiled.hpp"
+#include "Test.hpp"
+#include "Context.hpp"
+
+#include "Graphics/Texture.hpp"
+
+namespace
+{
+    // Number of drawn sprites.
+    const int SpriteCount = 10000;
+
+    // Creates sprites that share a single texture.
+    void CreateSprites(const Graphics::Texture* texture,
+        Graphics::BasicRenderer::SpriteInfoList& spriteInfo,
+        Graphics::BasicRenderer::SpriteDataList& spriteData)
+    {
+        Graphics::BasicRenderer::Sprite sprite;
+        sprite.info.texture = texture;
+
+        for(int i = 0; i < SpriteCount; ++i)
+        {
+            sprite.data.position = glm::vec3(i % 100, i / 100, 0.0f);
+
+            spriteInfo.push_back(sprite.info);
+            spriteData.push_back(sprite.data);
+        }
+    }
+}
+
+TEST(BasicRendererSharedTextureBatch)
+{
+    Context context;
+
+    Test::RecordingRenderer recording;
+    CHECK(recording.Initialize(context));
+
+    // Draw sprites with identical state.
+    Graphics::Texture texture;
+
+    Graphics::BasicRenderer::SpriteInfoList spriteInfo;
+    Graphics::BasicRenderer::SpriteDataList spriteData;
+    CreateSprites(&texture, spriteInfo, spriteData);
+
+    recording.renderer.DrawSprites(spriteInfo, spriteData, glm::mat4(1.0f));
+
+    // All sprites are drawn in a single batch.
+    CHECK(recording.backend->GetCounters().drawCalls == 1);
+    CHECK(recording.backend->GetCounters().spritesDrawn == SpriteCount);
+
+    CHECK(recording.renderer.GetStatistics().drawCalls == 1);
+    CHECK(recording.renderer.GetStatistics().largestBatch == SpriteCount);
+}
+
+TEST(BasicRendererBatchSizeLimit)
+{
+    Context context;
+
+    Test::RecordingRenderer recording;
+    CHECK(recording.Initialize(context));
+
+    recording.backend->SetBatchSizeLimit(128);
+
+    // Draw sprites with identical state.
+    Graphics::Texture texture;
+
+    Graphics::BasicRenderer::SpriteInfoList spriteInfo;
+    Graphics::BasicRenderer::SpriteDataList spriteData;
+    CreateSprites(&texture, spriteInfo, spriteData);
+
+    recording.renderer.DrawSprites(spriteInfo, spriteData, glm::mat4(1.0f));
+
+    // Sprites are split into batches of the backend limit.
+    const int batchCount = (SpriteCount + 127) / 128;
+
+    CHECK(recording.backend->GetCounters().drawCalls == batchCount);
+    CHECK(recording.backend->GetCounters().spritesDrawn == SpriteCount);
+
+    CHECK(recording.renderer.GetStatistics().drawCalls == batchCount);
+    CHECK(recording.renderer.GetStatistics().largestBatch == 128);
+}
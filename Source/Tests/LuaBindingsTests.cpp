@@ -0,0 +1,71 @@
+#include "Precompiled.hpp"
+#include "Test.hpp"
+#include "Context.hpp"
+
+#include "Lua/State.hpp"
+#include "Lua/Bindings/Math.hpp"
+#include "Lua/Bindings/Game.hpp"
+#include "Game/EntitySystem.hpp"
+#include "Game/ComponentSystem.hpp"
+#include "Game/Components/Transform.hpp"
+#include "Game/Components/Render.hpp"
+
+TEST(LuaComponentView)
+{
+    Context context;
+
+    Game::EntitySystem entitySystem;
+    CHECK(entitySystem.Initialize(context));
+
+    Game::ComponentSystem componentSystem;
+    CHECK(componentSystem.Initialize(context));
+
+    // Give every entity a transform and every other entity a render component.
+    std::vector<Game::EntityHandle> entities;
+    entitySystem.CreateEntities(10, entities);
+
+    for(std::size_t i = 0; i < entities.size(); ++i)
+    {
+        auto transform = componentSystem.Create<Game::Components::Transform>(entities[i]);
+        transform->SetPosition(glm::vec2((float)i, 1.0f));
+
+        if(i % 2 == 0)
+        {
+            componentSystem.Create<Game::Components::Render>(entities[i]);
+        }
+    }
+
+    // Register the bindings used by the script.
+    Lua::State state;
+    CHECK(state.Initialize());
+
+    Lua::Bindings::Vec2::Register(state, context);
+    Lua::Bindings::EntityHandle::Register(state, context);
+    Lua::Bindings::TransformComponent::Register(state, context);
+    Lua::Bindings::RenderComponent::Register(state, context);
+    Lua::Bindings::ComponentSystem::Register(state, context);
+
+    // Copy positions of entities with both components into render offsets.
+    CHECK(state.Parse(
+        "ViewCount = 0\n"
+        "for entity, transform, render in ComponentSystem:View(\"Transform\", \"Render\") do\n"
+        "    render:SetOffset(transform:GetPosition())\n"
+        "    ViewCount = ViewCount + 1\n"
+        "end\n"
+    ));
+
+    lua_getglobal(state, "ViewCount");
+    CHECK(lua_tointeger(state, -1) == 5);
+    lua_pop(state, 1);
+
+    for(std::size_t i = 0; i < entities.size(); ++i)
+    {
+        auto render = componentSystem.Lookup<Game::Components::Render>(entities[i]);
+        CHECK((render != nullptr) == (i % 2 == 0));
+
+        if(render != nullptr)
+        {
+            CHECK(render->GetOffset() == glm::vec2((float)i, 1.0f));
+        }
+    }
+}
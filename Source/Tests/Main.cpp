@@ -0,0 +1,72 @@
+#include "Precompiled.hpp"
+#include "Test.hpp"
+
+//
+// Tests
+//
+//  Runs all registered tests and returns the number of failed ones.
+//
+
+namespace
+{
+    // Registered test structure.
+    struct TestInfo
+    {
+        const char* name;
+        Test::Function function;
+    };
+
+    // Gets the list of registered tests.
+    std::vector<TestInfo>& GetTests()
+    {
+        static std::vector<TestInfo> tests;
+        return tests;
+    }
+
+    // Number of failed checks of the current test.
+    int failureCount = 0;
+}
+
+Test::Registration::Registration(const char* name, Function function)
+{
+    TestInfo info;
+    info.name = name;
+    info.function = function;
+
+    GetTests().push_back(info);
+}
+
+void Test::Fail(const char* expression, const char* file, int line)
+{
+    std::cout << "    Check failed: " << expression << " (" << file << ":" << line << ")" << std::endl;
+
+    failureCount += 1;
+}
+
+int main()
+{
+    Debug::Initialize();
+    Build::Initialize();
+    Logger::Initialize();
+
+    // Run all tests.
+    int failedTests = 0;
+
+    for(const TestInfo& test : GetTests())
+    {
+        failureCount = 0;
+
+        test.function();
+
+        if(failureCount != 0)
+        {
+            failedTests += 1;
+        }
+
+        std::cout << (failureCount == 0 ? "[PASS] " : "[FAIL] ") << test.name << std::endl;
+    }
+
+    std::cout << GetTests().size() - failedTests << " of " << GetTests().size() << " tests passed." << std::endl;
+
+    return failedTests;
+}
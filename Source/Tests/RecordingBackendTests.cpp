@@ -0,0 +1,83 @@
+#include "Precompiled.hpp"
+#include "Test.hpp"
+#include "Context.hpp"
+
+#include "Graphics/RenderQueue.hpp"
+#include "Graphics/Texture.hpp"
+
+TEST(RecordingBackendClearCommands)
+{
+    Context context;
+
+    Test::RecordingRenderer recording;
+    CHECK(recording.Initialize(context));
+
+    // Record a frame buffer clear.
+    recording.renderer.SetViewport(0, 0, 640, 480);
+    recording.renderer.SetClearColor(glm::vec4(1.0f, 0.5f, 0.25f, 1.0f));
+    recording.renderer.SetClearDepth(0.75f);
+    recording.renderer.SetClearStencil(3);
+    recording.renderer.Clear();
+
+    typedef Graphics::RecordingBackend::CommandTypes CommandTypes;
+    const auto& commands = recording.backend->GetCommands();
+
+    CHECK(commands.size() == 5);
+    CHECK(commands[0].type == CommandTypes::SetViewport);
+    CHECK(commands[0].viewport == glm::ivec4(0, 0, 640, 480));
+    CHECK(commands[1].type == CommandTypes::SetClearColor);
+    CHECK(commands[1].color == glm::vec4(1.0f, 0.5f, 0.25f, 1.0f));
+    CHECK(commands[2].type == CommandTypes::SetClearDepth);
+    CHECK(commands[2].depth == 0.75f);
+    CHECK(commands[3].type == CommandTypes::SetClearStencil);
+    CHECK(commands[3].stencil == 3);
+    CHECK(commands[4].type == CommandTypes::Clear);
+    CHECK(commands[4].flags == (uint32_t)Graphics::ClearFlags::All);
+
+    CHECK(recording.backend->GetCounters().clears == 1);
+}
+
+TEST(RecordingBackendQueuedBatches)
+{
+    Context context;
+
+    Test::RecordingRenderer recording;
+    CHECK(recording.Initialize(context));
+
+    Graphics::RenderQueue renderQueue;
+    CHECK(renderQueue.Initialize(context));
+
+    // Push opaque sprites of two interleaved textures and transparent ones.
+    Graphics::Texture textures[2];
+
+    for(int i = 0; i < 1000; ++i)
+    {
+        Graphics::BasicRenderer::Sprite sprite;
+        sprite.info.texture = &textures[i % 2];
+        sprite.info.transparent = i >= 900;
+        sprite.data.position = glm::vec3(i % 10, i / 10, 0.0f);
+
+        renderQueue.Push(renderQueue.CalculateKey(Graphics::RenderQueue::Layers::World, sprite.info, sprite.data), sprite.info, sprite.data);
+    }
+
+    glm::mat4 transform = glm::translate(glm::mat4(1.0f), glm::vec3(1.0f, 2.0f, 0.0f));
+    renderQueue.SetTransform(Graphics::RenderQueue::Layers::World, transform);
+    renderQueue.Submit();
+
+    // Opaque sprites are drawn in one batch per texture.
+    // Transparent sprites are sorted by rows first and by textures in each row.
+    const auto& counters = recording.backend->GetCounters();
+
+    CHECK(counters.spritesDrawn == 1000);
+    CHECK(counters.drawCalls == 2 + 10 * 2);
+    CHECK(counters.stateChanges == counters.drawCalls);
+
+    // Sprites are drawn with the transform of their layer.
+    typedef Graphics::RecordingBackend::CommandTypes CommandTypes;
+    const auto& commands = recording.backend->GetCommands();
+
+    CHECK(!commands.empty());
+    CHECK(commands.front().type == CommandTypes::BeginSprites);
+    CHECK(commands.front().transform == transform);
+    CHECK(commands.back().type == CommandTypes::EndSprites);
+}
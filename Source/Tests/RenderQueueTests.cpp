@@ -0,0 +1,232 @@
+#include "Precompiled.hpp"
+#include "Test.hpp"
+#include "Context.hpp"
+
+#include "System/JobSystem.hpp"
+#include "Graphics/RenderQueue.hpp"
+
+namespace
+{
+    // Number of queued commands.
+    // Enough to be sorted in parts on workers.
+    const int CommandCount = 200000;
+
+    // Pushes commands with many equal keys and returns their expected order.
+    std::vector<int> PushCommands(Graphics::RenderQueue& renderQueue)
+    {
+        std::minstd_rand random(7);
+        std::vector<std::pair<uint64_t, int>> commands;
+
+        for(int i = 0; i < CommandCount; ++i)
+        {
+            uint64_t key = (uint64_t)(random() % 1000) << 15;
+
+            Graphics::BasicRenderer::Sprite sprite;
+            sprite.data.position.x = (float)i;
+
+            renderQueue.Push(key, sprite.info, sprite.data);
+            commands.emplace_back(key, i);
+        }
+
+        // Commands with equal keys keep the order they were pushed in.
+        std::stable_sort(commands.begin(), commands.end(), [](const std::pair<uint64_t, int>& a, const std::pair<uint64_t, int>& b)
+        {
+            return a.first < b.first;
+        });
+
+        std::vector<int> order;
+
+        for(const auto& command : commands)
+        {
+            order.push_back(command.second);
+        }
+
+        return order;
+    }
+
+    // Checks if recorded sprites are in the expected order.
+    bool IsRecordedInOrder(const Graphics::RecordingBackend& recording, const std::vector<int>& order)
+    {
+        const auto& instances = recording.GetInstances();
+
+        if(instances.size() != order.size())
+            return false;
+
+        for(std::size_t i = 0; i < order.size(); ++i)
+        {
+            if((int)instances[i].position.x != order[i])
+                return false;
+        }
+
+        return true;
+    }
+}
+
+TEST(RenderQueueSort)
+{
+    Context context;
+
+    Test::RecordingRenderer recording;
+    CHECK(recording.Initialize(context));
+
+    Graphics::RenderQueue renderQueue;
+    CHECK(renderQueue.Initialize(context));
+
+    std::vector<int> order = PushCommands(renderQueue);
+    renderQueue.Submit();
+
+    CHECK(IsRecordedInOrder(*recording.backend, order));
+}
+
+TEST(RenderQueueParallelSort)
+{
+    Context context;
+
+    System::JobSystem jobSystem;
+    CHECK(jobSystem.Initialize(context));
+
+    Test::RecordingRenderer recording;
+    CHECK(recording.Initialize(context));
+
+    Graphics::RenderQueue renderQueue;
+    CHECK(renderQueue.Initialize(context));
+
+    // Commands sorted in parts are drawn in the same order as sorted at once.
+    std::vector<int> order = PushCommands(renderQueue);
+    renderQueue.Submit();
+
+    CHECK(IsRecordedInOrder(*recording.backend, order));
+}
+
+TEST(RenderQueueTextureIds)
+{
+    Context context;
+
+    Test::RecordingRenderer recording;
+    CHECK(recording.Initialize(context));
+
+    Graphics::RenderQueue renderQueue;
+    CHECK(renderQueue.Initialize(context));
+
+    recording.backend->SetInstanceRecording(false);
+
+    // Draw more textures over all frames than fit in sort keys.
+    std::vector<Graphics::Texture> textures(40000);
+
+    for(std::size_t frame = 1; frame < textures.size(); ++frame)
+    {
+        // Interleaved sprites of the first and a new texture.
+        for(int i = 0; i < 8; ++i)
+        {
+            Graphics::BasicRenderer::Sprite sprite;
+            sprite.info.texture = &textures[i % 2 ? frame : 0];
+
+            renderQueue.Push(renderQueue.CalculateKey(Graphics::RenderQueue::Layers::World, sprite.info, sprite.data), sprite.info, sprite.data);
+        }
+
+        renderQueue.Submit();
+
+        // Identifiers of textures in a frame do not collide.
+        CHECK(recording.backend->GetCounters().drawCalls == 2);
+        recording.backend->Reset();
+    }
+}
+
+TEST(RenderQueueStaticBatches)
+{
+    Context context;
+
+    Test::RecordingRenderer recording;
+    CHECK(recording.Initialize(context));
+
+    Graphics::RenderQueue renderQueue;
+    CHECK(renderQueue.Initialize(context));
+
+    // Create static batches of different sizes.
+    Graphics::Texture textures[2];
+
+    Graphics::BasicRenderer::StaticBatchPtr batches[2] =
+    {
+        recording.renderer.CreateStaticBatch(),
+        recording.renderer.CreateStaticBatch(),
+    };
+
+    CHECK(recording.renderer.UpdateStaticBatch(*batches[0], Graphics::BasicRenderer::SpriteDataList(10)));
+    CHECK(recording.renderer.UpdateStaticBatch(*batches[1], Graphics::BasicRenderer::SpriteDataList(20)));
+
+    recording.backend->Reset();
+
+    // Push a world sprite before background batches in reversed order.
+    Graphics::BasicRenderer::Sprite sprite;
+    sprite.info.texture = &textures[0];
+    renderQueue.Push(renderQueue.CalculateKey(Graphics::RenderQueue::Layers::World, sprite.info, sprite.data), sprite.info, sprite.data);
+
+    for(int order = 1; order >= 0; --order)
+    {
+        Graphics::BasicRenderer::Sprite::Info info;
+        info.texture = &textures[1 - order];
+
+        uint64_t key = renderQueue.CalculateOrderKey(Graphics::RenderQueue::Layers::Background, order, info);
+        renderQueue.PushStaticBatch(key, info, *batches[order]);
+    }
+
+    renderQueue.Submit();
+
+    // Batches are drawn in their order behind the sprite.
+    typedef Graphics::RecordingBackend::CommandTypes CommandTypes;
+    std::vector<int> draws;
+
+    for(const auto& command : recording.backend->GetCommands())
+    {
+        if(command.type == CommandTypes::DrawStaticBatch || command.type == CommandTypes::DrawSpriteInstances)
+        {
+            draws.push_back(command.type == CommandTypes::DrawStaticBatch ? command.count : -command.count);
+        }
+    }
+
+    CHECK(draws == std::vector<int>({ 10, 20, -1 }));
+}
+
+TEST(RenderQueueInstanceRuns)
+{
+    Context context;
+
+    Test::RecordingRenderer recording;
+    CHECK(recording.Initialize(context));
+
+    Graphics::RenderQueue renderQueue;
+    CHECK(renderQueue.Initialize(context));
+
+    // Push an instance run between two sprites of the same texture.
+    Graphics::Texture texture;
+
+    Graphics::BasicRenderer::Sprite sprite;
+    sprite.info.texture = &texture;
+
+    Graphics::BasicRenderer::SpriteDataList instances(5);
+
+    uint64_t runKey = renderQueue.CalculateOrderKey(Graphics::RenderQueue::Layers::World, 1, sprite.info);
+    renderQueue.PushInstances(runKey, sprite.info, instances.data(), (int)instances.size());
+
+    for(uint32_t order = 0; order <= 2; order += 2)
+    {
+        uint64_t key = renderQueue.CalculateOrderKey(Graphics::RenderQueue::Layers::World, order, sprite.info);
+        renderQueue.Push(key, sprite.info, sprite.data);
+    }
+
+    renderQueue.Submit();
+
+    // Instance run is drawn in its place among sorted sprites.
+    typedef Graphics::RecordingBackend::CommandTypes CommandTypes;
+    std::vector<int> draws;
+
+    for(const auto& command : recording.backend->GetCommands())
+    {
+        if(command.type == CommandTypes::DrawSpriteInstances)
+        {
+            draws.push_back(command.count);
+        }
+    }
+
+    CHECK(draws == std::vector<int>({ 1, 5, 1 }));
+}
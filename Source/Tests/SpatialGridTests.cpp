@@ -0,0 +1,106 @@
+#include "Precompiled.hpp"
+#include "Test.hpp"
+
+#include "Game/SpatialGrid.hpp"
+
+namespace
+{
+    // Checks if a query result contains an item.
+    bool HasItem(const Game::SpatialGrid::ItemList& items, uint32_t item)
+    {
+        return std::find(items.begin(), items.end(), item) != items.end();
+    }
+}
+
+TEST(SpatialGridQuery)
+{
+    Game::SpatialGrid grid;
+    CHECK(grid.Initialize(8.0f));
+
+    grid.Update(0, glm::vec4(0.0f, 0.0f, 4.0f, 4.0f));
+    grid.Update(1, glm::vec4(100.0f, 100.0f, 104.0f, 104.0f));
+
+    // Only items in overlapping cells are returned.
+    Game::SpatialGrid::ItemList items;
+    grid.Query(glm::vec4(-1.0f, -1.0f, 1.0f, 1.0f), items);
+
+    CHECK(items.size() == 1);
+    CHECK(HasItem(items, 0));
+
+    // Moved items are found at their new bounds.
+    grid.Update(1, glm::vec4(2.0f, 2.0f, 3.0f, 3.0f));
+
+    items.clear();
+    grid.Query(glm::vec4(-1.0f, -1.0f, 1.0f, 1.0f), items);
+
+    CHECK(items.size() == 2);
+    CHECK(HasItem(items, 1));
+}
+
+TEST(SpatialGridOversizedItems)
+{
+    Game::SpatialGrid grid;
+    CHECK(grid.Initialize(8.0f));
+
+    const float infinity = std::numeric_limits<float>::infinity();
+    const float maximum = std::numeric_limits<float>::max();
+
+    grid.Update(0, glm::vec4(-infinity, -infinity, infinity, infinity));
+    grid.Update(1, glm::vec4(-maximum, 0.0f, maximum, 1.0f));
+    grid.Update(2, glm::vec4(0.0f, 0.0f, 1000.0f, 1000.0f));
+    grid.Update(3, glm::vec4(1000.0f, 1000.0f, 1001.0f, 1001.0f));
+
+    CHECK(grid.Contains(0));
+    CHECK(grid.Contains(1));
+    CHECK(grid.Contains(2));
+
+    // Oversized items are returned by every query.
+    Game::SpatialGrid::ItemList items;
+    grid.Query(glm::vec4(-5000.0f, -5000.0f, -4999.0f, -4999.0f), items);
+
+    CHECK(items.size() == 3);
+    CHECK(!HasItem(items, 3));
+
+    // Queries with infinite bounds return all items.
+    items.clear();
+    grid.Query(glm::vec4(-infinity, -infinity, infinity, infinity), items);
+
+    CHECK(items.size() == 4);
+
+    // Oversized items can be moved into cells and removed.
+    grid.Update(0, glm::vec4(0.0f, 0.0f, 1.0f, 1.0f));
+    grid.Remove(1);
+    grid.Remove(2);
+
+    items.clear();
+    grid.Query(glm::vec4(-5000.0f, -5000.0f, -4999.0f, -4999.0f), items);
+
+    CHECK(items.empty());
+}
+
+TEST(SpatialGridInvalidBounds)
+{
+    Game::SpatialGrid grid;
+    CHECK(grid.Initialize(8.0f));
+
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+
+    // Items with bounds that are not a number are not inserted.
+    grid.Update(0, glm::vec4(nan, 0.0f, 1.0f, 1.0f));
+    CHECK(!grid.Contains(0));
+
+    // Valid items are removed when their bounds become invalid.
+    grid.Update(1, glm::vec4(0.0f, 0.0f, 1.0f, 1.0f));
+    CHECK(grid.Contains(1));
+
+    grid.Update(1, glm::vec4(0.0f, 0.0f, 1.0f, nan));
+    CHECK(!grid.Contains(1));
+
+    // Queries with bounds that are not a number return nothing.
+    grid.Update(2, glm::vec4(0.0f, 0.0f, 1.0f, 1.0f));
+
+    Game::SpatialGrid::ItemList items;
+    grid.Query(glm::vec4(nan), items);
+
+    CHECK(items.empty());
+}
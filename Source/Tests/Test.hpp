@@ -0,0 +1,107 @@
+#pragma once
+
+#include "Precompiled.hpp"
+#include "Context.hpp"
+#include "Game/EntitySystem.hpp"
+#include "Game/ComponentSystem.hpp"
+#include "Game/IdentitySystem.hpp"
+#include "Graphics/BasicRenderer.hpp"
+#include "Graphics/RecordingBackend.hpp"
+
+//
+// Test
+//
+//  Minimal framework of the test target. Tests are functions registered
+//  by static instances, which are all run by the test target. A test stops
+//  at its first failed check, which is printed along with its location.
+//
+//  Example usage:
+//      TEST(EntityCreation)
+//      {
+//          Game::EntitySystem entitySystem;
+//          CHECK(entitySystem.Initialize(context));
+//      }
+//
+//  Tests and benchmarks of game systems share a world structure:
+//      Test::World world;
+//      world.entitySystem.CreateEntities(100, entities);
+//
+//  Renderer tests draw with the recording backend of a test renderer:
+//      Test::RecordingRenderer recording;
+//      CHECK(recording.Initialize(context));
+//
+//      recording.renderer.DrawSprites(spriteInfo, spriteData, transform);
+//      CHECK(recording.backend->GetCounters().drawCalls == 1);
+//
+
+namespace Test
+{
+    // Type declarations.
+    typedef void (*Function)();
+
+    // Registration structure.
+    struct Registration
+    {
+        Registration(const char* name, Function function);
+    };
+
+    // Reports a failed check of the current test.
+    void Fail(const char* expression, const char* file, int line);
+
+    // World structure with initialized game systems.
+    struct World
+    {
+        World(Game::ComponentSystem::ComponentStorage::Type storage = Game::ComponentSystem::ComponentStorage::Pools)
+        {
+            entitySystem.Initialize(context);
+            componentSystem.Initialize(context, storage);
+            identitySystem.Initialize(context);
+        }
+
+        Context context;
+        Game::EntitySystem entitySystem;
+        Game::ComponentSystem componentSystem;
+        Game::IdentitySystem identitySystem;
+    };
+
+    // Renderer that records commands instead of drawing them.
+    struct RecordingRenderer
+    {
+        RecordingRenderer() :
+            backend(nullptr)
+        {
+        }
+
+        // Initializes the renderer with the recording backend.
+        bool Initialize(Context& context)
+        {
+            if(!renderer.Initialize(context, Graphics::BasicRenderer::Backend::Recording))
+                return false;
+
+            backend = static_cast<Graphics::RecordingBackend*>(renderer.GetBackend());
+
+            return true;
+        }
+
+        Graphics::BasicRenderer renderer;
+        Graphics::RecordingBackend* backend;
+    };
+}
+
+// Defines and registers a test function.
+#define TEST(name) \
+    static void Test##name(); \
+    static Test::Registration TestRegistration##name(#name, &Test##name); \
+    static void Test##name()
+
+// Stops the current test if an expression is false.
+#define CHECK(expression) \
+    do \
+    { \
+        if(!(expression)) \
+        { \
+            Test::Fail(#expression, __FILE__, __LINE__); \
+            return; \
+        } \
+    } \
+    while(false)
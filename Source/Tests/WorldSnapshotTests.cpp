@@ -0,0 +1,208 @@
+#include "Precompiled.hpp"
+#include "Test.hpp"
+#include "Context.hpp"
+
+#include "Game/WorldSnapshot.hpp"
+#include "Game/Components/Transform.hpp"
+#include "Game/Components/Render.hpp"
+
+namespace
+{
+    // Snapshot file written by tests.
+    const char* SnapshotFilename = "Tests.snapshot";
+
+    // Component that references another entity.
+    class Follower : public Game::Component
+    {
+    public:
+        Follower()
+        {
+        }
+
+        Follower(Follower&&) = default;
+        Follower& operator=(Follower&&) = default;
+
+        Game::EntityHandle target;
+        float distance;
+    };
+
+    // Tested world structure.
+    struct World : public Test::World
+    {
+        World()
+        {
+            snapshot.Initialize(context);
+
+            // Register the test component type.
+            snapshot.RegisterComponent<Follower>("Follower",
+                [](const Follower& follower, Game::WorldSnapshot::Writer& writer)
+                {
+                    writer.WriteEntity(follower.target);
+                    writer.Write(follower.distance);
+                },
+                [](Follower& follower, Game::WorldSnapshot::Reader& reader)
+                {
+                    // Negative distances are rejected.
+                    return reader.ReadEntity(follower.target) && reader.Read(follower.distance) && follower.distance >= 0.0f;
+                }
+            );
+        }
+
+        Game::WorldSnapshot snapshot;
+    };
+
+    // Creates entities with components of all saved types.
+    void CreateWorld(World& world, std::vector<Game::EntityHandle>& entities)
+    {
+        world.entitySystem.CreateEntities(100, entities);
+
+        for(std::size_t i = 0; i < entities.size(); ++i)
+        {
+            const Game::EntityHandle& entity = entities[i];
+
+            auto transform = world.componentSystem.Create<Game::Components::Transform>(entity);
+            transform->SetPosition(glm::vec2(i * 0.5f, i * -0.25f));
+            transform->SetScale(glm::vec2(1.0f + i, 2.0f));
+            transform->SetRotation(i * 0.1f);
+
+            if(i % 2 == 0)
+            {
+                auto render = world.componentSystem.Create<Game::Components::Render>(entity);
+                render->SetTexture(nullptr, glm::vec4(i, 0.0f, 16.0f, 16.0f));
+                render->SetOffset(glm::vec2(-8.0f, 0.0f));
+                render->SetDiffuseColor(glm::vec4(1.0f, 0.5f, 0.25f, 1.0f));
+                render->SetTransparent(i % 4 == 0);
+            }
+
+            if(i % 3 == 0)
+            {
+                auto follower = world.componentSystem.Create<Follower>(entity);
+                follower->target = entities[(i + 1) % entities.size()];
+                follower->distance = i * 2.0f;
+            }
+
+            if(i % 10 == 0)
+            {
+                world.identitySystem.SetEntityName(entity, "Entity " + std::to_string(i));
+            }
+        }
+
+        world.entitySystem.ProcessCommands();
+    }
+}
+
+TEST(WorldSnapshotSaveLoad)
+{
+    World world;
+
+    // Save a world.
+    std::vector<Game::EntityHandle> saved;
+    CreateWorld(world, saved);
+
+    CHECK(world.snapshot.Save(SnapshotFilename));
+
+    // Load it next to the saved one.
+    std::vector<Game::EntityHandle> loaded;
+    CHECK(world.snapshot.Load(SnapshotFilename, &loaded));
+    world.entitySystem.ProcessCommands();
+
+    std::remove((Build::GetWorkingDir() + SnapshotFilename).c_str());
+
+    // Compare loaded entities with saved ones.
+    CHECK(loaded.size() == saved.size());
+    CHECK(world.entitySystem.GetEntityCount() == saved.size() * 2);
+
+    std::unordered_map<Game::EntityHandle, Game::EntityHandle> loadedBySaved;
+
+    for(std::size_t i = 0; i < saved.size(); ++i)
+    {
+        loadedBySaved[saved[i]] = loaded[i];
+    }
+
+    for(std::size_t i = 0; i < saved.size(); ++i)
+    {
+        const Game::EntityHandle& a = saved[i];
+        const Game::EntityHandle& b = loaded[i];
+
+        CHECK(a != b);
+        CHECK(world.entitySystem.IsHandleValid(b));
+        CHECK(world.componentSystem.GetComponentMask(a) == world.componentSystem.GetComponentMask(b));
+        CHECK(world.identitySystem.GetEntityName(a) == world.identitySystem.GetEntityName(b));
+
+        auto transformA = world.componentSystem.Lookup<Game::Components::Transform>(a);
+        auto transformB = world.componentSystem.Lookup<Game::Components::Transform>(b);
+
+        CHECK(transformA != nullptr && transformB != nullptr);
+        CHECK(transformA->GetPosition() == transformB->GetPosition());
+        CHECK(transformA->GetScale() == transformB->GetScale());
+        CHECK(transformA->GetRotation() == transformB->GetRotation());
+
+        auto renderA = world.componentSystem.Lookup<Game::Components::Render>(a);
+        auto renderB = world.componentSystem.Lookup<Game::Components::Render>(b);
+
+        if(renderA != nullptr)
+        {
+            CHECK(renderB != nullptr);
+            CHECK(renderA->GetRectangle() == renderB->GetRectangle());
+            CHECK(renderA->IsWholeTexture() == renderB->IsWholeTexture());
+            CHECK(renderA->GetOffset() == renderB->GetOffset());
+            CHECK(renderA->GetDiffuseColor() == renderB->GetDiffuseColor());
+            CHECK(renderA->GetEmissiveColor() == renderB->GetEmissiveColor());
+            CHECK(renderA->GetEmissivePower() == renderB->GetEmissivePower());
+            CHECK(renderA->IsTransparent() == renderB->IsTransparent());
+        }
+
+        auto followerA = world.componentSystem.Lookup<Follower>(a);
+        auto followerB = world.componentSystem.Lookup<Follower>(b);
+
+        if(followerA != nullptr)
+        {
+            // References are mapped to loaded entities.
+            CHECK(followerB != nullptr);
+            CHECK(followerB->target == loadedBySaved[followerA->target]);
+            CHECK(followerA->distance == followerB->distance);
+        }
+    }
+}
+
+TEST(WorldSnapshotInvalidFile)
+{
+    World world;
+
+    std::vector<Game::EntityHandle> saved;
+    CreateWorld(world, saved);
+
+    std::string path = Build::GetWorkingDir() + SnapshotFilename;
+
+    // Save a component record that fails to load.
+    world.componentSystem.Lookup<Follower>(saved[99])->distance = -1.0f;
+    CHECK(world.snapshot.Save(SnapshotFilename));
+
+    // Entities of a failed load are destroyed.
+    std::vector<Game::EntityHandle> loaded;
+    CHECK(!world.snapshot.Load(SnapshotFilename, &loaded));
+    world.entitySystem.ProcessCommands();
+
+    CHECK(loaded.empty());
+    CHECK(world.entitySystem.GetEntityCount() == saved.size());
+
+    // Cut the file in the middle of the last section.
+    world.componentSystem.Lookup<Follower>(saved[99])->distance = 1.0f;
+    CHECK(world.snapshot.Save(SnapshotFilename));
+
+    std::vector<char> content = Utility::GetBinaryFileContent(path);
+    CHECK(content.size() > 8);
+
+    {
+        std::ofstream file(path, std::ios::binary);
+        file.write(content.data(), content.size() - 8);
+    }
+
+    CHECK(!world.snapshot.Load(SnapshotFilename, &loaded));
+    world.entitySystem.ProcessCommands();
+
+    std::remove(path.c_str());
+
+    CHECK(loaded.empty());
+    CHECK(world.entitySystem.GetEntityCount() == saved.size());
+}
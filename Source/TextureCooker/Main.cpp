@@ -0,0 +1,58 @@
+#include "Precompiled.hpp"
+
+#include "Graphics/Image.hpp"
+#include "Graphics/TextureContainer.hpp"
+
+//
+// Texture Cooker
+//
+//  Cooks PNG files into texture containers next to them, which textures
+//  then load instead of decoding PNG files at run time.
+//
+//  Example usage:
+//      TextureCooker Data/Textures/Character.png Data/Textures/Check.png
+//
+//  Paths are relative to the working directory, the same as in the game.
+//  Cooked files are ignored after their PNG files change, until they
+//  are cooked again.
+//
+
+int main(int argc, char* argv[])
+{
+    Debug::Initialize();
+    Build::Initialize();
+    Logger::Initialize();
+
+    // Check arguments.
+    if(argc < 2)
+    {
+        std::cout << "Usage: TextureCooker <file.png> [file.png ...]" << std::endl;
+        return -1;
+    }
+
+    // Cook each file.
+    int failedCount = 0;
+
+    for(int i = 1; i < argc; ++i)
+    {
+        std::string filename = argv[i];
+
+        // Decode the image.
+        Graphics::Image image;
+
+        if(!image.Load(filename))
+        {
+            failedCount += 1;
+            continue;
+        }
+
+        // Write the texture container.
+        if(!Graphics::TextureContainer::Cook(image, Graphics::TextureContainer::GetCookedFilename(filename), filename))
+        {
+            failedCount += 1;
+            continue;
+        }
+    }
+
+    return failedCount == 0 ? 0 : -1;
+}